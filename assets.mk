@@ -0,0 +1,41 @@
+#---------------------------------------------------------------------------------
+# Generated assets, shared by the GBA build (Makefile) and the host build
+# (host/Makefile). Paths are relative to the project directory.
+#---------------------------------------------------------------------------------
+MUSIC		:= AAS_Data
+# what the sound effects are stored at and mixed at, see source/audio.c
+AUDIO_RATE	:= 32000
+FONT		:= font/VCR_OSD_MONO.ttf
+
+#---------------------------------------------------------------------------------
+# DISPLAY=tiled builds the mode 0 display with a tile layer per kind of content
+# instead of the mode 3 bitmap, DISPLAY=paletted the mode 4 framebuffer with
+# palette inks per player, see source/display.h. Only one of the display_*.c
+# files is built.
+#---------------------------------------------------------------------------------
+DISPLAY		?= bitmap
+DISPLAY_EXCLUDED	:= $(filter-out display_$(DISPLAY).c,display_bitmap.c display_tiled.c display_paletted.c)
+
+#---------------------------------------------------------------------------------
+# digit atlases generated from FONT by tools/atlasc, see font/README. The tiled
+# display takes them as deduplicated 4bpp tiles, it flips them for upside down.
+# The paletted display draws the same 1bpp masks as the bitmap one.
+#---------------------------------------------------------------------------------
+ifeq ($(DISPLAY),tiled)
+ATLAS_FORMAT	:= -f 4bpp -d
+ATLAS_UD	:=
+else
+ATLAS_FORMAT	:= -f 1bpp
+ATLAS_UD	:= -r
+endif
+
+ATLASES		:= VCR_OSD_MONO_NUMBERS_HUGE VCR_OSD_MONO_NUMBERS_LARGE VCR_OSD_MONO_NUMBERS_MEDIUM \
+		   VCR_OSD_MONO_NUMBERS_SMALL
+ATLAS_VCR_OSD_MONO_NUMBERS_HUGE		:= -s 120 -t 16 -l 3 $(ATLAS_FORMAT)
+ATLAS_VCR_OSD_MONO_NUMBERS_LARGE	:= -s 60 -t 8 -l 3 $(ATLAS_UD) $(ATLAS_FORMAT)
+# 16x24, whole tiles, for the games with 3 rows of text under every number
+# and for large numbers with more digits than slots
+ATLAS_VCR_OSD_MONO_NUMBERS_MEDIUM	:= -s 32 -t 5 -b 3 -l 1 $(ATLAS_UD) $(ATLAS_FORMAT)
+# 8x12, only for medium numbers with more digits than slots
+ATLAS_VCR_OSD_MONO_NUMBERS_SMALL	:= -s 16 -t 2 -b 2 $(ATLAS_FORMAT)
+ATLAS_ROM_BUDGET	:= 16384
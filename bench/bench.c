@@ -0,0 +1,475 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Microbenchmarks for the drawing and formatting the game does every frame
+ * and for the autosave. Built instead of main.c, as a ROM (make bench) that
+ * counts cycles with the profile timers, or for the host (make -C host bench)
+ * where it measures wall clock time and, if perf allows it, instructions.
+ *
+ * Every case is run a number of times after one untimed run that sets up
+ * whatever is set up lazily, the results are one line per case:
+ *   <name> <iterations> <average> <minimum> [<instructions>]
+ * The ROM writes them to the debug log with a "bench: " prefix and shows them
+ * on screen, the host writes them to a file or stdout and can compare them
+ * with an earlier run (-c), a ROM's log works as well.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "counters.h"
+#include "debug.h"
+#include "display.h"
+#include "gamestate.h"
+#include "placement.h"
+#include "profile.h"
+#include "save.h"
+#include "text.h"
+#include "tonc_ext.h"
+
+#ifdef HOST_BUILD
+#include <linux/perf_event.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flashsim.h"
+#else
+#include <gba_input.h>
+#include <gba_interrupt.h>
+#include <gba_systemcalls.h>
+#endif
+
+#define BENCH_ITERATIONS 64
+// every autosave is a flash program, and erases now and then
+#define BENCH_SAVE_ITERATIONS 16
+
+#define BENCH_MAX_CASES 48
+#define BENCH_NAME_LEN 24
+
+#define BLIT_SIZE 64
+
+struct BenchCase {
+    char name[BENCH_NAME_LEN];
+    void (*run)(int arg);
+    int arg;
+    uint32_t iterations;
+};
+
+struct BenchResult {
+    uint32_t average;
+    uint32_t minimum;
+    // per iteration, 0 if they couldn't be counted
+    uint32_t instructions;
+};
+
+static struct BenchCase cases[BENCH_MAX_CASES];
+static struct BenchResult results[BENCH_MAX_CASES];
+static int numCases = 0;
+
+static struct GameState state;
+
+// what runText prints, the right way up and upside down
+static char textLines[2][256];
+
+static uint16_t blitPixels[BLIT_SIZE * BLIT_SIZE];
+static TSurface blitSource = {
+    (u8 *) blitPixels, BLIT_SIZE * 2, BLIT_SIZE, BLIT_SIZE, 16, 0, 0, NULL
+};
+
+static const char *colorNames[] = {
+    "white", "green", "red", "blue", "yellow", "magenta", "cyan",
+    "orange", "purple", "fuchsia", "lime", "gray", "cream",
+};
+
+#ifdef HOST_BUILD
+static int instructionCounter = -1;
+
+static void clockInit(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // fails in containers and VMs without a PMU, then there are just times
+    instructionCounter = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// ns
+static uint32_t clockNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+static uint64_t instructionsNow(void)
+{
+    uint64_t count = 0;
+
+    if (instructionCounter < 0 || read(instructionCounter, &count, sizeof(count)) != sizeof(count)) {
+        return 0;
+    }
+
+    return count;
+}
+#else
+static void clockInit(void)
+{
+}
+
+// cycles
+static uint32_t clockNow(void)
+{
+    return profileCycles();
+}
+
+static uint64_t instructionsNow(void)
+{
+    return 0;
+}
+#endif
+
+static void addCase(const char *name, void (*run)(int arg), int arg, uint32_t iterations)
+{
+    if (numCases == BENCH_MAX_CASES) {
+        debugPrintf("bench: too many cases, dropped %s", name);
+        return;
+    }
+
+    snprintf(cases[numCases].name, BENCH_NAME_LEN, "%s", name);
+    cases[numCases].run = run;
+    cases[numCases].arg = arg;
+    cases[numCases].iterations = iterations;
+    numCases++;
+}
+
+static void runBlit(int arg)
+{
+    sbmp16_blit(tte_get_surface(), 88, 48, BLIT_SIZE, BLIT_SIZE, &blitSource, 0, 0);
+}
+
+static void runBlitUd(int arg)
+{
+    sbmp16_blit_ud(tte_get_surface(), 88, 48, BLIT_SIZE, BLIT_SIZE, &blitSource, 0, 0);
+}
+
+static void runRectUd(int arg)
+{
+    sbmp16_rect_ud(tte_get_surface(), 88, 48, 88 + BLIT_SIZE, 48 + BLIT_SIZE, CLR_BLUE);
+}
+
+// arg is the color times 2 plus ud, with 3 digits
+static void runLargeNumber(int arg)
+{
+    printLargeNumber(0, 0, 123, arg / 2, arg % 2);
+}
+
+// a life past 999, five glyphs of the medium font in the large slots
+static void runLargeFallback(int arg)
+{
+    printLargeNumber(0, 0, 12345, COLOR_BLUE, arg);
+}
+
+// a seat's life with more than four players
+static void runMediumNumber(int arg)
+{
+    printPlayerNumber(NUMBER_SIZE_MEDIUM, 5, 0, 123, 0, COLOR_BLUE, 0);
+}
+
+// selecting another player or one dying, where the display has player inks
+static void runPlayerLook(int arg)
+{
+    setPlayerLook(0, COLOR_RED);
+}
+
+static void runHugeNumber(int arg)
+{
+    printHugeNumber(123);
+}
+
+// the counters line of the top left square, as printCounters prints it
+static void runText(int arg)
+{
+    printText(1, 5, getScreenWidth() / 2, arg, textLines[arg]);
+}
+
+static void runPrepareCounters(int arg)
+{
+    char countersBuf[COUNTER_TEXT_LEN], commanderDamageBuf[COUNTER_TEXT_LEN];
+
+    prepareCounters(countersBuf, commanderDamageBuf, sizeof(countersBuf), &state, 0, arg);
+}
+
+static void runSaveState(int arg)
+{
+    playerAddLife(&state.players, 0, -1);
+    saveState(&state, SAVE_SLOT_AUTO);
+}
+
+static void setup(void)
+{
+    char name[BENCH_NAME_LEN];
+
+    for (int i = 0; i < BLIT_SIZE * BLIT_SIZE; i++) {
+        blitPixels[i] = i * 0x0421;
+    }
+
+    // a 4 player commander game with some damage and counters, player 0
+    // selected so everything gets a dot somewhere
+    initializeGameState(&state);
+    state.maxPlayers = 4;
+    state.maxOpponents = 3;
+    for (int i = 0; i < state.maxPlayers; i++) {
+        playerAddLife(&state.players, i, -i * 7);
+        for (int j = 0; j < state.maxOpponents; j++) {
+            playerAddCommanderDamage(&state.players, i, j, (i + j) * 4);
+        }
+        playerAddCounter(&state.players, i, POISON_COUNTER, i);
+        playerAddCounter(&state.players, i, ENERGY_COUNTER, 2);
+        playerAddCounter(&state.players, i, EXPERIENCE_COUNTER, 1);
+        playerAddCounter(&state.players, i, COMMANDERTAX_COUNTER, i + 1);
+    }
+    state.state = STATE_COUNTLIFE;
+
+    for (int ud = 0; ud < 2; ud++) {
+        char commanderDamageBuf[256];
+
+        prepareCounters(textLines[ud], commanderDamageBuf, sizeof(textLines[ud]), &state, 0, ud);
+    }
+
+    // the blitters draw into the mode 3 framebuffer
+    if (!displayHasLayers() && tte_get_surface()->bpp == 16) {
+        addCase("blit", runBlit, 0, BENCH_ITERATIONS);
+        addCase("blit_ud", runBlitUd, 0, BENCH_ITERATIONS);
+        addCase("rect_ud", runRectUd, 0, BENCH_ITERATIONS);
+    }
+    for (int col = 0; col < (int) (sizeof(colorNames) / sizeof(colorNames[0])); col++) {
+        for (int ud = 0; ud < 2; ud++) {
+            snprintf(name, sizeof(name), "large_%s%s", colorNames[col], ud ? "_ud" : "");
+            addCase(name, runLargeNumber, col * 2 + ud, BENCH_ITERATIONS);
+        }
+    }
+    addCase("large_fallback", runLargeFallback, 0, BENCH_ITERATIONS);
+    addCase("large_fallback_ud", runLargeFallback, 1, BENCH_ITERATIONS);
+    addCase("medium", runMediumNumber, 0, BENCH_ITERATIONS);
+    if (displayHasPlayerInks()) {
+        addCase("player_look", runPlayerLook, 0, BENCH_ITERATIONS);
+    }
+    addCase("huge", runHugeNumber, 0, BENCH_ITERATIONS);
+    addCase("text", runText, 0, BENCH_ITERATIONS);
+    addCase("text_ud", runText, 1, BENCH_ITERATIONS);
+    addCase("prepare_counters", runPrepareCounters, 0, BENCH_ITERATIONS);
+    addCase("prepare_counters_ud", runPrepareCounters, 1, BENCH_ITERATIONS);
+    addCase("save_state", runSaveState, 0, BENCH_SAVE_ITERATIONS);
+}
+
+static void runCase(struct BenchCase *c, struct BenchResult *r)
+{
+    uint64_t total = 0;
+    uint64_t instructions;
+
+    c->run(c->arg);
+
+    r->minimum = UINT32_MAX;
+    instructions = instructionsNow();
+    for (uint32_t i = 0; i < c->iterations; i++) {
+        uint32_t start = clockNow();
+
+        c->run(c->arg);
+
+        uint32_t took = clockNow() - start;
+        total += took;
+        if (took < r->minimum) {
+            r->minimum = took;
+        }
+    }
+    r->instructions = (instructionsNow() - instructions) / c->iterations;
+    r->average = total / c->iterations;
+}
+
+static void runAll(void)
+{
+    clockInit();
+    setup();
+
+    for (int i = 0; i < numCases; i++) {
+        runCase(&cases[i], &results[i]);
+    }
+}
+
+#ifdef HOST_BUILD
+struct Baseline {
+    char name[BENCH_NAME_LEN];
+    uint32_t average;
+};
+
+// the cases of an earlier run, from a file written by -o or a ROM's log
+static int readBaseline(const char *path, struct Baseline *baseline, int max)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int n = 0;
+
+    if (!f) {
+        fprintf(stderr, "bench: can't read %s\n", path);
+        return -1;
+    }
+
+    while (n < max && fgets(line, sizeof(line), f)) {
+        char *p = strstr(line, "bench: ");
+        unsigned int iterations, average;
+
+        p = p ? p + 7 : line;
+        if (*p == '#' || sscanf(p, "%23s %u %u", baseline[n].name, &iterations, &average) != 3) {
+            continue;
+        }
+        baseline[n].average = average;
+        n++;
+    }
+
+    fclose(f);
+    return n;
+}
+
+static void compare(const char *path)
+{
+    struct Baseline baseline[BENCH_MAX_CASES];
+    int n = readBaseline(path, baseline, BENCH_MAX_CASES);
+
+    for (int i = 0; i < numCases; i++) {
+        for (int j = 0; j < n; j++) {
+            if (strcmp(cases[i].name, baseline[j].name) == 0 && baseline[j].average > 0) {
+                printf("%-24s %10u -> %10u  %+6.1f%%\n", cases[i].name,
+                       (unsigned int) baseline[j].average, (unsigned int) results[i].average,
+                       100.0 * ((double) results[i].average - baseline[j].average) / baseline[j].average);
+            }
+        }
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -o file    write the results there instead of stdout\n"
+        "  -c file    compare with the results of an earlier run\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = NULL;
+    const char *baseline = NULL;
+    FILE *f = stdout;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:c:")) != -1) {
+        switch (opt) {
+            case 'o':
+                output = optarg;
+                break;
+            case 'c':
+                baseline = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc) {
+        usage(argv[0]);
+    }
+
+    flashSimInit(flashSimFindModel("macronix128k"), 1);
+    profileInit();
+    initializeText();
+    saveInit();
+
+    runAll();
+
+    if (output && !(f = fopen(output, "w"))) {
+        fprintf(stderr, "bench: can't write %s\n", output);
+        return 1;
+    }
+
+    fprintf(f, "# host, ns: name iterations average minimum instructions\n");
+    for (int i = 0; i < numCases; i++) {
+        fprintf(f, "%s %u %u %u %u\n", cases[i].name, (unsigned int) cases[i].iterations,
+                (unsigned int) results[i].average, (unsigned int) results[i].minimum,
+                (unsigned int) results[i].instructions);
+    }
+
+    if (output && fclose(f)) {
+        return 1;
+    }
+
+    if (baseline) {
+        compare(baseline);
+    }
+
+    return 0;
+}
+#else
+// rows of results per page, the last row is for the page number
+#define BENCH_PAGE_ROWS 19
+
+static void showPage(int page)
+{
+    int pages = (numCases + BENCH_PAGE_ROWS - 1) / BENCH_PAGE_ROWS;
+
+    clearScreen();
+    for (int i = 0; i < BENCH_PAGE_ROWS && page * BENCH_PAGE_ROWS + i < numCases; i++) {
+        int c = page * BENCH_PAGE_ROWS + i;
+
+        printText(i, 0, getScreenWidth(), 0, "%-20s%9u", cases[c].name, (unsigned int) results[c].average);
+    }
+    printText(BENCH_PAGE_ROWS, 0, getScreenWidth(), 0, "cycles, page %d/%d, A: next", page + 1, pages);
+}
+
+int main(void)
+{
+    int page = 0;
+
+    placementInit();
+    profileInit();
+    debugInit();
+
+    irqInit();
+    irqEnable(IRQ_VBLANK);
+
+    saveInit();
+    initializeText();
+
+    runAll();
+
+    debugPrintf("bench: # gba, cycles: name iterations average minimum");
+    for (int i = 0; i < numCases; i++) {
+        debugPrintf("bench: %s %u %u %u", cases[i].name, (unsigned int) cases[i].iterations,
+                    (unsigned int) results[i].average, (unsigned int) results[i].minimum);
+    }
+
+    showPage(page);
+
+    while (1) {
+        VBlankIntrWait();
+        scanKeys();
+
+        if (keysDown() & KEY_A) {
+            page = (page + 1) % ((numCases + BENCH_PAGE_ROWS - 1) / BENCH_PAGE_ROWS);
+            showPage(page);
+        }
+    }
+}
+#endif
@@ -0,0 +1,342 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flashsim.h"
+#include "savechip.h"
+
+#define MAX_SIZE 0x20000
+#define MAX_SECTORS (MAX_SIZE / SAVECHIP_SECTOR_SIZE)
+
+// Rough datasheet figures, the max values are what the stall numbers are
+// about.
+const struct FlashSimModel flashSimModels[] = {
+    { "sram32k", 1, 0, 0, 0x8000, 0, 0, 0, 0 },
+    { "sst64k", 0, 0xbf, 0xd4, 0x10000, 14000, 20000, 18000000, 25000000 },
+    { "panasonic64k", 0, 0x32, 0x1b, 0x10000, 10000, 120000, 40000000, 200000000 },
+    { "macronix128k", 0, 0xc2, 0x09, 0x20000, 20000, 200000, 60000000, 500000000 },
+    { 0 },
+};
+
+enum {
+    MODE_READ = 0,
+    MODE_ID,
+};
+
+enum {
+    BUSY_NONE = 0,
+    BUSY_PROGRAM,
+    BUSY_ERASE,
+};
+
+enum {
+    PENDING_NONE = 0,
+    PENDING_PROGRAM,
+    PENDING_ERASE,
+    PENDING_BANK,
+};
+
+static struct {
+    const struct FlashSimModel *model;
+    uint8_t data[MAX_SIZE];
+    uint32_t eraseCount[MAX_SECTORS];
+    uint32_t badPrograms;
+    uint64_t now;
+    uint32_t rng;
+
+    int mode;
+    int step; // position in the AA/55/cmd unlock sequence
+    int pending;
+    int eraseUnlocked; // 0x80 seen, waiting for AA/55/30
+    int bank;
+
+    int busy;
+    uint64_t busyUntil;
+    uint32_t busyAddr;
+    uint8_t busyValue;
+    uint8_t toggle;
+
+    uint64_t powerLossAt;
+    jmp_buf *powerLossEnv;
+} sim;
+
+static uint32_t nextRandom(void)
+{
+    // xorshift32, deterministic per seed
+    sim.rng ^= sim.rng << 13;
+    sim.rng ^= sim.rng >> 17;
+    sim.rng ^= sim.rng << 5;
+    return sim.rng;
+}
+
+static uint64_t latency(uint32_t typ, uint32_t max)
+{
+    // mostly typical, sometimes anywhere up to the worst case
+    if (max <= typ || nextRandom() % 8) {
+        return typ;
+    }
+
+    return typ + nextRandom() % (max - typ + 1);
+}
+
+static void finishBusy(void)
+{
+    if (sim.busy == BUSY_PROGRAM) {
+        if (~sim.data[sim.busyAddr] & sim.busyValue) {
+            sim.badPrograms++;
+        }
+        sim.data[sim.busyAddr] &= sim.busyValue;
+    } else if (sim.busy == BUSY_ERASE) {
+        memset(&sim.data[sim.busyAddr], 0xff, SAVECHIP_SECTOR_SIZE);
+    }
+
+    sim.busy = BUSY_NONE;
+}
+
+static void loseBusy(void)
+{
+    // an interrupted operation leaves some bits done and some not
+    if (sim.busy == BUSY_PROGRAM) {
+        sim.data[sim.busyAddr] &= sim.busyValue | nextRandom();
+    } else if (sim.busy == BUSY_ERASE) {
+        for (int i = 0; i < SAVECHIP_SECTOR_SIZE; i++) {
+            sim.data[sim.busyAddr + i] |= nextRandom();
+        }
+    }
+
+    sim.busy = BUSY_NONE;
+}
+
+static void tick(void)
+{
+    sim.now += FLASHSIM_BUS_ACCESS_NS;
+
+    if (sim.busy && sim.now >= sim.busyUntil && !(sim.powerLossAt && sim.powerLossAt <= sim.busyUntil)) {
+        finishBusy();
+    }
+
+    if (sim.powerLossAt && sim.now >= sim.powerLossAt) {
+        jmp_buf *env = sim.powerLossEnv;
+
+        loseBusy();
+        sim.powerLossAt = 0;
+        sim.powerLossEnv = 0;
+        longjmp(*env, 1);
+    }
+}
+
+const struct FlashSimModel *flashSimFindModel(const char *name)
+{
+    for (int i = 0; flashSimModels[i].name; i++) {
+        if (!strcmp(flashSimModels[i].name, name)) {
+            return &flashSimModels[i];
+        }
+    }
+
+    return 0;
+}
+
+void flashSimInit(const struct FlashSimModel *model, uint32_t seed)
+{
+    memset(&sim, 0, sizeof(sim));
+    sim.model = model;
+    sim.rng = seed ? seed : 1;
+    // a blank chip is erased
+    memset(sim.data, 0xff, sizeof(sim.data));
+}
+
+const struct FlashSimModel *flashSimModel(void)
+{
+    return sim.model;
+}
+
+uint8_t *flashSimData(void)
+{
+    return sim.data;
+}
+
+int flashSimLoad(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        // first run, the chip starts out blank
+        return 0;
+    }
+
+    size_t len = fread(sim.data, 1, sim.model->size, f);
+    fclose(f);
+
+    if (len != sim.model->size) {
+        fprintf(stderr, "flashsim: %s is %zu bytes, the %s chip has %u\n",
+                path, len, sim.model->name, (unsigned int) sim.model->size);
+        return -1;
+    }
+
+    return 0;
+}
+
+int flashSimStore(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (!f || fwrite(sim.data, 1, sim.model->size, f) != sim.model->size) {
+        fprintf(stderr, "flashsim: can't write %s\n", path);
+        if (f) {
+            fclose(f);
+        }
+        return -1;
+    }
+
+    return fclose(f) ? -1 : 0;
+}
+
+uint64_t flashSimNow(void)
+{
+    return sim.now;
+}
+
+void flashSimPowerLossAt(uint64_t at_ns, jmp_buf *env)
+{
+    sim.powerLossAt = at_ns;
+    sim.powerLossEnv = env;
+}
+
+void flashSimPowerCycle(void)
+{
+    sim.mode = MODE_READ;
+    sim.step = 0;
+    sim.pending = PENDING_NONE;
+    sim.eraseUnlocked = 0;
+    sim.bank = 0;
+    sim.busy = BUSY_NONE;
+}
+
+uint32_t flashSimEraseCount(int sector)
+{
+    return sim.eraseCount[sector];
+}
+
+int flashSimSectors(void)
+{
+    return sim.model->size / SAVECHIP_SECTOR_SIZE;
+}
+
+uint32_t flashSimBadPrograms(void)
+{
+    return sim.badPrograms;
+}
+
+uint8_t saveBusRead(uint32_t addr)
+{
+    tick();
+
+    addr %= SAVECHIP_BANK_SIZE;
+    if (sim.model->sram) {
+        return sim.data[addr % sim.model->size];
+    }
+
+    if (sim.busy) {
+        // status polling: DQ7 inverted until done, DQ6 toggles
+        sim.toggle ^= 0x40;
+        if (sim.busy == BUSY_PROGRAM) {
+            return (~sim.busyValue & 0x80) | sim.toggle;
+        }
+        return sim.toggle;
+    }
+
+    if (sim.mode == MODE_ID && addr < 2) {
+        return addr == 0 ? sim.model->manufacturer : sim.model->device;
+    }
+
+    return sim.data[sim.bank * SAVECHIP_BANK_SIZE + addr];
+}
+
+void saveBusWrite(uint32_t addr, uint8_t value)
+{
+    tick();
+
+    addr %= SAVECHIP_BANK_SIZE;
+    if (sim.model->sram) {
+        sim.data[addr % sim.model->size] = value;
+        return;
+    }
+
+    // the chip ignores everything while it's working
+    if (sim.busy) {
+        return;
+    }
+
+    if (sim.pending == PENDING_PROGRAM) {
+        sim.pending = PENDING_NONE;
+        sim.busy = BUSY_PROGRAM;
+        sim.busyAddr = sim.bank * SAVECHIP_BANK_SIZE + addr;
+        sim.busyValue = value;
+        sim.busyUntil = sim.now + latency(sim.model->programTypNs, sim.model->programMaxNs);
+        return;
+    }
+
+    if (sim.pending == PENDING_BANK) {
+        sim.pending = PENDING_NONE;
+        if (addr == 0) {
+            sim.bank = value & 1;
+        }
+        return;
+    }
+
+    if (value == 0xf0 && sim.step == 0) {
+        sim.mode = MODE_READ;
+        sim.eraseUnlocked = 0;
+        return;
+    }
+
+    switch (sim.step) {
+        case 0:
+            sim.step = (addr == 0x5555 && value == 0xaa) ? 1 : 0;
+            return;
+        case 1:
+            sim.step = (addr == 0x2aaa && value == 0x55) ? 2 : 0;
+            return;
+    };
+
+    sim.step = 0;
+
+    if (sim.eraseUnlocked) {
+        sim.eraseUnlocked = 0;
+        if (value == 0x30) {
+            uint32_t sector = (sim.bank * SAVECHIP_BANK_SIZE + addr) / SAVECHIP_SECTOR_SIZE;
+            sim.eraseCount[sector]++;
+            sim.busy = BUSY_ERASE;
+            sim.busyAddr = sector * SAVECHIP_SECTOR_SIZE;
+            sim.busyUntil = sim.now + latency(sim.model->eraseTypNs, sim.model->eraseMaxNs);
+        }
+        return;
+    }
+
+    if (addr != 0x5555) {
+        return;
+    }
+
+    switch (value) {
+        case 0x80:
+            sim.eraseUnlocked = 1;
+            break;
+        case 0x90:
+            sim.mode = MODE_ID;
+            break;
+        case 0xa0:
+            sim.pending = PENDING_PROGRAM;
+            break;
+        case 0xb0:
+            if (sim.model->size > SAVECHIP_BANK_SIZE) {
+                sim.pending = PENDING_BANK;
+            }
+            break;
+        case 0xf0:
+            sim.mode = MODE_READ;
+            break;
+    };
+}
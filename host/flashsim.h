@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef FLASHSIM_H__
+#define FLASHSIM_H__
+
+#include <setjmp.h>
+#include <stdint.h>
+
+// Host model of the cartridge save chip. It sits behind saveBusRead and
+// saveBusWrite, decodes the flash command sequences and keeps a simulated
+// clock so the time spent in the save code can be measured.
+
+struct FlashSimModel {
+    const char *name;
+    int sram; // plain SRAM, no commands and no erase
+    uint8_t manufacturer;
+    uint8_t device;
+    uint32_t size;
+    // latencies in ns, the chip takes a random time between typ and max
+    uint32_t programTypNs;
+    uint32_t programMaxNs;
+    uint32_t eraseTypNs;
+    uint32_t eraseMaxNs;
+};
+
+// one access on the 8 bit save bus with 8 waitstates plus a few cycles of
+// driver code around it
+#define FLASHSIM_BUS_ACCESS_NS 600
+
+extern const struct FlashSimModel flashSimModels[];
+const struct FlashSimModel *flashSimFindModel(const char *name);
+
+void flashSimInit(const struct FlashSimModel *model, uint32_t seed);
+const struct FlashSimModel *flashSimModel(void);
+// the chip contents, flashSimModel()->size bytes, to keep them in a file
+uint8_t *flashSimData(void);
+// Read the contents from a file (a missing file leaves the chip blank) or
+// write them to one, 0 on success.
+int flashSimLoad(const char *path);
+int flashSimStore(const char *path);
+uint64_t flashSimNow(void);
+// Cuts the power once the clock reaches at_ns: the running program or erase
+// is left half done and the simulator longjmps to env. 0 disarms.
+void flashSimPowerLossAt(uint64_t at_ns, jmp_buf *env);
+// back to read mode after a power loss, the contents stay
+void flashSimPowerCycle(void);
+uint32_t flashSimEraseCount(int sector);
+int flashSimSectors(void);
+// programs that tried to set bits, which flash can't do
+uint32_t flashSimBadPrograms(void);
+
+#endif
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "framedump.h"
+
+// the PNG is written with uncompressed deflate blocks, no zlib needed
+#define DEFLATE_STORED_MAX 65535
+
+static void toRgb(uint16_t c, uint8_t *rgb)
+{
+    // 5 bits to 8, the top bits repeat in the bottom
+    rgb[0] = (c & 0x1f) << 3 | (c & 0x1f) >> 2;
+    rgb[1] = ((c >> 5) & 0x1f) << 3 | ((c >> 5) & 0x1f) >> 2;
+    rgb[2] = ((c >> 10) & 0x1f) << 3 | ((c >> 10) & 0x1f) >> 2;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+    }
+
+    return ~crc;
+}
+
+static void putBE(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void writeChunk(FILE *f, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t head[8];
+    uint8_t tail[4];
+    uint32_t crc;
+
+    putBE(head, len);
+    memcpy(head + 4, type, 4);
+    crc = crc32(0, head + 4, 4);
+    crc = crc32(crc, data, len);
+    putBE(tail, crc);
+
+    fwrite(head, 1, 8, f);
+    fwrite(data, 1, len, f);
+    fwrite(tail, 1, 4, f);
+}
+
+static int writePng(FILE *f, const uint16_t *pixels, int width, int height)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    size_t rawSize = (size_t) height * (1 + width * 3);
+    size_t blocks = (rawSize + DEFLATE_STORED_MAX - 1) / DEFLATE_STORED_MAX;
+    uint8_t *raw = malloc(rawSize);
+    uint8_t *z = malloc(2 + rawSize + blocks * 5 + 4);
+    uint8_t ihdr[13];
+    uint32_t a = 1, b = 0;
+    size_t pos = 0;
+
+    if (!raw || !z) {
+        free(raw);
+        free(z);
+        return -1;
+    }
+
+    for (int y = 0; y < height; y++) {
+        uint8_t *row = raw + (size_t) y * (1 + width * 3);
+
+        // no filter
+        row[0] = 0;
+        for (int x = 0; x < width; x++) {
+            toRgb(pixels[y * width + x], row + 1 + x * 3);
+        }
+    }
+
+    z[pos++] = 0x78;
+    z[pos++] = 0x01;
+    for (size_t done = 0; done < rawSize;) {
+        size_t n = rawSize - done > DEFLATE_STORED_MAX ? DEFLATE_STORED_MAX : rawSize - done;
+
+        z[pos++] = done + n == rawSize;
+        z[pos++] = n & 0xff;
+        z[pos++] = n >> 8;
+        z[pos++] = ~n & 0xff;
+        z[pos++] = (~n >> 8) & 0xff;
+        memcpy(z + pos, raw + done, n);
+        pos += n;
+        done += n;
+    }
+    for (size_t i = 0; i < rawSize; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE(z + pos, b << 16 | a);
+    pos += 4;
+
+    putBE(ihdr, width);
+    putBE(ihdr + 4, height);
+    ihdr[8] = 8; // bits per channel
+    ihdr[9] = 2; // RGB
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    fwrite(signature, 1, sizeof(signature), f);
+    writeChunk(f, "IHDR", ihdr, sizeof(ihdr));
+    writeChunk(f, "IDAT", z, pos);
+    writeChunk(f, "IEND", NULL, 0);
+
+    free(raw);
+    free(z);
+
+    return 0;
+}
+
+static int writePpm(FILE *f, const uint16_t *pixels, int width, int height)
+{
+    fprintf(f, "P6\n%d %d\n255\n", width, height);
+
+    for (int i = 0; i < width * height; i++) {
+        uint8_t rgb[3];
+
+        toRgb(pixels[i], rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+
+    return 0;
+}
+
+int frameDumpWrite(const char *path, const uint16_t *pixels, int width, int height)
+{
+    const char *ext = strrchr(path, '.');
+    FILE *f = fopen(path, "wb");
+    int ret;
+
+    if (!f) {
+        fprintf(stderr, "framedump: can't write %s\n", path);
+        return -1;
+    }
+
+    if (ext && !strcmp(ext, ".ppm")) {
+        ret = writePpm(f, pixels, width, height);
+    } else {
+        ret = writePng(f, pixels, width, height);
+    }
+
+    if (fclose(f) != 0) {
+        ret = -1;
+    }
+
+    return ret;
+}
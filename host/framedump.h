@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef FRAMEDUMP_H__
+#define FRAMEDUMP_H__
+
+#include <stdint.h>
+
+// Writes BGR555 pixels as a PNG or, if path ends in .ppm, a binary PPM.
+// Returns 0 on success.
+int frameDumpWrite(const char *path, const uint16_t *pixels, int width, int height);
+
+#endif
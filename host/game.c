@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Runs the game on the host for a number of frames, against the shim in
+ * shim/ and the flash simulator as the save chip. The chip contents can be
+ * kept in a file between runs and frames can be written out as PNG or PPM.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "flashsim.h"
+#include "framedump.h"
+#include "hostshim.h"
+
+static jmp_buf stop;
+static uint32_t frameLimit = 600;
+static const char *dumpPrefix = NULL;
+static uint32_t dumpEvery = 1;
+
+static void frame(void)
+{
+    uint32_t n = hostFrames();
+
+    if (dumpPrefix && n % dumpEvery == 0) {
+        char path[1024];
+
+        snprintf(path, sizeof(path), "%s%05u.png", dumpPrefix, (unsigned int) n);
+        frameDumpWrite(path, hostScreen(), SCREEN_WIDTH, SCREEN_HEIGHT);
+    }
+
+    if (n >= frameLimit) {
+        longjmp(stop, 1);
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -n frames  frames to run (default 600)\n"
+        "  -o file    write the last frame, .png or .ppm\n"
+        "  -d prefix  write frames as prefixNNNNN.png\n"
+        "  -e n       with -d, only every nth frame (default 1)\n"
+        "  -s file    save chip contents, read at the start and written at the end\n"
+        "  -m model   save chip, see flashSimModels (default macronix128k)\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *model = "macronix128k";
+    const char *output = NULL;
+    const char *saveFile = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:o:d:e:s:m:")) != -1) {
+        switch (opt) {
+            case 'n':
+                frameLimit = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'd':
+                dumpPrefix = optarg;
+                break;
+            case 'e':
+                dumpEvery = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                saveFile = optarg;
+                break;
+            case 'm':
+                model = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc || dumpEvery == 0) {
+        usage(argv[0]);
+    }
+
+    if (!flashSimFindModel(model)) {
+        fprintf(stderr, "game: unknown save chip %s\n", model);
+        return 1;
+    }
+    flashSimInit(flashSimFindModel(model), 1);
+
+    if (saveFile && flashSimLoad(saveFile)) {
+        return 1;
+    }
+
+    hostFrameHook = frame;
+    if (!setjmp(stop)) {
+        gameMain();
+    }
+
+    if (output && frameDumpWrite(output, hostScreen(), SCREEN_WIDTH, SCREEN_HEIGHT)) {
+        return 1;
+    }
+
+    if (saveFile && flashSimStore(saveFile)) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Plays a recorded session (the "input:" lines of an mGBA log, see
+ * source/input.h) through the game on the host. After every frame the
+ * framebuffer and the game state are hashed, a run can be written out and
+ * later runs compared against it, so a change that should draw the same
+ * shows up as the first frame that doesn't. The time the game spent on each
+ * frame is measured as well.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "flashsim.h"
+#include "framedump.h"
+#include "hostshim.h"
+#include "input.h"
+#include "profile.h"
+#include "render.h"
+#include "trace.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME 0x100000001b3ull
+
+struct FrameResult {
+    uint64_t vram;
+    uint64_t state;
+    uint32_t cycles;
+};
+
+static struct Trace trace;
+static size_t nextEvent = 0;
+
+// results[n] is frame n, from 1 to lastFrame
+static struct FrameResult *results = NULL;
+static struct FrameResult *golden = NULL;
+static uint32_t goldenFrames = 0;
+static uint32_t lastFrame = 0;
+
+static const char *diffOutput = NULL;
+static uint32_t firstDiff = 0;
+static uint32_t diffs = 0;
+
+static jmp_buf stop;
+static uint32_t workStart = 0;
+
+static uint64_t hash(const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    uint64_t h = FNV_OFFSET;
+
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+
+    return h;
+}
+
+static void compare(uint32_t n)
+{
+    if (n > goldenFrames) {
+        return;
+    }
+
+    if (results[n].vram == golden[n].vram && results[n].state == golden[n].state) {
+        return;
+    }
+
+    if (diffs++ == 0) {
+        firstDiff = n;
+        if (diffOutput) {
+            frameDumpWrite(diffOutput, hostScreen(), SCREEN_WIDTH, SCREEN_HEIGHT);
+        }
+    }
+}
+
+static void frame(void)
+{
+    uint32_t now = profileCycles();
+    uint32_t n = hostFrames();
+
+    // the hook runs at the start of frame n, frame n - 1 is done
+    if (n > 1) {
+        struct FrameResult *r = &results[n - 1];
+        const struct GameState *state = inputGameState();
+
+        r->cycles = now - workStart;
+        r->vram = hash(hostScreen(), SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(u16));
+        r->state = state ? hash(state, sizeof(*state)) : 0;
+
+        if (golden) {
+            compare(n - 1);
+        }
+    }
+
+    if (n > lastFrame) {
+        longjmp(stop, 1);
+    }
+
+    // the keys scanKeys sees in frame n
+    while (nextEvent < trace.count && trace.events[nextEvent].frame == n) {
+        hostKeys = (hostKeys | trace.events[nextEvent].down) & ~trace.events[nextEvent].up;
+        nextEvent++;
+    }
+
+    workStart = profileCycles();
+}
+
+static int readGolden(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[128];
+
+    if (!f) {
+        fprintf(stderr, "replay: can't read %s\n", path);
+        return -1;
+    }
+
+    golden = calloc(lastFrame + 1, sizeof(*golden));
+    if (!golden) {
+        fprintf(stderr, "replay: out of memory\n");
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned int n;
+        unsigned long long vram, state;
+
+        if (line[0] == '#') {
+            continue;
+        }
+
+        if (sscanf(line, "%u %llx %llx", &n, &vram, &state) != 3 || n != goldenFrames + 1) {
+            fprintf(stderr, "replay: %s: bad line for frame %u\n", path, goldenFrames + 1);
+            fclose(f);
+            return -1;
+        }
+
+        if (n > lastFrame) {
+            // longer than this run, counted below
+            goldenFrames = n;
+            continue;
+        }
+
+        golden[n].vram = vram;
+        golden[n].state = state;
+        goldenFrames = n;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int writeHashes(const char *path, const char *tracePath)
+{
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        fprintf(stderr, "replay: can't write %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "# replay of %s: frame, framebuffer hash, game state hash\n", tracePath);
+    for (uint32_t n = 1; n <= lastFrame; n++) {
+        fprintf(f, "%u %016llx %016llx\n", (unsigned int) n,
+                (unsigned long long) results[n].vram, (unsigned long long) results[n].state);
+    }
+
+    return fclose(f) ? -1 : 0;
+}
+
+static int writeTimes(const char *path)
+{
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        fprintf(stderr, "replay: can't write %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "# frame, cycles\n");
+    for (uint32_t n = 1; n <= lastFrame; n++) {
+        fprintf(f, "%u %u\n", (unsigned int) n, (unsigned int) results[n].cycles);
+    }
+
+    return fclose(f) ? -1 : 0;
+}
+
+static void report(void)
+{
+    uint64_t total = 0;
+    uint32_t worst = 0, worstFrame = 0;
+
+    for (uint32_t n = 1; n <= lastFrame; n++) {
+        total += results[n].cycles;
+        if (results[n].cycles > worst) {
+            worst = results[n].cycles;
+            worstFrame = n;
+        }
+    }
+
+    double seconds = (double) total / PROFILE_CYCLES_PER_SECOND;
+
+    printf("frames: %u, %u key changes\n", (unsigned int) lastFrame, (unsigned int) trace.count);
+    printf("speed: %.0f fps\n", seconds > 0 ? lastFrame / seconds : 0.0);
+    printf("work: average %llu cycles (%.2f%% of a frame), worst %u at frame %u\n",
+           (unsigned long long) (total / lastFrame),
+           100.0 * total / lastFrame / PROFILE_CYCLES_PER_FRAME,
+           (unsigned int) worst, (unsigned int) worstFrame);
+    printf("overrun frames: %u\n", (unsigned int) renderOverrunFrames());
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options] trace\n"
+        "  trace      mGBA log with input: lines, see source/input.h\n"
+        "  -n frames  frames to run after the last key change (default 60), or\n"
+        "             to the trace's # frames if that's later\n"
+        "  -w file    write the hashes of every frame\n"
+        "  -g file    compare against hashes written with -w\n"
+        "  -x file    with -g, write the first frame that differs (.png or .ppm)\n"
+        "  -t file    write the cycles the game took for every frame\n"
+        "  -s file    save chip contents the session started with\n"
+        "  -m model   save chip, see flashSimModels (default macronix128k)\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *model = "macronix128k";
+    const char *saveFile = NULL;
+    const char *hashFile = NULL;
+    const char *goldenFile = NULL;
+    const char *timesFile = NULL;
+    uint32_t settle = 60;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:w:g:x:t:s:m:")) != -1) {
+        switch (opt) {
+            case 'n':
+                settle = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                hashFile = optarg;
+                break;
+            case 'g':
+                goldenFile = optarg;
+                break;
+            case 'x':
+                diffOutput = optarg;
+                break;
+            case 't':
+                timesFile = optarg;
+                break;
+            case 's':
+                saveFile = optarg;
+                break;
+            case 'm':
+                model = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc - 1) {
+        usage(argv[0]);
+    }
+
+    if (!flashSimFindModel(model)) {
+        fprintf(stderr, "replay: unknown save chip %s\n", model);
+        return 1;
+    }
+    flashSimInit(flashSimFindModel(model), 1);
+
+    // the chip file isn't written back, every run starts from the same save
+    if (saveFile && flashSimLoad(saveFile)) {
+        return 1;
+    }
+
+    traceInit(&trace);
+    if (traceRead(&trace, argv[optind])) {
+        return 1;
+    }
+
+    lastFrame = traceLastFrame(&trace) + settle;
+    if (trace.frames > lastFrame) {
+        lastFrame = trace.frames;
+    }
+    if (lastFrame == 0) {
+        usage(argv[0]);
+    }
+
+    results = calloc(lastFrame + 1, sizeof(*results));
+    if (!results) {
+        fprintf(stderr, "replay: out of memory\n");
+        return 1;
+    }
+
+    if (goldenFile && readGolden(goldenFile)) {
+        return 1;
+    }
+
+    // every queued job runs in the frame it was queued in, however slow the
+    // host is, so the frames don't depend on it
+    renderSetBudget(UINT32_MAX);
+
+    hostFrameHook = frame;
+    if (!setjmp(stop)) {
+        gameMain();
+    }
+
+    report();
+
+    if (hashFile && writeHashes(hashFile, argv[optind])) {
+        return 1;
+    }
+
+    if (timesFile && writeTimes(timesFile)) {
+        return 1;
+    }
+
+    if (goldenFile) {
+        if (goldenFrames != lastFrame) {
+            printf("golden: %u frames, this run %u\n", (unsigned int) goldenFrames, (unsigned int) lastFrame);
+        }
+
+        if (diffs) {
+            printf("golden: %u frames differ, the first is %u\n", (unsigned int) diffs, (unsigned int) firstDiff);
+        } else {
+            printf("golden: all frames match\n");
+        }
+
+        if (diffs || goldenFrames != lastFrame) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
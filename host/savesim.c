@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+// Runs the save code against the flash simulator and reports how it holds
+// up: power loss in the middle of a save, how evenly the sectors wear and
+// how long a save stalls the game in the worst case.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "flashsim.h"
+#include "save.h"
+
+#define FRAME_NS 16743000ULL
+
+// a little more than struct SaveableGameState
+#define DEFAULT_PAYLOAD 448
+
+static int payloadSize = DEFAULT_PAYLOAD;
+
+static void makePayload(uint8_t *buf, uint32_t version)
+{
+    for (int i = 0; i < payloadSize; i++) {
+        buf[i] = (version * 31 + i * 7) ^ (version >> 8);
+    }
+}
+
+// returns the version stored in slot or -1 when it's missing or unknown
+static long readVersion(int slot, uint32_t newest)
+{
+    uint8_t buf[1024], expected[1024];
+
+    if (saveSlotRead(slot, buf, payloadSize) != payloadSize) {
+        return -1;
+    }
+
+    for (uint32_t v = newest + 1; v-- > 0 && v + 4 > newest;) {
+        makePayload(expected, v);
+        if (!memcmp(buf, expected, payloadSize)) {
+            return v;
+        }
+    }
+
+    return -1;
+}
+
+// Cuts the power at a random point within window ns of starting an autosave,
+// afterwards both slots have to hold either the old or the new state.
+static int runDurability(const struct FlashSimModel *model, int trials, uint32_t seed, uint64_t window)
+{
+    uint8_t buf[1024];
+    uint32_t manual = 1000, current = 0;
+    int completed = 0, rolledBack = 0, rolledForward = 0, lost = 0;
+
+    flashSimInit(model, seed);
+    saveInit();
+
+    makePayload(buf, manual);
+    saveSlotWrite(SAVE_SLOT_MANUAL, buf, payloadSize);
+    makePayload(buf, current);
+    saveSlotWrite(SAVE_SLOT_AUTO, buf, payloadSize);
+
+    srand(seed);
+
+    for (int t = 0; t < trials; t++) {
+        jmp_buf env;
+        uint64_t start = flashSimNow();
+
+        makePayload(buf, current + 1);
+
+        if (setjmp(env)) {
+            flashSimPowerCycle();
+            saveInit();
+
+            long autoVersion = readVersion(SAVE_SLOT_AUTO, current + 1);
+            long manualVersion = readVersion(SAVE_SLOT_MANUAL, manual);
+
+            if (autoVersion < 0 || manualVersion != manual) {
+                lost++;
+                fprintf(stderr, "%s: trial %d lost data (auto %ld, manual %ld)\n", model->name, t, autoVersion, manualVersion);
+                // start over from a known state
+                makePayload(buf, current);
+                saveSlotWrite(SAVE_SLOT_AUTO, buf, payloadSize);
+                continue;
+            }
+
+            if (autoVersion == current) {
+                rolledBack++;
+            } else {
+                rolledForward++;
+                current = autoVersion;
+            }
+            continue;
+        }
+
+        flashSimPowerLossAt(start + 1 + ((uint64_t) rand() * rand()) % window, &env);
+        saveSlotWrite(SAVE_SLOT_AUTO, buf, payloadSize);
+        flashSimPowerLossAt(0, 0);
+        completed++;
+        current++;
+    }
+
+    printf("  durability: %d power cuts, %d rolled back, %d rolled forward, %d finished anyway, %d lost\n",
+           rolledBack + rolledForward + lost, rolledBack, rolledForward, completed, lost);
+
+    return lost == 0;
+}
+
+static int runWearAndStall(const struct FlashSimModel *model, int saves, uint32_t seed, uint64_t *worstStall)
+{
+    uint8_t buf[1024];
+    uint64_t total = 0, worst = 0;
+    int failed = 0;
+
+    flashSimInit(model, seed);
+    saveInit();
+
+    for (int i = 0; i < saves; i++) {
+        // one manual save for every 20 autosaves
+        int slot = (i % 20 == 19) ? SAVE_SLOT_MANUAL : SAVE_SLOT_AUTO;
+        uint64_t start = flashSimNow();
+
+        makePayload(buf, i);
+        if (!saveSlotWrite(slot, buf, payloadSize)) {
+            failed++;
+        }
+
+        uint64_t elapsed = flashSimNow() - start;
+        total += elapsed;
+        if (elapsed > worst) {
+            worst = elapsed;
+        }
+
+        if (readVersion(slot, i) != i) {
+            failed++;
+        }
+    }
+
+    printf("  stall: %d saves, avg %.2f ms, worst %.2f ms (%llu frames)\n",
+           saves, total / (double) saves / 1e6, worst / 1e6,
+           (unsigned long long) ((worst + FRAME_NS - 1) / FRAME_NS));
+
+    printf("  wear (erases per sector):");
+    uint32_t maxErases = 0;
+    for (int s = 0; s < flashSimSectors(); s++) {
+        uint32_t n = flashSimEraseCount(s);
+        printf(" %u", n);
+        if (n > maxErases) {
+            maxErases = n;
+        }
+    }
+    printf("\n");
+
+    if (maxErases) {
+        // 10000 cycles is the usual guaranteed endurance
+        printf("  endurance: ~%llu saves before the busiest sector reaches 10000 erases\n",
+               (unsigned long long) saves * 10000 / maxErases);
+    }
+
+    if (flashSimBadPrograms()) {
+        printf("  %u programs to bytes that weren't erased\n", flashSimBadPrograms());
+        failed++;
+    }
+
+    if (failed) {
+        printf("  %d saves failed or read back wrong\n", failed);
+    }
+
+    *worstStall = worst;
+
+    return failed == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *modelName = 0;
+    int saves = 10000, trials = 2000, opt;
+    uint32_t seed = 1;
+
+    while ((opt = getopt(argc, argv, "m:n:t:s:p:")) != -1) {
+        switch (opt) {
+            case 'm':
+                modelName = optarg;
+                break;
+            case 'n':
+                saves = atoi(optarg);
+                break;
+            case 't':
+                trials = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                payloadSize = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-m model] [-n saves] [-t power cuts] [-s seed] [-p payload bytes]\n", argv[0]);
+                return 2;
+        };
+    }
+
+    if (payloadSize <= 0 || payloadSize > saveSlotCapacity(SAVE_SLOT_AUTO)) {
+        fprintf(stderr, "payload must be 1..%u bytes\n", saveSlotCapacity(SAVE_SLOT_AUTO));
+        return 2;
+    }
+
+    int ok = 1;
+    for (int i = 0; flashSimModels[i].name; i++) {
+        const struct FlashSimModel *model = &flashSimModels[i];
+
+        if (modelName && strcmp(modelName, model->name)) {
+            continue;
+        }
+
+        uint64_t worst = 0;
+
+        printf("%s:\n", model->name);
+        ok &= runWearAndStall(model, saves, seed, &worst);
+        ok &= runDurability(model, trials, seed, worst + 1);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef AAS_SHIM_H__
+#define AAS_SHIM_H__
+
+// The AAS calls the game makes, they accept everything and play nothing.
+
+#include <stdint.h>
+
+typedef int8_t AAS_s8;
+typedef uint8_t AAS_u8;
+typedef int16_t AAS_s16;
+typedef uint16_t AAS_u16;
+typedef int AAS_BOOL;
+
+#define AAS_TRUE 1
+#define AAS_FALSE 0
+
+#define AAS_OK 0
+#define AAS_ERROR_INVALID_CONFIG -1
+#define AAS_ERROR_CHANNEL_NOT_AVAILABLE -2
+#define AAS_ERROR_INVALID_SAMPLE_ADDRESS -3
+
+#define AAS_CONFIG_MIX_32KHZ 1
+#define AAS_CONFIG_MIX_28KHZ 2
+#define AAS_CONFIG_MIX_24KHZ 3
+#define AAS_CONFIG_MIX_20KHZ 4
+#define AAS_CONFIG_MIX_16KHZ 5
+#define AAS_CONFIG_MIX_12KHZ 6
+#define AAS_CONFIG_MIX_8KHZ 7
+
+#define AAS_CONFIG_CHANS_16_LOUD 1
+#define AAS_CONFIG_CHANS_8_LOUD 2
+#define AAS_CONFIG_CHANS_4_LOUD 3
+#define AAS_CONFIG_CHANS_16 4
+#define AAS_CONFIG_CHANS_8 5
+#define AAS_CONFIG_CHANS_4 6
+
+#define AAS_CONFIG_SPATIAL_STEREO 1
+#define AAS_CONFIG_SPATIAL_MONO 2
+
+#define AAS_CONFIG_DYNAMIC_OFF 0
+#define AAS_CONFIG_DYNAMIC_ON 1
+
+int AAS_SetConfig(int config_mix, int config_chans, int config_spatial, int config_dynamic);
+void AAS_Timer1InterruptHandler(void);
+
+int AAS_MOD_Play(int song_num);
+void AAS_MOD_Stop(void);
+AAS_BOOL AAS_MOD_IsPlaying(void);
+int AAS_MOD_SetVolume(int vol);
+int AAS_MOD_GetSongPos(void);
+int AAS_MOD_SetSongPos(int song_pos);
+
+int AAS_SFX_Play(int channel, int sample_volume, int sample_frequency,
+                 const AAS_s8 *sample_start, const AAS_s8 *sample_end, const AAS_s8 *sample_restart);
+AAS_BOOL AAS_SFX_ChannelExists(int channel);
+AAS_BOOL AAS_SFX_IsActive(int channel);
+int AAS_SFX_SetVolume(int channel, int vol);
+int AAS_SFX_Stop(int channel);
+
+#endif
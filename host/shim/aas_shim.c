@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include "AAS.h"
+#include "hostshim.h"
+
+// Nothing is mixed, but which effect channels exist and how long an effect
+// keeps its channel busy work like on the GBA so the voice allocation in
+// audio.c does the same thing. Both MODs have 4 channels, AAS keeps those
+// for them.
+
+#define SFX_CHANNELS 16
+
+static int channels = 0;
+static int modChannels = 4;
+static uint32_t activeUntil[SFX_CHANNELS];
+static int modPlaying = 0;
+static int modPos = 0;
+
+int AAS_SetConfig(int config_mix, int config_chans, int config_spatial, int config_dynamic)
+{
+    switch (config_chans) {
+        case AAS_CONFIG_CHANS_16:
+        case AAS_CONFIG_CHANS_16_LOUD:
+            channels = 16;
+            break;
+        case AAS_CONFIG_CHANS_8:
+        case AAS_CONFIG_CHANS_8_LOUD:
+            channels = 8;
+            break;
+        default:
+            channels = 4;
+    }
+
+    modPlaying = 0;
+    for (int i = 0; i < SFX_CHANNELS; i++) {
+        activeUntil[i] = 0;
+    }
+
+    return AAS_OK;
+}
+
+void AAS_Timer1InterruptHandler(void)
+{
+}
+
+int AAS_MOD_Play(int song_num)
+{
+    modPlaying = 1;
+    modPos = 0;
+
+    return AAS_OK;
+}
+
+void AAS_MOD_Stop(void)
+{
+    modPlaying = 0;
+}
+
+AAS_BOOL AAS_MOD_IsPlaying(void)
+{
+    return modPlaying;
+}
+
+int AAS_MOD_SetVolume(int vol)
+{
+    return AAS_OK;
+}
+
+int AAS_MOD_GetSongPos(void)
+{
+    return modPlaying ? modPos : -1;
+}
+
+int AAS_MOD_SetSongPos(int song_pos)
+{
+    modPos = song_pos;
+
+    return AAS_OK;
+}
+
+int AAS_SFX_Play(int channel, int sample_volume, int sample_frequency,
+                 const AAS_s8 *sample_start, const AAS_s8 *sample_end, const AAS_s8 *sample_restart)
+{
+    if (!AAS_SFX_ChannelExists(channel)) {
+        return AAS_ERROR_CHANNEL_NOT_AVAILABLE;
+    }
+
+    // looping effects play until they are stopped
+    if (sample_restart) {
+        activeUntil[channel] = UINT32_MAX;
+    } else {
+        activeUntil[channel] = hostFrames() + (uint32_t) ((sample_end - sample_start) * 60 / sample_frequency);
+    }
+
+    return AAS_OK;
+}
+
+AAS_BOOL AAS_SFX_ChannelExists(int channel)
+{
+    return channel >= 0 && channel < channels - modChannels;
+}
+
+AAS_BOOL AAS_SFX_IsActive(int channel)
+{
+    return AAS_SFX_ChannelExists(channel) && hostFrames() < activeUntil[channel];
+}
+
+int AAS_SFX_SetVolume(int channel, int vol)
+{
+    return AAS_SFX_ChannelExists(channel) ? AAS_OK : AAS_ERROR_CHANNEL_NOT_AVAILABLE;
+}
+
+int AAS_SFX_Stop(int channel)
+{
+    if (!AAS_SFX_ChannelExists(channel)) {
+        return AAS_ERROR_CHANNEL_NOT_AVAILABLE;
+    }
+
+    activeUntil[channel] = 0;
+
+    return AAS_OK;
+}
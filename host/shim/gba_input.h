@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef GBA_INPUT_SHIM_H__
+#define GBA_INPUT_SHIM_H__
+
+#include <stdint.h>
+
+enum KEYPAD_BITS {
+    KEY_A = 0x0001,
+    KEY_B = 0x0002,
+    KEY_SELECT = 0x0004,
+    KEY_START = 0x0008,
+    KEY_RIGHT = 0x0010,
+    KEY_LEFT = 0x0020,
+    KEY_UP = 0x0040,
+    KEY_DOWN = 0x0080,
+    KEY_R = 0x0100,
+    KEY_L = 0x0200,
+};
+
+// the buttons held right now, set by the host (see hostshim.h)
+extern uint16_t hostKeys;
+
+void scanKeys(void);
+uint16_t keysDown(void);
+uint16_t keysUp(void);
+uint16_t keysHeld(void);
+
+#endif
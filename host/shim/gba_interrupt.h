@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef GBA_INTERRUPT_SHIM_H__
+#define GBA_INTERRUPT_SHIM_H__
+
+#include <stdint.h>
+
+typedef void (*IntFn)(void);
+
+enum irqMASKS {
+    IRQ_VBLANK = 0x0001,
+    IRQ_HBLANK = 0x0002,
+    IRQ_VCOUNT = 0x0004,
+    IRQ_TIMER0 = 0x0008,
+    IRQ_TIMER1 = 0x0010,
+    IRQ_TIMER2 = 0x0020,
+    IRQ_TIMER3 = 0x0040,
+};
+
+extern volatile uint16_t hostIme;
+#define REG_IME hostIme
+
+// Only the VBlank handler is ever called, from VBlankIntrWait.
+void irqInit(void);
+IntFn *irqSet(int mask, IntFn function);
+void irqEnable(int mask);
+void irqDisable(int mask);
+
+#endif
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stddef.h>
+
+#include "gba_input.h"
+#include "gba_interrupt.h"
+#include "gba_systemcalls.h"
+#include "gba_timers.h"
+#include "hostshim.h"
+
+uint16_t hostKeys = 0;
+volatile uint16_t hostIme = 1;
+volatile uint16_t hostTimer1 = 0;
+void (*hostFrameHook)(void) = NULL;
+
+static uint16_t keysNow = 0;
+static uint16_t keysBefore = 0;
+static IntFn vblankHandler = NULL;
+static int enabled = 0;
+static uint32_t frames = 0;
+
+void scanKeys(void)
+{
+    keysBefore = keysNow;
+    keysNow = hostKeys;
+}
+
+uint16_t keysDown(void)
+{
+    return keysNow & ~keysBefore;
+}
+
+uint16_t keysUp(void)
+{
+    return ~keysNow & keysBefore;
+}
+
+uint16_t keysHeld(void)
+{
+    return keysNow;
+}
+
+void irqInit(void)
+{
+    vblankHandler = NULL;
+    enabled = 0;
+}
+
+IntFn *irqSet(int mask, IntFn function)
+{
+    if (mask & IRQ_VBLANK) {
+        vblankHandler = function;
+    }
+
+    return NULL;
+}
+
+void irqEnable(int mask)
+{
+    enabled |= mask;
+}
+
+void irqDisable(int mask)
+{
+    enabled &= ~mask;
+}
+
+void VBlankIntrWait(void)
+{
+    frames++;
+
+    if (hostFrameHook) {
+        hostFrameHook();
+    }
+
+    if ((enabled & IRQ_VBLANK) && vblankHandler) {
+        vblankHandler();
+    }
+}
+
+uint32_t hostFrames(void)
+{
+    return frames;
+}
@@ -0,0 +1,11 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef GBA_SYSTEMCALLS_SHIM_H__
+#define GBA_SYSTEMCALLS_SHIM_H__
+
+// Ends the frame: hands it to the host (see hostshim.h), then runs the
+// VBlank interrupt handler.
+void VBlankIntrWait(void);
+
+#endif
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef GBA_TIMERS_SHIM_H__
+#define GBA_TIMERS_SHIM_H__
+
+#include <stdint.h>
+
+// nothing runs timer 1 on the host, the mixer interrupt never comes
+extern volatile uint16_t hostTimer1;
+#define REG_TM1CNT_L hostTimer1
+
+#endif
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef HOSTSHIM_H__
+#define HOSTSHIM_H__
+
+#include <stdint.h>
+
+// What a host program needs to run the game: main.c is built with
+// -Dmain=gameMain and every VBlankIntrWait hands the finished frame to
+// hostFrameHook, which can look at hostScreen, set hostKeys for the next
+// frame or longjmp out to stop the game.
+
+#include "gba_input.h"
+#include "tonc.h"
+
+int gameMain(void);
+
+extern void (*hostFrameHook)(void);
+
+// frames finished so far
+uint32_t hostFrames(void);
+
+// What the GBA would show for the current REG_DISPCNT, VRAM and OAM, composed
+// on every call. SCREEN_WIDTH x SCREEN_HEIGHT BGR555 pixels.
+const u16 *hostScreen(void);
+
+#endif
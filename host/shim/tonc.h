@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef TONC_SHIM_H__
+#define TONC_SHIM_H__
+
+// Just the parts of libtonc the game uses, on top of a framebuffer in host
+// memory. Struct layouts and the TTE macros follow libtonc so that
+// tonc_ext.c compiles unchanged.
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile uint16_t vu16;
+typedef volatile uint32_t vu32;
+typedef unsigned int uint;
+
+#define INLINE static inline
+
+INLINE int min(int a, int b) { return a < b ? a : b; }
+INLINE int max(int a, int b) { return a > b ? a : b; }
+
+// --- video ---
+
+#define SCREEN_WIDTH 240
+#define SCREEN_HEIGHT 160
+#define M3_WIDTH SCREEN_WIDTH
+#define M3_HEIGHT SCREEN_HEIGHT
+
+#define DCNT_MODE0 0x0000
+#define DCNT_MODE3 0x0003
+#define DCNT_MODE4 0x0004
+#define DCNT_BG0 0x0100
+#define DCNT_BG1 0x0200
+#define DCNT_BG2 0x0400
+#define DCNT_BG3 0x0800
+#define DCNT_OBJ 0x1000
+#define DCNT_OBJ_1D 0x0040
+
+extern u16 hostDispcnt;
+#define REG_DISPCNT hostDispcnt
+
+// The 96 KB of VRAM, which starts with the mode 3 framebuffer of
+// SCREEN_WIDTH x SCREEN_HEIGHT BGR555 pixels, or the first mode 4 page of
+// palette indices. What is on the screen is composed from it by hostScreen
+// (hostshim.h).
+#define VRAM_SIZE 0x18000
+extern u16 *const hostVram;
+
+// --- tiled backgrounds, regular ones only ---
+
+typedef u16 SCR_ENTRY;
+typedef SCR_ENTRY SCREENBLOCK[1024];
+typedef struct { u32 data[8]; } TILE;
+typedef TILE CHARBLOCK[512];
+typedef struct { s16 x, y; } BG_POINT;
+
+#define tile_mem ((CHARBLOCK *) hostVram)
+#define se_mem ((SCREENBLOCK *) hostVram)
+
+// 256 background colors, then 256 for the sprites
+extern u16 hostPalette[512];
+#define pal_bg_mem hostPalette
+
+extern u16 hostBgcnt[4];
+extern BG_POINT hostBgofs[4];
+#define REG_BGCNT hostBgcnt
+#define REG_BG_OFS hostBgofs
+
+#define BG_PRIO(n) (n)
+#define BG_CBB(n) ((n) << 2)
+#define BG_4BPP 0
+#define BG_8BPP 0x0080
+#define BG_SBB(n) ((n) << 8)
+#define BG_REG_32x32 0
+#define BG_REG_64x32 0x4000
+#define BG_REG_32x64 0x8000
+#define BG_REG_64x64 0xC000
+
+#define SE_ID_MASK 0x03FF
+#define SE_HFLIP 0x0400
+#define SE_VFLIP 0x0800
+#define SE_PALBANK(n) ((n) << 12)
+
+INLINE u16 RGB15(u32 red, u32 green, u32 blue) { return red | green << 5 | blue << 10; }
+
+// --- sprites, regular 4bpp ones only, and alpha blending ---
+
+typedef struct OBJ_ATTR {
+    u16 attr0;
+    u16 attr1;
+    u16 attr2;
+    s16 fill;
+} OBJ_ATTR;
+
+extern OBJ_ATTR hostOam[128];
+#define oam_mem hostOam
+#define pal_obj_mem (hostPalette + 256)
+
+#define ATTR0_Y(n) ((n) & 0xFF)
+#define ATTR0_REG 0
+#define ATTR0_HIDE 0x0200
+#define ATTR0_BLEND 0x0400
+#define ATTR0_4BPP 0
+#define ATTR0_SQUARE 0
+#define ATTR0_WIDE 0x4000
+#define ATTR0_TALL 0x8000
+
+#define ATTR1_X(n) ((n) & 0x01FF)
+#define ATTR1_HFLIP 0x1000
+#define ATTR1_VFLIP 0x2000
+#define ATTR1_SIZE_8 0
+#define ATTR1_SIZE_16 0x4000
+#define ATTR1_SIZE_32 0x8000
+#define ATTR1_SIZE_64 0xC000
+
+#define ATTR2_ID(n) ((n) & 0x03FF)
+#define ATTR2_PRIO(n) ((n) << 10)
+#define ATTR2_PALBANK(n) ((n) << 12)
+
+INLINE OBJ_ATTR *obj_set_attr(OBJ_ATTR *obj, u16 a0, u16 a1, u16 a2)
+{
+    obj->attr0 = a0;
+    obj->attr1 = a1;
+    obj->attr2 = a2;
+    return obj;
+}
+
+// hides them all
+void oam_init(OBJ_ATTR *obj, uint count);
+void oam_copy(OBJ_ATTR *dst, const OBJ_ATTR *src, uint count);
+
+extern u16 hostBldcnt;
+extern u16 hostBldalpha;
+#define REG_BLDCNT hostBldcnt
+#define REG_BLDALPHA hostBldalpha
+
+#define BLD_BG0 0x0001
+#define BLD_BG1 0x0002
+#define BLD_BG2 0x0004
+#define BLD_BG3 0x0008
+#define BLD_OBJ 0x0010
+#define BLD_BACKDROP 0x0020
+#define BLD_STD 0x0040
+#define BLD_BOT(n) ((n) << 8)
+#define BLDA_BUILD(eva, evb) (((eva) & 31) | ((evb) & 31) << 8)
+
+#define CLR_BLACK 0x0000
+#define CLR_RED 0x001F
+#define CLR_LIME 0x03E0
+#define CLR_YELLOW 0x03FF
+#define CLR_BLUE 0x7C00
+#define CLR_MAG 0x7C1F
+#define CLR_CYAN 0x7FE0
+#define CLR_WHITE 0x7FFF
+#define CLR_GREEN 0x0200
+#define CLR_PURPLE 0x4010
+#define CLR_ORANGE 0x021F
+#define CLR_GRAY 0x4210
+#define CLR_FUCHSIA 0x7C1F
+#define CLR_CREAM 0x7BFF
+
+typedef struct TSurface {
+    u8 *data;
+    u32 pitch;
+    u16 width;
+    u16 height;
+    u8 bpp;
+    u8 type;
+    u16 palSize;
+    u16 *palData;
+} TSurface;
+
+void sbmp16_rect(const TSurface *dst, int left, int top, int right, int bottom, u32 clr);
+void sbmp8_rect(const TSurface *dst, int left, int top, int right, int bottom, u32 clr);
+void sbmp16_blit(const TSurface *dst, int dstX, int dstY, uint width, uint height,
+    const TSurface *src, int srcX, int srcY);
+
+// --- text ---
+
+typedef struct TFont {
+    const void *data;
+    const u8 *widths;
+    const u8 *heights;
+    u16 charOffset;
+    u16 charCount;
+    u8 charW;
+    u8 charH;
+    u8 cellW;
+    u8 cellH;
+    u16 cellSize;
+    u8 bpp;
+    u8 extra;
+} TFont;
+
+typedef void (*fnDrawg)(uint gid);
+typedef void (*fnErase)(int left, int top, int right, int bottom);
+
+typedef struct TTC {
+    TSurface dst;
+    s16 cursorX;
+    s16 cursorY;
+    TFont *font;
+    u8 *charLut;
+    u16 cattr[4];
+    u16 flags0;
+    u16 ctrl;
+    u16 marginLeft;
+    u16 marginTop;
+    u16 marginRight;
+    u16 marginBottom;
+    s16 savedX;
+    s16 savedY;
+    fnDrawg drawgProc;
+    fnErase eraseProc;
+} TTC;
+
+enum { TTE_INK = 0, TTE_SHADOW, TTE_PAPER, TTE_SPECIAL };
+
+#define TTE_TAB_WIDTH 24
+
+#define TTE_BASE_VARS(tc, font) \
+    TTC *tc = tte_get_context(); \
+    TFont *font = tc->font
+
+#define TTE_CHAR_VARS(font, gid, _type, _srcD, _srcL, _charW, _charH) \
+    _type *_srcD = (_type *) ((const u8 *) font->data + (gid) * font->cellSize), *_srcL = _srcD; \
+    uint _charW = font->widths ? font->widths[gid] : font->charW; \
+    uint _charH = font->heights ? font->heights[gid] : font->charH
+
+// _dstP is the pitch in bytes. It's signed here, unlike in tonc: the upside
+// down drawer indexes with negative ints minus the pitch, which only wraps
+// around right with 32 bit pointers.
+#define TTE_DST_VARS(tc, _type, _dstD, _dstL, _dstP, _x0, _y0) \
+    uint _x0 = tc->cursorX, _y0 = tc->cursorY; \
+    int _dstP = tc->dst.pitch; \
+    _type *_dstD = (_type *) (tc->dst.data + _y0 * _dstP), *_dstL
+
+// 8x8 1bpp, characters 32 to 127
+extern const TFont sys8Font;
+
+void tte_init_bmp(int vmode, const TFont *font, fnDrawg proc);
+TTC *tte_get_context(void);
+TSurface *tte_get_surface(void);
+void tte_set_pos(int x, int y);
+void tte_set_color(int type, u16 clr);
+int tte_get_glyph_width(uint gid);
+int tte_get_glyph_height(uint gid);
+int tte_write(const char *text);
+// Runs the commands of a #{...} block, str points after the '{'. Returns the
+// position after the closing '}'.
+char *tte_cmd_default(const char *str);
+void tte_erase_rect(int left, int top, int right, int bottom);
+void tte_erase_screen(void);
+
+// --- memory ---
+
+void memset16(void *dst, u32 hw, uint hwcount);
+void memset32(void *dst, u32 wd, uint wdcount);
+void memcpy32(void *dst, const void *src, uint wdcount);
+
+// --- BIOS ---
+
+void LZ77UnCompWram(const void *src, void *dst);
+void RLUnCompWram(const void *src, void *dst);
+// the same, the BIOS writes VRAM 16 bits at a time
+void LZ77UnCompVram(const void *src, void *dst);
+void RLUnCompVram(const void *src, void *dst);
+
+#endif
@@ -0,0 +1,723 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostshim.h"
+#include "tonc.h"
+
+// A glyph row of slack above the screen, the upside down text drawer in
+// tonc_ext.c writes a little outside of it near the edges. Below the screen
+// that just lands in the rest of VRAM, like on the GBA.
+#define VRAM_GUARD (8 * SCREEN_WIDTH)
+
+static u16 vram[VRAM_GUARD + VRAM_SIZE / 2];
+static u16 screen[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+u16 hostDispcnt = 0;
+u16 *const hostVram = vram + VRAM_GUARD;
+u16 hostPalette[512];
+u16 hostBgcnt[4];
+BG_POINT hostBgofs[4];
+OBJ_ATTR hostOam[128];
+u16 hostBldcnt;
+u16 hostBldalpha;
+
+// font8x8_basic (public domain), one byte per row, LSB is the leftmost
+// pixel, like the b1cts glyphs of libtonc's sys8 font.
+static const u8 sys8Glyphs[96 * 8] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // ' '
+    0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00, // '!'
+    0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // '"'
+    0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00, // '#'
+    0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00, // '$'
+    0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00, // '%'
+    0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00, // '&'
+    0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, // '''
+    0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00, // '('
+    0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00, // ')'
+    0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00, // '*'
+    0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00, // '+'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06, // ','
+    0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, // '-'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, // '.'
+    0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00, // '/'
+    0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00, // '0'
+    0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00, // '1'
+    0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00, // '2'
+    0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00, // '3'
+    0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00, // '4'
+    0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00, // '5'
+    0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00, // '6'
+    0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00, // '7'
+    0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00, // '8'
+    0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00, // '9'
+    0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00, // ':'
+    0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06, // ';'
+    0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00, // '<'
+    0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00, // '='
+    0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00, // '>'
+    0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00, // '?'
+    0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00, // '@'
+    0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00, // 'A'
+    0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00, // 'B'
+    0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00, // 'C'
+    0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00, // 'D'
+    0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00, // 'E'
+    0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00, // 'F'
+    0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00, // 'G'
+    0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00, // 'H'
+    0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00, // 'I'
+    0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00, // 'J'
+    0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00, // 'K'
+    0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00, // 'L'
+    0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00, // 'M'
+    0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00, // 'N'
+    0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00, // 'O'
+    0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00, // 'P'
+    0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00, // 'Q'
+    0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00, // 'R'
+    0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00, // 'S'
+    0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00, // 'T'
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00, // 'U'
+    0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00, // 'V'
+    0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00, // 'W'
+    0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00, // 'X'
+    0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00, // 'Y'
+    0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00, // 'Z'
+    0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00, // '['
+    0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00, // '\'
+    0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00, // ']'
+    0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00, // '^'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, // '_'
+    0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, // '`'
+    0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00, // 'a'
+    0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00, // 'b'
+    0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00, // 'c'
+    0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00, // 'd'
+    0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00, // 'e'
+    0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00, // 'f'
+    0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F, // 'g'
+    0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00, // 'h'
+    0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00, // 'i'
+    0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, // 'j'
+    0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00, // 'k'
+    0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00, // 'l'
+    0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00, // 'm'
+    0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00, // 'n'
+    0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00, // 'o'
+    0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F, // 'p'
+    0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78, // 'q'
+    0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00, // 'r'
+    0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00, // 's'
+    0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00, // 't'
+    0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00, // 'u'
+    0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00, // 'v'
+    0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00, // 'w'
+    0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00, // 'x'
+    0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F, // 'y'
+    0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00, // 'z'
+    0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00, // '{'
+    0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, // '|'
+    0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00, // '}'
+    0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // '~'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+const TFont sys8Font = {
+    sys8Glyphs, NULL, NULL, 32, 96, 8, 8, 8, 8, 8, 1, 0,
+};
+
+static TTC context;
+
+// the rectangle sorted and clipped to the surface
+static void clipRect(const TSurface *dst, int *left, int *top, int *right, int *bottom)
+{
+    if (*right < *left) {
+        int tmp = *left;
+        *left = *right;
+        *right = tmp;
+    }
+    if (*bottom < *top) {
+        int tmp = *top;
+        *top = *bottom;
+        *bottom = tmp;
+    }
+
+    *left = max(*left, 0);
+    *top = max(*top, 0);
+    *right = min(*right, dst->width);
+    *bottom = min(*bottom, dst->height);
+}
+
+void sbmp16_rect(const TSurface *dst, int left, int top, int right, int bottom, u32 clr)
+{
+    clipRect(dst, &left, &top, &right, &bottom);
+
+    for (int y = top; y < bottom; y++) {
+        u16 *line = (u16 *) (dst->data + y * dst->pitch);
+
+        for (int x = left; x < right; x++) {
+            line[x] = clr;
+        }
+    }
+}
+
+void sbmp8_rect(const TSurface *dst, int left, int top, int right, int bottom, u32 clr)
+{
+    clipRect(dst, &left, &top, &right, &bottom);
+
+    for (int y = top; y < bottom; y++) {
+        memset(dst->data + y * dst->pitch + left, clr, right - left > 0 ? right - left : 0);
+    }
+}
+
+void sbmp16_blit(const TSurface *dst, int dstX, int dstY, uint width, uint height,
+    const TSurface *src, int srcX, int srcY)
+{
+    int w = width, h = height;
+
+    // clipped against both surfaces, like tonc
+    if (dstX < 0) {
+        w += dstX;
+        srcX -= dstX;
+        dstX = 0;
+    }
+    if (srcX < 0) {
+        w += srcX;
+        dstX -= srcX;
+        srcX = 0;
+    }
+    if (dstY < 0) {
+        h += dstY;
+        srcY -= dstY;
+        dstY = 0;
+    }
+    if (srcY < 0) {
+        h += srcY;
+        dstY -= srcY;
+        srcY = 0;
+    }
+    w = min(w, min(dst->width - dstX, src->width - srcX));
+    h = min(h, min(dst->height - dstY, src->height - srcY));
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    for (int y = 0; y < h; y++) {
+        memcpy(dst->data + (dstY + y) * dst->pitch + dstX * 2,
+               src->data + (srcY + y) * src->pitch + srcX * 2, w * 2);
+    }
+}
+
+static void bmp16_drawg_b1cts(uint gid)
+{
+    TTE_BASE_VARS(tc, font);
+    TTE_CHAR_VARS(font, gid, const u8, srcD, srcL, charW, charH);
+    TTE_DST_VARS(tc, u16, dstD, dstL, dstP, x0, y0);
+    uint srcP = font->cellH;
+    u32 ink = tc->cattr[TTE_INK], raw;
+
+    (void) srcD;
+    dstD += x0;
+
+    for (uint iw = 0; iw < charW; iw += 8) {
+        dstL = &dstD[iw];
+        for (uint iy = 0; iy < charH; iy++) {
+            raw = srcL[iy];
+            for (int ix = 0; raw > 0; raw >>= 1, ix++) {
+                if (raw & 1) {
+                    dstL[ix] = ink;
+                }
+            }
+            dstL += dstP / 2;
+        }
+        srcL += srcP;
+    }
+}
+
+// host memory takes byte writes, unlike VRAM
+static void bmp8_drawg_b1cts(uint gid)
+{
+    TTE_BASE_VARS(tc, font);
+    TTE_CHAR_VARS(font, gid, const u8, srcD, srcL, charW, charH);
+    TTE_DST_VARS(tc, u8, dstD, dstL, dstP, x0, y0);
+    uint srcP = font->cellH;
+    u32 ink = tc->cattr[TTE_INK], raw;
+
+    (void) srcD;
+    dstD += x0;
+
+    for (uint iw = 0; iw < charW; iw += 8) {
+        dstL = &dstD[iw];
+        for (uint iy = 0; iy < charH; iy++) {
+            raw = srcL[iy];
+            for (int ix = 0; raw > 0; raw >>= 1, ix++) {
+                if (raw & 1) {
+                    dstL[ix] = ink;
+                }
+            }
+            dstL += dstP;
+        }
+        srcL += srcP;
+    }
+}
+
+static void bmp16_erase(int left, int top, int right, int bottom)
+{
+    sbmp16_rect(&context.dst, left, top, right, bottom, context.cattr[TTE_PAPER]);
+}
+
+static void bmp8_erase(int left, int top, int right, int bottom)
+{
+    sbmp8_rect(&context.dst, left, top, right, bottom, context.cattr[TTE_PAPER]);
+}
+
+// mode 3, or mode 4 on its first page with palette indices for colors
+void tte_init_bmp(int vmode, const TFont *font, fnDrawg proc)
+{
+    memset(&context, 0, sizeof(context));
+
+    context.dst.data = (u8 *) hostVram;
+    context.dst.width = SCREEN_WIDTH;
+    context.dst.height = SCREEN_HEIGHT;
+    context.font = (TFont *) font;
+
+    if (vmode == 4) {
+        context.dst.pitch = SCREEN_WIDTH;
+        context.dst.bpp = 8;
+        context.drawgProc = proc ? proc : bmp8_drawg_b1cts;
+        context.eraseProc = bmp8_erase;
+        context.cattr[TTE_INK] = 1;
+        context.cattr[TTE_SHADOW] = 2;
+        context.cattr[TTE_PAPER] = 0;
+    } else {
+        context.dst.pitch = SCREEN_WIDTH * 2;
+        context.dst.bpp = 16;
+        context.drawgProc = proc ? proc : bmp16_drawg_b1cts;
+        context.eraseProc = bmp16_erase;
+        context.cattr[TTE_INK] = CLR_YELLOW;
+        context.cattr[TTE_SHADOW] = CLR_ORANGE;
+        context.cattr[TTE_PAPER] = CLR_BLACK;
+    }
+
+    context.marginRight = SCREEN_WIDTH;
+    context.marginBottom = SCREEN_HEIGHT;
+}
+
+TTC *tte_get_context(void)
+{
+    return &context;
+}
+
+TSurface *tte_get_surface(void)
+{
+    return &context.dst;
+}
+
+void tte_set_pos(int x, int y)
+{
+    context.cursorX = x;
+    context.cursorY = y;
+}
+
+void tte_set_color(int type, u16 clr)
+{
+    context.cattr[type] = clr;
+}
+
+int tte_get_glyph_width(uint gid)
+{
+    return context.font->widths ? context.font->widths[gid] : context.font->charW;
+}
+
+int tte_get_glyph_height(uint gid)
+{
+    return context.font->heights ? context.font->heights[gid] : context.font->charH;
+}
+
+void tte_erase_rect(int left, int top, int right, int bottom)
+{
+    context.eraseProc(left, top, right, bottom);
+}
+
+void tte_erase_screen(void)
+{
+    context.eraseProc(context.marginLeft, context.marginTop, context.marginRight, context.marginBottom);
+}
+
+// the commands the game uses: P, P:x,y, X:x, Y:y, ci:, cs:, cp:, es
+char *tte_cmd_default(const char *str)
+{
+    while (*str && *str != '}') {
+        const char *arg = NULL;
+        char *end;
+
+        if (str[0] == 'e' && str[1] == 's') {
+            tte_erase_screen();
+            str += 2;
+        } else if (str[0] == 'c' && str[1] && str[2] == ':') {
+            int type = str[1] == 'i' ? TTE_INK : str[1] == 's' ? TTE_SHADOW : str[1] == 'p' ? TTE_PAPER : TTE_SPECIAL;
+
+            context.cattr[type] = strtol(str + 3, &end, 0);
+            str = end;
+        } else if (str[0] == 'P') {
+            if (str[1] == ':') {
+                context.cursorX = context.marginLeft + strtol(str + 2, &end, 0);
+                context.cursorY = context.marginTop + (*end == ',' ? strtol(end + 1, &end, 0) : 0);
+                str = end;
+            } else {
+                context.cursorX = context.marginLeft;
+                context.cursorY = context.marginTop;
+                str++;
+            }
+        } else if ((str[0] == 'X' || str[0] == 'Y') && str[1] == ':') {
+            arg = str + 2;
+            if (str[0] == 'X') {
+                context.cursorX = context.marginLeft + strtol(arg, &end, 0);
+            } else {
+                context.cursorY = context.marginTop + strtol(arg, &end, 0);
+            }
+            str = end;
+        }
+
+        // skip whatever is left of this command
+        while (*str && *str != ';' && *str != '}') {
+            str++;
+        }
+        if (*str == ';') {
+            str++;
+        }
+    }
+
+    return (char *) (*str == '}' ? str + 1 : str);
+}
+
+uint utf8_decode_char(const char *ptr, char **endptr)
+{
+    const u8 *src = (const u8 *) ptr;
+    uint ch = *src++;
+
+    if (ch >= 0xf0) {
+        ch = (ch & 0x07) << 18 | (src[0] & 0x3f) << 12 | (src[1] & 0x3f) << 6 | (src[2] & 0x3f);
+        src += 3;
+    } else if (ch >= 0xe0) {
+        ch = (ch & 0x0f) << 12 | (src[0] & 0x3f) << 6 | (src[1] & 0x3f);
+        src += 2;
+    } else if (ch >= 0xc0) {
+        ch = (ch & 0x1f) << 6 | (src[0] & 0x3f);
+        src += 1;
+    }
+
+    if (endptr) {
+        *endptr = (char *) src;
+    }
+
+    return ch;
+}
+
+int tte_write(const char *text)
+{
+    const char *str = text;
+    uint ch;
+
+    if (text == NULL) {
+        return 0;
+    }
+
+    while ((ch = (u8) *str) != '\0') {
+        str++;
+
+        if (ch == '\n') {
+            context.cursorY += context.font->charH;
+            context.cursorX = context.marginLeft;
+        } else if (ch == '#' && str[0] == '{') {
+            str = tte_cmd_default(str + 1);
+        } else {
+            if (ch == '\\' && str[0] == '#') {
+                ch = (u8) *str++;
+            } else if (ch >= 0x80) {
+                ch = utf8_decode_char(str - 1, (char **) &str);
+            }
+
+            uint gid = ch - context.font->charOffset;
+            if (gid >= context.font->charCount) {
+                continue;
+            }
+
+            int charW = tte_get_glyph_width(gid);
+            if (context.cursorX + charW > context.marginRight) {
+                context.cursorY += context.font->charH;
+                context.cursorX = context.marginLeft;
+            }
+
+            // keeping the text on the screen is up to the caller
+            if (context.cursorY >= 0 && context.cursorY + context.font->charH <= context.dst.height) {
+                context.drawgProc(gid);
+            }
+            context.cursorX += charW;
+        }
+    }
+
+    return str - text;
+}
+
+// The BIOS formats: a type byte, a 24 bit unpacked size, then the data.
+void LZ77UnCompWram(const void *src, void *dst)
+{
+    const u8 *in = src;
+    u8 *out = dst;
+    u32 size = in[1] | in[2] << 8 | in[3] << 16;
+    u32 pos = 0;
+
+    in += 4;
+
+    while (pos < size) {
+        u8 flags = *in++;
+
+        for (int i = 0; i < 8 && pos < size; i++, flags <<= 1) {
+            if (flags & 0x80) {
+                int length = (in[0] >> 4) + 3;
+                u32 disp = ((in[0] & 0xf) << 8 | in[1]) + 1;
+
+                in += 2;
+                while (length-- && pos < size) {
+                    out[pos] = out[pos - disp];
+                    pos++;
+                }
+            } else {
+                out[pos++] = *in++;
+            }
+        }
+    }
+}
+
+void RLUnCompWram(const void *src, void *dst)
+{
+    const u8 *in = src;
+    u8 *out = dst;
+    u32 size = in[1] | in[2] << 8 | in[3] << 16;
+    u32 pos = 0;
+
+    in += 4;
+
+    while (pos < size) {
+        u8 flag = *in++;
+
+        if (flag & 0x80) {
+            int length = (flag & 0x7f) + 3;
+            u8 value = *in++;
+
+            while (length-- && pos < size) {
+                out[pos++] = value;
+            }
+        } else {
+            int length = (flag & 0x7f) + 1;
+
+            while (length-- && pos < size) {
+                out[pos++] = *in++;
+            }
+        }
+    }
+}
+
+void LZ77UnCompVram(const void *src, void *dst)
+{
+    LZ77UnCompWram(src, dst);
+}
+
+void RLUnCompVram(const void *src, void *dst)
+{
+    RLUnCompWram(src, dst);
+}
+
+void memset16(void *dst, u32 hw, uint hwcount)
+{
+    u16 *d = dst;
+
+    while (hwcount--) {
+        *d++ = hw;
+    }
+}
+
+void memset32(void *dst, u32 wd, uint wdcount)
+{
+    u32 *d = dst;
+
+    while (wdcount--) {
+        *d++ = wd;
+    }
+}
+
+void memcpy32(void *dst, const void *src, uint wdcount)
+{
+    memcpy(dst, src, wdcount * 4);
+}
+
+// The palette index of pixel x, y of a regular background, 0 is transparent.
+static int bgPixel(int bg, int x, int y, int *bank)
+{
+    u16 cnt = hostBgcnt[bg];
+    int wide = cnt & BG_REG_64x32 ? 512 : 256;
+    int tall = cnt & BG_REG_32x64 ? 512 : 256;
+    int sx = (x + hostBgofs[bg].x) & (wide - 1);
+    int sy = (y + hostBgofs[bg].y) & (tall - 1);
+    // the screenblocks of a large map are 32x32 each, left to right, then down
+    int block = (sx / 256) + (sy / 256) * (wide / 256);
+    SCR_ENTRY se = se_mem[((cnt >> 8) & 31) + block][(sy / 8 % 32) * 32 + sx / 8 % 32];
+    int tx = se & SE_HFLIP ? 7 - sx % 8 : sx % 8;
+    int ty = se & SE_VFLIP ? 7 - sy % 8 : sy % 8;
+    const u8 *base = (const u8 *) tile_mem[(cnt >> 2) & 3];
+
+    *bank = se >> 12;
+    if (cnt & BG_8BPP) {
+        *bank = 0;
+        return base[(se & SE_ID_MASK) * 64 + ty * 8 + tx];
+    }
+
+    return (base[(se & SE_ID_MASK) * 32 + ty * 4 + tx / 2] >> (tx & 1) * 4) & 0xf;
+}
+
+static void composeTiled(void)
+{
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            u16 color = hostPalette[0];
+            int done = 0;
+
+            for (int prio = 0; prio < 4 && !done; prio++) {
+                for (int bg = 0; bg < 4 && !done; bg++) {
+                    int bank, index;
+
+                    if (!(hostDispcnt & (DCNT_BG0 << bg)) || (hostBgcnt[bg] & 3) != prio) {
+                        continue;
+                    }
+
+                    index = bgPixel(bg, x, y, &bank);
+                    if (index) {
+                        color = hostPalette[bank * 16 + index];
+                        done = 1;
+                    }
+                }
+            }
+
+            screen[y * SCREEN_WIDTH + x] = color;
+        }
+    }
+}
+
+void oam_init(OBJ_ATTR *obj, uint count)
+{
+    memset(obj, 0, count * sizeof(*obj));
+    for (uint i = 0; i < count; i++) {
+        obj[i].attr0 = ATTR0_HIDE;
+    }
+}
+
+void oam_copy(OBJ_ATTR *dst, const OBJ_ATTR *src, uint count)
+{
+    memcpy(dst, src, count * sizeof(*dst));
+}
+
+static u16 blend(u16 top, u16 bottom, int eva, int evb)
+{
+    u16 color = 0;
+
+    eva = min(eva, 16);
+    evb = min(evb, 16);
+    for (int shift = 0; shift < 15; shift += 5) {
+        int c = (((top >> shift) & 31) * eva + ((bottom >> shift) & 31) * evb) / 16;
+
+        color |= min(c, 31) << shift;
+    }
+
+    return color;
+}
+
+// widths and heights in pixels by shape and size
+static const u8 objWidths[3][4] = { { 8, 16, 32, 64 }, { 16, 32, 32, 64 }, { 8, 8, 16, 32 } };
+static const u8 objHeights[3][4] = { { 8, 16, 32, 64 }, { 8, 8, 16, 32 }, { 16, 32, 32, 64 } };
+
+// The regular sprites on top of the backgrounds, the first one in OAM
+// topmost, semi-transparent ones blended with what's under them.
+static void composeSprites(void)
+{
+    const u8 *base = (const u8 *) tile_mem[4];
+    int bitmap = (hostDispcnt & 7) >= 3;
+
+    for (int i = 127; i >= 0; i--) {
+        const OBJ_ATTR *obj = &hostOam[i];
+        int shape = obj->attr0 >> 14, size = obj->attr1 >> 14;
+        int w, h, x, y, tile;
+
+        if ((obj->attr0 & 0x0300) != 0 || shape == 3) {
+            continue;
+        }
+
+        w = objWidths[shape][size];
+        h = objHeights[shape][size];
+        x = obj->attr1 & 0x1FF;
+        y = obj->attr0 & 0xFF;
+        x = x >= SCREEN_WIDTH ? x - 512 : x;
+        y = y >= SCREEN_HEIGHT ? y - 256 : y;
+        tile = obj->attr2 & 0x3FF;
+        // the bitmap takes the first half of the sprite tiles
+        if (bitmap && tile < 512) {
+            continue;
+        }
+
+        for (int py = 0; py < h; py++) {
+            for (int px = 0; px < w; px++) {
+                int sx = x + px, sy = y + py;
+                int tx = obj->attr1 & ATTR1_HFLIP ? w - 1 - px : px;
+                int ty = obj->attr1 & ATTR1_VFLIP ? h - 1 - py : py;
+                int id, index;
+                u16 *dst, color;
+
+                if (sx < 0 || sx >= SCREEN_WIDTH || sy < 0 || sy >= SCREEN_HEIGHT) {
+                    continue;
+                }
+
+                id = tile + (hostDispcnt & DCNT_OBJ_1D ? (ty / 8) * (w / 8) : (ty / 8) * 32) + tx / 8;
+                index = (base[(id & 0x3FF) * 32 + (ty % 8) * 4 + (tx % 8) / 2] >> (tx & 1) * 4) & 0xf;
+                if (!index) {
+                    continue;
+                }
+
+                dst = &screen[sy * SCREEN_WIDTH + sx];
+                color = pal_obj_mem[(obj->attr2 >> 12) * 16 + index];
+                // blended with whatever is under it, which layer that is doesn't matter here
+                if ((obj->attr0 & 0x0C00) == ATTR0_BLEND && (hostBldcnt & BLD_BOT(0x3F))) {
+                    color = blend(color, *dst, hostBldalpha & 31, (hostBldalpha >> 8) & 31);
+                }
+                *dst = color;
+            }
+        }
+    }
+}
+
+const u16 *hostScreen(void)
+{
+    switch (hostDispcnt & 7) {
+        case DCNT_MODE0:
+            composeTiled();
+            break;
+        case DCNT_MODE3:
+            memcpy(screen, hostVram, sizeof(screen));
+            break;
+        case DCNT_MODE4:
+            for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+                screen[i] = hostPalette[((const u8 *) hostVram)[i]];
+            }
+            break;
+        default:
+            memset(screen, 0, sizeof(screen));
+    }
+
+    if (hostDispcnt & DCNT_OBJ) {
+        composeSprites();
+    }
+
+    return screen;
+}
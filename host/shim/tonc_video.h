@@ -0,0 +1,5 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+// everything is in the tonc.h shim
+#include "tonc.h"
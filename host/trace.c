@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+void traceInit(struct Trace *trace)
+{
+    memset(trace, 0, sizeof(*trace));
+}
+
+void traceFree(struct Trace *trace)
+{
+    free(trace->events);
+    traceInit(trace);
+}
+
+int traceAdd(struct Trace *trace, uint32_t frame, uint16_t down, uint16_t up)
+{
+    if (frame == 0 || (trace->count > 0 && frame <= trace->events[trace->count - 1].frame)) {
+        return -1;
+    }
+
+    if ((down & trace->held) || (up & ~trace->held) || (down & up)) {
+        return -1;
+    }
+
+    if (trace->count == trace->size) {
+        trace->size = trace->size ? trace->size * 2 : 256;
+        trace->events = realloc(trace->events, trace->size * sizeof(*trace->events));
+        if (!trace->events) {
+            fprintf(stderr, "trace: out of memory\n");
+            exit(1);
+        }
+    }
+
+    trace->events[trace->count].frame = frame;
+    trace->events[trace->count].down = down;
+    trace->events[trace->count].up = up;
+    trace->count++;
+    trace->held = (trace->held | down) & ~up;
+
+    return 0;
+}
+
+int traceRead(struct Trace *trace, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+    int lineNo = 0;
+
+    if (!f) {
+        fprintf(stderr, "trace: can't read %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        unsigned int frame, down, up;
+        char *p = strstr(line, "input: ");
+
+        lineNo++;
+
+        if (sscanf(line, "# frames %u", &frame) == 1) {
+            trace->frames = frame;
+            continue;
+        }
+
+        if (!p || sscanf(p + 7, "%u %x %x", &frame, &down, &up) != 3) {
+            continue;
+        }
+
+        if (traceAdd(trace, frame, down, up)) {
+            fprintf(stderr, "trace: %s:%d: frame %u with keys %04x/%04x doesn't follow frame %u with %04x held\n",
+                    path, lineNo, frame, down, up, (unsigned int) traceLastFrame(trace), trace->held);
+            fclose(f);
+            return -1;
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
+
+void traceWrite(const struct Trace *trace, FILE *f)
+{
+    for (size_t i = 0; i < trace->count; i++) {
+        fprintf(f, "input: %u %04x %04x\n", (unsigned int) trace->events[i].frame,
+                trace->events[i].down, trace->events[i].up);
+    }
+}
+
+uint32_t traceLastFrame(const struct Trace *trace)
+{
+    return trace->count ? trace->events[trace->count - 1].frame : 0;
+}
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef TRACE_H__
+#define TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// The button changes of a session, as source/input.c logs them:
+//   input: <frame> <keysDown> <keysUp>
+// Frames count from 1, every frame appears at most once and in order and the
+// keys have to make sense, nothing pressed that's held already and nothing
+// released that isn't held. A "# frames <n>" line says how long the session
+// goes on, for traces that end with a lot of nothing.
+
+struct TraceEvent {
+    uint32_t frame;
+    uint16_t down;
+    uint16_t up;
+};
+
+struct Trace {
+    struct TraceEvent *events;
+    size_t count;
+    size_t size;
+    // the keys held after the last event
+    uint16_t held;
+    // from "# frames", 0 if there was none
+    uint32_t frames;
+};
+
+void traceInit(struct Trace *trace);
+void traceFree(struct Trace *trace);
+// -1 if the event doesn't follow the rules above
+int traceAdd(struct Trace *trace, uint32_t frame, uint16_t down, uint16_t up);
+// Reads the input: lines of a log, the rest of it is skipped. 0 on success.
+int traceRead(struct Trace *trace, const char *path);
+void traceWrite(const struct Trace *trace, FILE *f);
+uint32_t traceLastFrame(const struct Trace *trace);
+
+#endif
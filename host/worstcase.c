@@ -0,0 +1,624 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Searches for input that makes single frames expensive, like a full redraw
+ * landing on the same frame as an autosave. It starts with random button
+ * sessions and then mutates the worst ones found so far, mostly around their
+ * worst frame. Every candidate runs from boot in a forked copy of the game,
+ * a few times to get the noise out of the measurements, and the cost of a
+ * frame is:
+ * - work: the time the game took for it, in profile cycles (host time scaled
+ *   to the GBA clock), or instructions if perf can count them
+ * - stall: the time the flash simulator was busy, in cycles of the GBA,
+ *   which is what an autosave costs on hardware
+ * The worst candidates are written as traces replay can play (worstN.log),
+ * with the frame and its cost in a comment at the top.
+ */
+
+#include <linux/perf_event.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "flashsim.h"
+#include "hostshim.h"
+#include "profile.h"
+#include "render.h"
+#include "trace.h"
+
+#define MAX_PRESSES 512
+#define MAX_KEEP 16
+
+// frames around the worst one that mutations prefer
+#define GUIDE_WINDOW 60
+
+enum COST {
+    COST_WORK = 0,
+    COST_STALL,
+    COST_TOTAL,
+};
+
+struct Press {
+    uint32_t frame;
+    uint16_t key;
+    uint16_t length;
+};
+
+struct Candidate {
+    struct Press presses[MAX_PRESSES];
+    int count;
+    // filled in by evaluate
+    uint32_t worstFrame;
+    uint32_t work;
+    uint32_t stall;
+    uint64_t cost;
+};
+
+struct FrameCost {
+    uint32_t work;
+    uint32_t stall;
+};
+
+// what the buttons are pressed for, weighted: moving around and changing
+// life most, menus now and then
+static const uint16_t keyChoices[] = {
+    KEY_UP, KEY_UP, KEY_UP, KEY_DOWN, KEY_DOWN, KEY_DOWN,
+    KEY_LEFT, KEY_LEFT, KEY_RIGHT, KEY_RIGHT,
+    KEY_A, KEY_A, KEY_A, KEY_B, KEY_L, KEY_R,
+    KEY_START, KEY_SELECT,
+};
+#define KEY_CHOICES (sizeof(keyChoices) / sizeof(keyChoices[0]))
+
+static uint32_t length = 1200;
+static int repeats = 3;
+static int costType = COST_TOTAL;
+
+static int instructionCounter = -1;
+
+// the run in the child
+static jmp_buf stop;
+static const struct Trace *childTrace;
+static size_t nextEvent;
+static struct FrameCost *frameCosts;
+static uint64_t workStart;
+static uint64_t stallStart;
+
+static uint64_t workNow(void)
+{
+    uint64_t count;
+
+    if (instructionCounter >= 0 && read(instructionCounter, &count, sizeof(count)) == sizeof(count)) {
+        return count;
+    }
+
+    return profileCycles();
+}
+
+static uint64_t stallNow(void)
+{
+    return flashSimNow() * PROFILE_CYCLES_PER_SECOND / 1000000000;
+}
+
+static void frame(void)
+{
+    uint64_t work = workNow();
+    uint32_t n = hostFrames();
+
+    // the hook runs at the start of frame n, frame n - 1 is done
+    if (n > 1) {
+        frameCosts[n - 1].work = (uint32_t) (work - workStart);
+        frameCosts[n - 1].stall = (uint32_t) (stallNow() - stallStart);
+    }
+
+    if (n > length) {
+        longjmp(stop, 1);
+    }
+
+    while (nextEvent < childTrace->count && childTrace->events[nextEvent].frame == n) {
+        hostKeys = (hostKeys | childTrace->events[nextEvent].down) & ~childTrace->events[nextEvent].up;
+        nextEvent++;
+    }
+
+    stallStart = stallNow();
+    workStart = workNow();
+}
+
+static void runChild(const struct Trace *trace, int fd)
+{
+    childTrace = trace;
+    nextEvent = 0;
+    frameCosts = calloc(length + 1, sizeof(*frameCosts));
+    if (!frameCosts) {
+        _exit(1);
+    }
+
+    // the debug log of thousands of runs isn't interesting
+    if (!freopen("/dev/null", "w", stderr)) {
+        _exit(1);
+    }
+
+    // like replay, every job runs in the frame it was queued in
+    renderSetBudget(UINT32_MAX);
+
+    hostFrameHook = frame;
+    if (!setjmp(stop)) {
+        gameMain();
+    }
+
+    size_t len = (length + 1) * sizeof(*frameCosts);
+    const uint8_t *p = (const uint8_t *) frameCosts;
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written <= 0) {
+            _exit(1);
+        }
+        p += written;
+        len -= written;
+    }
+
+    _exit(0);
+}
+
+// Runs the trace in a child, the chip contents the parent loaded are what
+// every run starts with. -1 if the child didn't make it.
+static int runOnce(const struct Trace *trace, struct FrameCost *costs)
+{
+    int fds[2];
+    pid_t pid;
+    int status;
+
+    if (pipe(fds)) {
+        perror("worstcase: pipe");
+        exit(1);
+    }
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("worstcase: fork");
+        exit(1);
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        runChild(trace, fds[1]);
+    }
+
+    close(fds[1]);
+
+    size_t len = (length + 1) * sizeof(*costs);
+    uint8_t *p = (uint8_t *) costs;
+    while (len > 0) {
+        ssize_t got = read(fds[0], p, len);
+        if (got <= 0) {
+            break;
+        }
+        p += got;
+        len -= got;
+    }
+    close(fds[0]);
+
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || len > 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int comparePresses(const void *a, const void *b)
+{
+    const struct Press *pa = a, *pb = b;
+
+    return pa->frame < pb->frame ? -1 : pa->frame > pb->frame;
+}
+
+static void addEvent(uint16_t *down, uint16_t *up, uint32_t frame, uint16_t key, int release)
+{
+    if (frame > length) {
+        return;
+    }
+
+    if (release) {
+        up[frame] |= key;
+    } else {
+        down[frame] |= key;
+    }
+}
+
+// Presses of a key that's still held are dropped.
+static void buildTrace(struct Candidate *c, struct Trace *trace)
+{
+    uint16_t *down = calloc(length + 1, sizeof(*down));
+    uint16_t *up = calloc(length + 1, sizeof(*up));
+    uint32_t releasedAt[16] = { 0 };
+
+    if (!down || !up) {
+        fprintf(stderr, "worstcase: out of memory\n");
+        exit(1);
+    }
+
+    qsort(c->presses, c->count, sizeof(c->presses[0]), comparePresses);
+
+    for (int i = 0; i < c->count; i++) {
+        struct Press *p = &c->presses[i];
+        int bit = __builtin_ctz(p->key);
+
+        if (p->frame <= releasedAt[bit]) {
+            continue;
+        }
+
+        addEvent(down, up, p->frame, p->key, 0);
+        addEvent(down, up, p->frame + p->length, p->key, 1);
+        releasedAt[bit] = p->frame + p->length;
+    }
+
+    traceInit(trace);
+    for (uint32_t n = 1; n <= length; n++) {
+        if ((down[n] || up[n]) && traceAdd(trace, n, down[n], up[n])) {
+            fprintf(stderr, "worstcase: made an inconsistent trace at frame %u\n", (unsigned int) n);
+            exit(1);
+        }
+    }
+
+    free(down);
+    free(up);
+}
+
+static uint64_t frameCost(const struct FrameCost *f)
+{
+    switch (costType) {
+        case COST_WORK:
+            return f->work;
+        case COST_STALL:
+            return f->stall;
+        default:
+            return (uint64_t) f->work + f->stall;
+    }
+}
+
+// 0 if the candidate couldn't be run
+static int evaluate(struct Candidate *c)
+{
+    struct FrameCost *best = malloc((length + 1) * sizeof(*best));
+    struct FrameCost *costs = malloc((length + 1) * sizeof(*costs));
+    struct Trace trace;
+
+    if (!best || !costs) {
+        fprintf(stderr, "worstcase: out of memory\n");
+        exit(1);
+    }
+
+    buildTrace(c, &trace);
+
+    // the least of every frame over the runs, the noise only ever adds
+    for (int r = 0; r < repeats; r++) {
+        if (runOnce(&trace, r == 0 ? best : costs)) {
+            traceFree(&trace);
+            free(best);
+            free(costs);
+            return 0;
+        }
+
+        for (uint32_t n = 1; r > 0 && n <= length; n++) {
+            if (costs[n].work < best[n].work) {
+                best[n].work = costs[n].work;
+            }
+        }
+    }
+
+    c->cost = 0;
+    for (uint32_t n = 1; n <= length; n++) {
+        if (frameCost(&best[n]) > c->cost) {
+            c->cost = frameCost(&best[n]);
+            c->worstFrame = n;
+            c->work = best[n].work;
+            c->stall = best[n].stall;
+        }
+    }
+
+    traceFree(&trace);
+    free(best);
+    free(costs);
+    return 1;
+}
+
+static uint32_t randomBelow(uint32_t n)
+{
+    return (uint32_t) (((uint64_t) rand() * n) / ((uint64_t) RAND_MAX + 1));
+}
+
+static void randomPress(struct Press *p, uint32_t from, uint32_t to)
+{
+    p->frame = from + randomBelow(to - from);
+    p->key = keyChoices[randomBelow(KEY_CHOICES)];
+    // mostly taps, sometimes held long enough to repeat
+    p->length = randomBelow(8) == 0 ? 20 + randomBelow(60) : 1 + randomBelow(6);
+}
+
+static void randomCandidate(struct Candidate *c)
+{
+    // a press every 8 frames on average
+    c->count = length / 8 < MAX_PRESSES ? length / 8 : MAX_PRESSES;
+    for (int i = 0; i < c->count; i++) {
+        randomPress(&c->presses[i], 2, length);
+    }
+}
+
+static void mutate(struct Candidate *c)
+{
+    uint32_t from = 2, to = length;
+    int changes = 1 + randomBelow(4);
+
+    // half of the time near the worst frame, that's where it's going on
+    if (randomBelow(2)) {
+        from = c->worstFrame > GUIDE_WINDOW + 2 ? c->worstFrame - GUIDE_WINDOW : 2;
+        to = c->worstFrame + GUIDE_WINDOW < length ? c->worstFrame + GUIDE_WINDOW : length;
+    }
+
+    while (changes--) {
+        int i = c->count ? randomBelow(c->count) : 0;
+
+        switch (randomBelow(5)) {
+            case 0:
+                if (c->count < MAX_PRESSES) {
+                    randomPress(&c->presses[c->count++], from, to);
+                }
+                break;
+            case 1:
+                if (c->count > 0) {
+                    c->presses[i] = c->presses[--c->count];
+                }
+                break;
+            case 2:
+                if (c->count > 0) {
+                    int shift = (int) randomBelow(61) - 30;
+                    int64_t frame = (int64_t) c->presses[i].frame + shift;
+                    c->presses[i].frame = frame < 2 ? 2 : frame >= length ? length - 1 : frame;
+                }
+                break;
+            case 3:
+                if (c->count > 0) {
+                    c->presses[i].key = keyChoices[randomBelow(KEY_CHOICES)];
+                }
+                break;
+            default:
+                if (c->count > 0) {
+                    c->presses[i].length = 1 + randomBelow(c->presses[i].length * 2 + 2);
+                }
+        }
+    }
+}
+
+// Keeps the worst candidates, most expensive first. Mutations that don't
+// move the worst frame are mostly the same case, only the worst of those
+// stays.
+static void keep(struct Candidate *pool, int *pooled, int max, const struct Candidate *c)
+{
+    int at;
+
+    for (int i = 0; i < *pooled; i++) {
+        if (pool[i].worstFrame == c->worstFrame) {
+            if (pool[i].cost >= c->cost) {
+                return;
+            }
+            memmove(&pool[i], &pool[i + 1], (*pooled - i - 1) * sizeof(*pool));
+            (*pooled)--;
+            break;
+        }
+    }
+
+    at = *pooled;
+    while (at > 0 && pool[at - 1].cost < c->cost) {
+        at--;
+    }
+
+    if (at >= max) {
+        return;
+    }
+
+    int last = *pooled < max ? *pooled : max - 1;
+    memmove(&pool[at + 1], &pool[at], (last - at) * sizeof(*pool));
+    pool[at] = *c;
+
+    if (*pooled < max) {
+        (*pooled)++;
+    }
+}
+
+static int writeCase(const char *dir, int index, struct Candidate *c, const char *saveFile)
+{
+    char path[1024];
+    struct Trace trace;
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/worst%d.log", dir, index);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "worstcase: can't write %s\n", path);
+        return -1;
+    }
+
+    buildTrace(c, &trace);
+
+    fprintf(f, "# worstcase: frame %u, work %u, stall %u cycles (%s)\n",
+            (unsigned int) c->worstFrame, (unsigned int) c->work, (unsigned int) c->stall,
+            instructionCounter >= 0 ? "work in instructions" : "work in host time");
+    fprintf(f, "# replay%s%s %s\n", saveFile ? " -s " : "", saveFile ? saveFile : "", path);
+
+    // what comes after the worst frame doesn't matter
+    for (size_t i = 0; i < trace.count && trace.events[i].frame <= c->worstFrame; i++) {
+        fprintf(f, "input: %u %04x %04x\n", (unsigned int) trace.events[i].frame,
+                trace.events[i].down, trace.events[i].up);
+    }
+
+    traceFree(&trace);
+
+    if (fclose(f)) {
+        return -1;
+    }
+
+    printf("%s: frame %u, work %u, stall %u\n", path, (unsigned int) c->worstFrame,
+           (unsigned int) c->work, (unsigned int) c->stall);
+    return 0;
+}
+
+static void openInstructionCounter(void)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // the children count their own
+    attr.inherit = 0;
+
+    instructionCounter = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (instructionCounter < 0) {
+        printf("perf can't count instructions here, work is host time\n");
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -r n       random candidates to start with (default 100)\n"
+        "  -i n       mutations after that (default 400)\n"
+        "  -l frames  frames per candidate (default 1200)\n"
+        "  -k n       worst cases to keep and write (default 5)\n"
+        "  -R n       runs per candidate, the cheapest counts (default 3)\n"
+        "  -c cost    work, stall or total (default total)\n"
+        "  -I         count instructions with perf for the work\n"
+        "  -S seed    random seed (default 1)\n"
+        "  -o dir     where the traces go (default worstcases)\n"
+        "  -s file    save chip contents every run starts with\n"
+        "  -m model   save chip, see flashSimModels (default macronix128k)\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *model = "macronix128k";
+    const char *saveFile = NULL;
+    const char *dir = "worstcases";
+    int randomCandidates = 100;
+    int mutations = 400;
+    int keepCount = 5;
+    int instructions = 0;
+    unsigned int seed = 1;
+    static struct Candidate pool[MAX_KEEP];
+    static struct Candidate c;
+    int pooled = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:i:l:k:R:c:IS:o:s:m:")) != -1) {
+        switch (opt) {
+            case 'r':
+                randomCandidates = atoi(optarg);
+                break;
+            case 'i':
+                mutations = atoi(optarg);
+                break;
+            case 'l':
+                length = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                keepCount = atoi(optarg);
+                break;
+            case 'R':
+                repeats = atoi(optarg);
+                break;
+            case 'c':
+                if (strcmp(optarg, "work") == 0) {
+                    costType = COST_WORK;
+                } else if (strcmp(optarg, "stall") == 0) {
+                    costType = COST_STALL;
+                } else if (strcmp(optarg, "total") == 0) {
+                    costType = COST_TOTAL;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'I':
+                instructions = 1;
+                break;
+            case 'S':
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            case 'o':
+                dir = optarg;
+                break;
+            case 's':
+                saveFile = optarg;
+                break;
+            case 'm':
+                model = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc || length < 16 || repeats < 1 || randomCandidates < 1 ||
+        keepCount < 1 || keepCount > MAX_KEEP) {
+        usage(argv[0]);
+    }
+
+    if (!flashSimFindModel(model)) {
+        fprintf(stderr, "worstcase: unknown save chip %s\n", model);
+        return 1;
+    }
+    flashSimInit(flashSimFindModel(model), 1);
+
+    if (saveFile && flashSimLoad(saveFile)) {
+        return 1;
+    }
+
+    if (instructions) {
+        openInstructionCounter();
+    }
+
+    srand(seed);
+
+    for (int i = 0; i < randomCandidates; i++) {
+        randomCandidate(&c);
+        if (evaluate(&c)) {
+            keep(pool, &pooled, keepCount, &c);
+        }
+    }
+    printf("random: worst frame %u, cost %llu\n", (unsigned int) pool[0].worstFrame,
+           (unsigned long long) pool[0].cost);
+
+    for (int i = 0; i < mutations && pooled > 0; i++) {
+        c = pool[randomBelow(pooled)];
+        mutate(&c);
+        if (evaluate(&c)) {
+            keep(pool, &pooled, keepCount, &c);
+        }
+    }
+    printf("guided: worst frame %u, cost %llu\n", (unsigned int) pool[0].worstFrame,
+           (unsigned long long) pool[0].cost);
+
+    if (mkdir(dir, 0777) && access(dir, W_OK)) {
+        fprintf(stderr, "worstcase: can't create %s\n", dir);
+        return 1;
+    }
+
+    for (int i = 0; i < pooled; i++) {
+        if (writeCase(dir, i + 1, &pool[i], saveFile)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
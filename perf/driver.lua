@@ -0,0 +1,55 @@
+-- SPDX-License-Identifier: MIT
+-- SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+-- mGBA script that plays a scenario (the input: lines of a trace, like
+-- host/replay reads them) into the ROM and tells perf/run.sh when it's over
+-- by creating the file in PERF_DONE. The frames are counted by mGBA from the
+-- start of the ROM, a few more than the game counts, which is the same on
+-- every run.
+
+local tracePath = os.getenv("PERF_TRACE")
+local donePath = os.getenv("PERF_DONE")
+
+-- frames after the last key change, for drawing and the last profile report
+local SETTLE = 130
+
+local events = {}
+local frames = 0
+
+for line in io.lines(tracePath) do
+    local n = line:match("^# frames (%d+)")
+    if n then
+        frames = tonumber(n)
+    end
+
+    local frame, down, up = line:match("input: (%d+) (%x+) (%x+)")
+    if frame then
+        events[#events + 1] = { tonumber(frame), tonumber(down, 16), tonumber(up, 16) }
+    end
+end
+
+local last = (#events > 0 and events[#events][1] or 0) + SETTLE
+if frames + SETTLE > last then
+    last = frames + SETTLE
+end
+
+local frame = 0
+local nextEvent = 1
+local held = 0
+
+callbacks:add("frame", function()
+    frame = frame + 1
+
+    -- the keys of the next frame, the bits are the same as KEY_*
+    while nextEvent <= #events and events[nextEvent][1] == frame + 1 do
+        held = (held | events[nextEvent][2]) & ~events[nextEvent][3]
+        nextEvent = nextEvent + 1
+    end
+    emu:setKeys(held)
+
+    if frame == last then
+        local f = io.open(donePath, "w")
+        f:write("done\n")
+        f:close()
+    end
+end)
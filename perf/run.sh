@@ -0,0 +1,86 @@
+#!/bin/sh
+# SPDX-License-Identifier: MIT
+# SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+# Runs every scenario in perf/scenarios through a ROM in mGBA and checks the
+# cycle counts of the profile scopes against perf/baselines, see perf/README.
+#   perf/run.sh [-u] rom.gba
+# -u writes the baselines instead, a missing one is always written.
+
+set -u
+
+dir=$(cd "$(dirname "$0")" && pwd)
+tools=$dir/../tools
+
+MGBA=${MGBA:-mgba-qt}
+MGBA_FLAGS=${MGBA_FLAGS:--l 15}
+PERF_THRESHOLD=${PERF_THRESHOLD:-2}
+PERF_TIMEOUT=${PERF_TIMEOUT:-120}
+
+update=0
+if [ "${1:-}" = "-u" ]; then
+    update=1
+    shift
+fi
+
+if [ $# -ne 1 ]; then
+    echo "usage: $0 [-u] rom.gba" >&2
+    exit 2
+fi
+rom=$1
+
+make --no-print-directory -s -C "$tools" perfcheck || exit 2
+
+mkdir -p "$dir/baselines"
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# mGBA's log goes to a file, line buffered so nothing is lost when it's killed
+linebuffered=
+if command -v stdbuf > /dev/null; then
+    linebuffered="stdbuf -oL -eL"
+fi
+
+failed=0
+
+for trace in "$dir"/scenarios/*.log; do
+    name=$(basename "$trace" .log)
+    log=$work/$name.txt
+    done=$work/$name.done
+    baseline=$dir/baselines/$name.txt
+    # a copy of its own, so mGBA starts it with an empty save chip and the
+    # .sav next to the build's ROM is left alone
+    copy=$work/$name.gba
+
+    cp "$rom" "$copy" || exit 2
+    PERF_TRACE=$trace PERF_DONE=$done \
+    QT_QPA_PLATFORM=offscreen SDL_VIDEODRIVER=dummy SDL_AUDIODRIVER=dummy \
+        $linebuffered $MGBA $MGBA_FLAGS --script "$dir/driver.lua" "$copy" > "$log" 2>&1 &
+    pid=$!
+
+    waited=0
+    while [ ! -e "$done" ] && kill -0 $pid 2> /dev/null && [ $waited -lt "$PERF_TIMEOUT" ]; do
+        sleep 1
+        waited=$((waited + 1))
+    done
+    # mGBA doesn't quit by itself
+    kill $pid 2> /dev/null
+    wait $pid 2> /dev/null
+
+    if [ ! -e "$done" ]; then
+        echo "$name: the scenario didn't finish, the end of mGBA's log:"
+        tail -n 20 "$log"
+        failed=1
+        continue
+    fi
+
+    if [ $update -eq 1 ] || [ ! -e "$baseline" ]; then
+        "$tools/perfcheck" -w "$baseline" "$log" || failed=1
+        echo "$name: wrote $baseline"
+    else
+        echo "$name:"
+        "$tools/perfcheck" -t "$PERF_THRESHOLD" -b "$baseline" "$log" || failed=1
+    fi
+done
+
+exit $failed
@@ -0,0 +1,38 @@
+#---------------------------------------------------------------------------------
+# Memory placement on the GBA, see source/placement.h. Read by the Makefile.
+#---------------------------------------------------------------------------------
+
+#---------------------------------------------------------------------------------
+# the functions that cost the most cycles in make bench (the blitters behind the
+# large and huge numbers, upside down glyphs and prepareCounters), ARM code in
+# IWRAM. They are marked IWRAM_ARM in the source, the build checks that every
+# one of them ended up in IWRAM.
+#---------------------------------------------------------------------------------
+IWRAM_FUNCTIONS	:= sbmp16_blit_mask sbmp16_blit_ud sbmp16_rect_ud \
+		   bmp16_drawg_b1cts_ud memcpy16_rev memset16_rev prepareCounters \
+		   sbmp8_blit_mask bmp8_drawg_b1cts_ud
+
+#---------------------------------------------------------------------------------
+# IWRAM is 32 KB, the top 256 bytes belong to the BIOS and the IRQ and user
+# stacks grow down from there; code and data may take what IWRAM_STACK leaves.
+# How deep the stack really gets is on the memory screen, see memstats.h.
+#---------------------------------------------------------------------------------
+IWRAM_SIZE	:= 32768
+IWRAM_STACK	:= 4096
+
+#---------------------------------------------------------------------------------
+# no function may need more stack than this (-fstack-usage), and none may need
+# a variable amount like a VLA does
+#---------------------------------------------------------------------------------
+STACK_FRAME_LIMIT	:= 512
+
+#---------------------------------------------------------------------------------
+# the heap is the part of EWRAM that code and data leave. It has to hold the
+# unpacked digit atlases, which the build adds up from their headers (the
+# tiled display unpacks its atlases into VRAM instead), and HEAP_RESERVE for
+# what newlib allocates itself.
+#---------------------------------------------------------------------------------
+EWRAM_SIZE	:= 262144
+HEAP_RESERVE	:= 8192
+
+ROM_SIZE	:= 33554432
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stddef.h>
+#include <string.h>
+
+#include "archive.h"
+#include "counters.h"
+#include "save.h"
+
+#define NO_WINNER 0xff
+
+// stats plus the worst case of the packed game below, commander damage takes
+// at most 3 bytes for every 2 values (a value and a run of one zero)
+#define ARCHIVE_RECORD_MAX (sizeof(struct ArchiveStats) + 16 + MAX_PLAYERS * 6 + MAX_PLAYERS * MAX_OPPONENTS * 3 / 2 + 2)
+
+// otherwise the save chip would turn the biggest games down
+_Static_assert(ARCHIVE_RECORD_MAX <= SAVE_CAPACITY(SAVE_ARCHIVE_RECORD_SIZE),
+               "the largest game doesn't fit an archive record, see save.h");
+
+// The first word of a record. Records from before it start with games and
+// have the seats of the 8 players there were then.
+#define ARCHIVE_FORMAT 0x41520002
+#define ARCHIVE_OLD_SEATS 8
+#define ARCHIVE_OLD_STATS_SIZE (offsetof(struct ArchiveStats, seats) - sizeof(uint32_t) + \
+                                ARCHIVE_OLD_SEATS * sizeof(struct ArchiveSeatStats))
+
+static struct ArchiveStats stats;
+
+void archiveInit(void)
+{
+    uint32_t len = saveSlotRead(SAVE_SLOT_ARCHIVE, &stats, sizeof(stats));
+
+    if (len >= sizeof(stats) && stats.format == ARCHIVE_FORMAT) {
+        return;
+    }
+
+    // the statistics of an old record are kept, the seats it didn't have are 0
+    if (len >= ARCHIVE_OLD_STATS_SIZE) {
+        memmove(&stats.games, &stats, ARCHIVE_OLD_STATS_SIZE);
+        memset(&stats.seats[ARCHIVE_OLD_SEATS], 0, sizeof(stats) - sizeof(uint32_t) - ARCHIVE_OLD_STATS_SIZE);
+    } else {
+        memset(&stats, 0, sizeof(stats));
+    }
+    stats.format = ARCHIVE_FORMAT;
+}
+
+const struct ArchiveStats *archiveStats(void)
+{
+    return &stats;
+}
+
+int archiveEliminationCause(const struct GameState *state, int player)
+{
+    const struct Players *players = &state->players;
+
+    for (int j = 0; j < state->maxOpponents; j++) {
+        if (playerCommanderDamage(players, player, j) >= MAX_COMMANDER_DAMAGE) {
+            return ARCHIVE_END_COMMANDER_DAMAGE;
+        }
+    }
+
+    if (lethalCounter(players, player) >= 0) {
+        return ARCHIVE_END_POISON;
+    }
+
+    if (playerLife(players, player) <= 0) {
+        return ARCHIVE_END_LIFE;
+    }
+
+    return -1;
+}
+
+static uint8_t *putVarint(uint8_t *out, int value)
+{
+    // zigzag so small negative life totals stay small
+    uint32_t v = (value << 1) ^ (value >> 31);
+
+    while (v >= 0x80) {
+        *out++ = v | 0x80;
+        v >>= 7;
+    }
+    *out++ = v;
+
+    return out;
+}
+
+// Commander damage is mostly zeros, so runs of them become 0 + length.
+static uint8_t *putCommanderDamage(uint8_t *out, const struct GameState *state)
+{
+    int zeros = 0;
+
+    for (int i = 0; i < state->maxPlayers; i++) {
+        for (int j = 0; j < state->maxOpponents; j++) {
+            int damage = playerCommanderDamage(&state->players, i, j);
+
+            if (damage == 0) {
+                zeros++;
+                continue;
+            }
+
+            if (zeros) {
+                *out++ = 0;
+                *out++ = zeros;
+                zeros = 0;
+            }
+            *out++ = damage;
+        }
+    }
+
+    if (zeros) {
+        *out++ = 0;
+        *out++ = zeros;
+    }
+
+    return out;
+}
+
+static void updateStats(const struct GameState *state, int winner, int ending)
+{
+    stats.games++;
+    if (ending == ARCHIVE_END_COMMANDER_DAMAGE) {
+        stats.commanderDamageEndings++;
+    } else if (ending == ARCHIVE_END_POISON) {
+        stats.poisonEndings++;
+    }
+
+    for (int i = 0; i < state->maxPlayers; i++) {
+        struct ArchiveSeatStats *seat = &stats.seats[i];
+        int lost = state->startingLife - playerLife(&state->players, i);
+        int cause = archiveEliminationCause(state, i);
+
+        seat->games++;
+        if (i == winner) {
+            seat->wins++;
+        }
+        if (lost > 0) {
+            seat->lifeLost += lost;
+        }
+        if (cause == ARCHIVE_END_COMMANDER_DAMAGE) {
+            seat->commanderDamageDeaths++;
+        } else if (cause == ARCHIVE_END_POISON) {
+            seat->poisonDeaths++;
+        }
+    }
+}
+
+int archiveAppend(const struct GameState *state, uint32_t eventCount)
+{
+    static uint8_t buf[ARCHIVE_RECORD_MAX];
+    struct ArchiveStats before = stats;
+    int winner = NO_WINNER;
+    int ending = ARCHIVE_END_UNFINISHED;
+    uint8_t *out;
+
+    // a single player game (the 1p commander mode) has no one to win against
+    if (state->maxPlayers > 1 && state->eliminatedPlayers == state->maxPlayers - 1) {
+        for (int i = 0; i < state->maxPlayers; i++) {
+            if (archiveEliminationCause(state, i) < 0) {
+                winner = i;
+            }
+        }
+    }
+
+    if (state->eliminatedPlayers > 0 && (winner != NO_WINNER || state->maxPlayers == 1)) {
+        ending = archiveEliminationCause(state, state->eliminationOrder[state->eliminatedPlayers - 1]);
+    }
+
+    updateStats(state, winner, ending);
+
+    out = buf + sizeof(stats);
+    *out++ = state->maxPlayers | (state->maxOpponents << 4);
+    out = putVarint(out, state->startingLife);
+    out = putVarint(out, eventCount);
+    *out++ = winner;
+    *out++ = ending;
+    *out++ = state->eliminatedPlayers;
+    for (int i = 0; i < state->eliminatedPlayers; i++) {
+        int player = state->eliminationOrder[i];
+        *out++ = player | (archiveEliminationCause(state, player) << 4);
+    }
+    for (int i = 0; i < state->maxPlayers; i++) {
+        out = putVarint(out, playerLife(&state->players, i));
+    }
+    out = putCommanderDamage(out, state);
+
+    memcpy(buf, &stats, sizeof(stats));
+    if (!saveSlotWrite(SAVE_SLOT_ARCHIVE, buf, out - buf)) {
+        stats = before;
+        return 0;
+    }
+
+    return 1;
+}
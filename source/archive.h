@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef ARCHIVE_H__
+#define ARCHIVE_H__
+
+#include <stdint.h>
+
+#include "gamestate.h"
+
+// Finished games are appended to the archive slot of the save chip. Every
+// record starts with the running statistics including that game, so the
+// newest record is all that's needed to show them.
+
+enum ARCHIVE_END {
+    ARCHIVE_END_LIFE = 0,
+    ARCHIVE_END_COMMANDER_DAMAGE,
+    ARCHIVE_END_POISON, // or any other counter with a lethal amount
+    ARCHIVE_END_UNFINISHED, // quit with more than one player left
+};
+
+struct ArchiveSeatStats {
+    uint16_t games;
+    uint16_t wins;
+    uint32_t lifeLost; // starting life - final life, summed over games
+    uint16_t commanderDamageDeaths;
+    uint16_t poisonDeaths;
+};
+
+struct ArchiveStats {
+    uint32_t format;
+    uint32_t games;
+    uint16_t commanderDamageEndings;
+    uint16_t poisonEndings;
+    struct ArchiveSeatStats seats[MAX_PLAYERS];
+};
+
+// loads the statistics from the newest record
+void archiveInit(void);
+const struct ArchiveStats *archiveStats(void);
+// returns 1 if the game was stored
+int archiveAppend(const struct GameState *state, uint32_t eventCount);
+// the reason a player is out or -1
+int archiveEliminationCause(const struct GameState *state, int player);
+
+#endif
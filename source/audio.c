@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <gba_interrupt.h>
+#include <gba_timers.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "audio.h"
+#include "debug.h"
+#include "profile.h"
+
+#include "AAS.h"
+
+#define AUDIO_MOD_VOLUME 48
+#define AUDIO_SFX_VOLUME 255
+#define AUDIO_SFX_SAMPLE_VOLUME 64
+// tools/audioprep stores the effects at the mixer rate, see assets.mk
+#ifndef AUDIO_RATE
+#define AUDIO_RATE 32000
+#endif
+#define AUDIO_SFX_RATE AUDIO_RATE
+#define AUDIO_SFX_CHANNELS 4
+
+// AAS swaps the mix buffers from the Timer1 interrupt. Once that interrupt is
+// more than about the sound FIFO's worth of samples late, the DMA plays
+// samples that were already played and the output clicks.
+#define AUDIO_UNDERRUN_SAMPLES 16
+
+// Repeated triggers of the same effect closer than this are one trigger.
+#define AUDIO_SFX_COALESCE_FRAMES 8
+
+// Effects that aren't listed have priority 0.
+static const int sfxPriorities[AUDIO_SFXS] = {
+    [AUDIO_SFX_HIT] = 1,
+    [AUDIO_SFX_POISON] = 2,
+    [AUDIO_SFX_DEATH] = 3,
+};
+
+struct AudioVoice {
+    int sfx;
+    uint32_t started;
+};
+
+struct AudioConfig {
+    int mix;
+    int spatial;
+    int khz;
+    int sfx;
+};
+
+// Indexed by (song playing) * 2 + (sound effects enabled). AAS keeps the
+// first AUDIO_MOD_CHANNELS channels for the MODs whether one plays or not,
+// the sound effects get channels on top of those. Every configuration with
+// effects mixes at the rate they are stored at, so they're never stepped
+// through, without a song it only stays mono.
+#if AUDIO_RATE != 32000
+#error "the configurations with sound effects mix at 32 kHz, see assets.mk"
+#endif
+static const struct AudioConfig configs[] = {
+    { AAS_CONFIG_MIX_8KHZ, AAS_CONFIG_SPATIAL_MONO, 8, 0 },
+    { AAS_CONFIG_MIX_32KHZ, AAS_CONFIG_SPATIAL_MONO, 32, 1 },
+    { AAS_CONFIG_MIX_32KHZ, AAS_CONFIG_SPATIAL_STEREO, 32, 0 },
+    { AAS_CONFIG_MIX_32KHZ, AAS_CONFIG_SPATIAL_STEREO, 32, 1 },
+};
+
+static const struct AudioConfig *currentConfig = NULL;
+static int currentSong = AUDIO_NO_SONG;
+static int currentSfxEnabled = 0;
+static int sfxChannels = 0;
+static struct AudioVoice voices[AUDIO_SFX_CHANNELS];
+static uint32_t frame = 0;
+
+static volatile uint32_t mixerCycles = 0;
+static uint32_t mixerCyclesTotal = 0;
+static uint32_t mixerFrames = 0;
+
+static volatile uint32_t underruns = 0;
+static uint16_t timer1Reload = 0xffff;
+
+static void audioTimer1InterruptHandler(void)
+{
+    uint32_t start = profileCycles();
+    // Timer 1 counts the mixed samples from the value AAS reloads it with,
+    // the lowest count seen on entry is (close to) no latency at all.
+    uint16_t count = REG_TM1CNT_L;
+
+    if (count < timer1Reload) {
+        timer1Reload = count;
+    } else if (count - timer1Reload > AUDIO_UNDERRUN_SAMPLES) {
+        underruns++;
+    }
+
+    AAS_Timer1InterruptHandler();
+
+    mixerCycles += profileCycles() - start;
+}
+
+static int configChannels(const struct AudioConfig *config)
+{
+    int channels = AUDIO_MOD_CHANNELS + (config->sfx ? AUDIO_SFX_CHANNELS : 0);
+
+    return channels <= 4 ? 4 : channels <= 8 ? 8 : 16;
+}
+
+static void applyConfig(const struct AudioConfig *config)
+{
+    int channels = configChannels(config);
+
+    if (currentConfig) {
+        debugPrintf("audio: mixer took %u cycles/frame at %d kHz, %d channels",
+                    (unsigned int) audioMixerCycles(), currentConfig->khz, configChannels(currentConfig));
+    }
+
+    AAS_SetConfig(config->mix,
+                  channels == 4 ? AAS_CONFIG_CHANS_4 : channels == 8 ? AAS_CONFIG_CHANS_8 : AAS_CONFIG_CHANS_16,
+                  config->spatial, AAS_CONFIG_DYNAMIC_OFF);
+
+    AAS_MOD_SetVolume(AUDIO_MOD_VOLUME);
+
+    sfxChannels = 0;
+    while (sfxChannels < AUDIO_SFX_CHANNELS && AAS_SFX_ChannelExists(sfxChannels)) {
+        AAS_SFX_SetVolume(sfxChannels, AUDIO_SFX_VOLUME);
+        voices[sfxChannels].sfx = -1;
+        sfxChannels++;
+    }
+
+    currentConfig = config;
+    // the buffers are a different size now
+    timer1Reload = 0xffff;
+    mixerCyclesTotal = 0;
+    mixerFrames = 0;
+}
+
+void audioInit(void)
+{
+    // AAS has to be configured before the interrupts are set up
+    AAS_SetConfig(AAS_CONFIG_MIX_8KHZ, AAS_CONFIG_CHANS_4,
+                  AAS_CONFIG_SPATIAL_MONO, AAS_CONFIG_DYNAMIC_OFF);
+
+    irqInit();
+    irqSet(IRQ_TIMER1, audioTimer1InterruptHandler);
+    irqEnable(IRQ_VBLANK);
+}
+
+void audioConfigure(int song, int sfxEnabled)
+{
+    const struct AudioConfig *config;
+    int songPos = 0;
+
+    if (song < 0 || song >= AUDIO_SONGS) {
+        song = AUDIO_NO_SONG;
+    }
+
+    currentSfxEnabled = sfxEnabled;
+    config = &configs[(song != AUDIO_NO_SONG) * 2 + (sfxEnabled ? 1 : 0)];
+
+    if (config == currentConfig && song == currentSong) {
+        return;
+    }
+
+    if (currentSong != AUDIO_NO_SONG) {
+        songPos = AAS_MOD_GetSongPos();
+        AAS_MOD_Stop();
+    }
+
+    if (config != currentConfig) {
+        applyConfig(config);
+    }
+
+    if (song != AUDIO_NO_SONG) {
+        AAS_MOD_Play(audioSongs[song].mod);
+
+        // only the sound effects were switched, carry on where we were
+        if (song == currentSong && songPos > 0) {
+            AAS_MOD_SetSongPos(songPos);
+        }
+    }
+
+    currentSong = song;
+}
+
+void audioStopSong(void)
+{
+    audioConfigure(AUDIO_NO_SONG, currentSfxEnabled);
+}
+
+int audioSfxChannels(void)
+{
+    return sfxChannels;
+}
+
+// Frames the start of an effect lasts (a quarter of it), it isn't restarted
+// before that.
+static uint32_t attackFrames(const struct AudioSfxData *effect)
+{
+    uint32_t samples = *effect->end - *effect->start;
+    uint32_t frames = samples * 60 / AUDIO_SFX_RATE / 4;
+
+    return frames > AUDIO_SFX_COALESCE_FRAMES ? frames : AUDIO_SFX_COALESCE_FRAMES;
+}
+
+// A free channel, or else the one playing the least important effect (the
+// oldest of those). Never one playing something more important.
+static int findVoice(int sfx)
+{
+    int victim = -1;
+
+    for (int c = 0; c < sfxChannels; c++) {
+        if (voices[c].sfx < 0) {
+            return c;
+        }
+    }
+
+    for (int c = 0; c < sfxChannels; c++) {
+        int priority = sfxPriorities[voices[c].sfx];
+
+        if (priority > sfxPriorities[sfx]) {
+            continue;
+        }
+        if (victim < 0 ||
+            priority < sfxPriorities[voices[victim].sfx] ||
+            (priority == sfxPriorities[voices[victim].sfx] && voices[c].started < voices[victim].started)) {
+            victim = c;
+        }
+    }
+
+    return victim;
+}
+
+void audioPlaySfx(int sfx)
+{
+    const struct AudioSfxData *effect = &audioSfxData[sfx];
+    int channel = -1;
+
+    for (int c = 0; c < sfxChannels; c++) {
+        if (voices[c].sfx >= 0 && !AAS_SFX_IsActive(c)) {
+            voices[c].sfx = -1;
+        }
+    }
+
+    // the same effect already playing is restarted in place, once its attack is over
+    for (int c = 0; c < sfxChannels; c++) {
+        if (voices[c].sfx == sfx) {
+            if (frame - voices[c].started < attackFrames(effect)) {
+                return;
+            }
+            channel = c;
+            break;
+        }
+    }
+
+    if (channel < 0) {
+        channel = findVoice(sfx);
+    }
+
+    if (channel < 0) {
+        return;
+    }
+
+    AAS_SFX_Play(channel, AUDIO_SFX_SAMPLE_VOLUME, AUDIO_SFX_RATE, *effect->start, *effect->end,
+                 effect->loop ? *effect->start : NULL);
+
+    voices[channel].sfx = sfx;
+    voices[channel].started = frame;
+}
+
+void audioFrame(void)
+{
+    uint32_t cycles;
+
+    REG_IME = 0;
+    cycles = mixerCycles;
+    mixerCycles = 0;
+    REG_IME = 1;
+
+    mixerCyclesTotal += cycles;
+    mixerFrames++;
+    frame++;
+}
+
+uint32_t audioMixerCycles(void)
+{
+    return mixerFrames ? mixerCyclesTotal / mixerFrames : 0;
+}
+
+uint32_t audioUnderruns(void)
+{
+    return underruns;
+}
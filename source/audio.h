@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef AUDIO_H__
+#define AUDIO_H__
+
+#include <stdint.h>
+
+#include "AAS.h"
+
+// generated from AAS_Data by tools/audioreg: AUDIO_SONGS, AUDIO_MOD_CHANNELS
+// and the AUDIO_SFX_* indices
+#include "audio_registry.h"
+
+#define AUDIO_NO_SONG -1
+
+struct AudioSong {
+    int mod;
+    const char *name;
+    int channels;
+};
+
+struct AudioSfxData {
+    const AAS_s8 *const *start;
+    const AAS_s8 *const *end;
+    const char *name;
+    int loop;
+};
+
+extern const struct AudioSong audioSongs[AUDIO_SONGS];
+extern const struct AudioSfxData audioSfxData[AUDIO_SFXS];
+
+// Sets up the interrupts and AAS, nothing plays until audioConfigure.
+void audioInit(void);
+
+// Plays song (an index into audioSongs, AUDIO_NO_SONG for silence) with the
+// cheapest mixer setup that still covers it and, if enabled, the sound
+// effects. Only touches AAS when something changed, the song keeps its
+// position across a reconfiguration.
+void audioConfigure(int song, int sfxEnabled);
+void audioStopSong(void);
+
+int audioSfxChannels(void);
+
+// Plays a sound effect on a free channel or steals one playing something less
+// important. Triggers of an effect that just started are dropped.
+void audioPlaySfx(int sfx);
+
+// Call once per frame, collects the cycles spent in the Timer1 mixer.
+void audioFrame(void);
+
+// Average cycles per frame the mixer took since the last configuration.
+uint32_t audioMixerCycles(void);
+
+// Times the mixer interrupt came too late to swap the buffers in time.
+uint32_t audioUnderruns(void);
+
+#endif
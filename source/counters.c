@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdio.h>
+#include <string.h>
+
+#include "audio.h"
+#include "counters.h"
+#include "text.h"
+
+const struct CounterType counterTypes[COUNTERS] = {
+    [POISON_COUNTER] = { 'P', COLOR_LIME, 1, 0, 99, MAX_POISON_COUNTERS, AUDIO_SFX_POISON, 0 },
+    [ENERGY_COUNTER] = { 'E', COLOR_CREAM, 1, 0, 99, 0, AUDIO_SFX_ENERGY, 0 },
+    [EXPERIENCE_COUNTER] = { 'X', COLOR_GRAY, 1, 0, 99, 0, AUDIO_SFX_EXPERIENCE, 0 },
+    // counts the tax itself, 2 more for every cast from the command zone
+    [COMMANDERTAX_COUNTER] = { 'C', COLOR_WHITE, 2, 0, 98, 0, COUNTER_NO_SFX, 1 },
+};
+
+int lastCounter(const struct GameState *state)
+{
+    int last = LAST_COUNTER;
+
+    while (state->maxOpponents == 0 && counterType(last)->commanderOnly) {
+        last--;
+    }
+
+    return last;
+}
+
+int lethalCounter(const struct Players *players, int player)
+{
+    for (int i = 0; i < COUNTERS; i++) {
+        if (counterTypes[i].lethal && players->counters[i][player] >= counterTypes[i].lethal) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int getPlayerColor(int player)
+{
+    int color = 0;
+    switch (player) {
+        /* large start */
+        case 0:
+            color = COLOR_BLUE;
+            break;
+        case 1:
+            color = COLOR_ORANGE;
+            break;
+        case 2:
+            color = COLOR_MAGENTA;
+            break;
+        case 3:
+            color = COLOR_GREEN;
+            break;
+        /* large end */
+        case 4:
+            color = COLOR_PURPLE;
+            break;
+        case 5:
+            color = COLOR_CYAN;
+            break;
+        case 6:
+            color = COLOR_CREAM;
+            break;
+        case 7:
+            color = COLOR_YELLOW;
+            break;
+        case 8:
+            color = COLOR_FUCHSIA;
+            break;
+        case 9:
+            color = COLOR_LIME;
+            break;
+        case 10:
+            color = COLOR_GRAY;
+            break;
+        default:
+            color = COLOR_WHITE;
+    };
+
+    return color;
+}
+
+static void reverseString(char* str)
+{
+    int start = 0;
+    int end = strlen(str) - 1;
+    char temp;
+
+    while (start < end) {
+        temp = str[start];
+        str[start] = str[end];
+        str[end] = temp;
+
+        start++;
+        end--;
+    }
+}
+
+// All of them when they fit, otherwise a page one shorter leaves room for
+// the marks.
+static int shownOpponents(struct GameState *state)
+{
+    return state->maxOpponents <= COMMANDER_DAMAGE_SHOWN ? state->maxOpponents : COMMANDER_DAMAGE_SHOWN - 1;
+}
+
+// The first opponent of the page that has the selection, the last page
+// while a counter is selected. Other players show the first page.
+static int firstShownOpponent(struct GameState *state, int player)
+{
+    int shown = shownOpponents(state);
+    int first = 0;
+
+    if (shown == state->maxOpponents) {
+        return 0;
+    }
+
+    if (player == state->selectedPlayer) {
+        first = state->selectedCommanderDamageOrCounter / shown * shown;
+    }
+
+    return first < state->maxOpponents - shown ? first : state->maxOpponents - shown;
+}
+
+// right next to the values, the row has no room for another space
+static int printMore(char *buf, int len, int buflen, char mark)
+{
+    return len + snprintf(buf + len, buflen - len, "#{ci:%d}%c", convertColor(COLOR_WHITE), mark);
+}
+
+IWRAM_ARM void prepareCounters(char *countersBuf, char *commanderDamageBuf, int buflen, struct GameState *state, int player, int ud)
+{
+    const struct Players *players = &state->players;
+    int first = firstShownOpponent(state, player);
+    int shown = shownOpponents(state);
+    // upside down they are read from the end of the line
+    int more = first + shown < state->maxOpponents;
+    int before = first > 0;
+    int len = 0;
+
+    countersBuf[0] = 0;
+    commanderDamageBuf[0] = 0;
+
+    if (ud ? more : before) {
+        len = printMore(commanderDamageBuf, len, buflen, ud ? '>' : '<');
+    }
+
+    // upside down the opponents come in reverse and every value is mirrored
+    for (int i = 0; i < shown && len < buflen; i++) {
+        int j = ud ? first + shown - 1 - i : first + i;
+        // opponents are counted without the player itself
+        int c = j < player ? j : j + 1;
+        int col = getPlayerColor(c);
+        char value[8];
+
+        if (playerCommanderDamage(players, player, j) >= MAX_COMMANDER_DAMAGE) {
+            col = COLOR_RED;
+        }
+
+        snprintf(value, sizeof(value), "%d%s", playerCommanderDamage(players, player, j),
+                 (player == state->selectedPlayer && j == state->selectedCommanderDamageOrCounter) ? "." : "");
+        if (ud) {
+            reverseString(value);
+        }
+        len += snprintf(commanderDamageBuf + len, buflen - len, "%s#{ci:%d}%s", i ? " " : "",
+                        convertColor(col), value);
+    }
+
+    if ((ud ? before : more) && len < buflen) {
+        printMore(commanderDamageBuf, len, buflen, ud ? '<' : '>');
+    }
+
+    // upside down the whole line is mirrored, the last counter comes first
+    // and the letters follow the values
+    int last = lastCounter(state);
+    len = 0;
+    for (int i = 0; i <= last - FIRST_COUNTER && len < buflen; i++) {
+        int counter = ud ? last - i : FIRST_COUNTER + i;
+        const struct CounterType *type = counterType(counter);
+        char value[8];
+
+        snprintf(value, sizeof(value), "%d%s", playerCounter(players, player, counter),
+                 (state->selectedPlayer == player && selectedCounter(state) == counter) ? "." : "");
+        if (ud) {
+            reverseString(value);
+            len += snprintf(countersBuf + len, buflen - len, "%s#{ci:%d}%s%c", len ? " " : "",
+                            convertColor(type->color), value, type->letter);
+        } else {
+            len += snprintf(countersBuf + len, buflen - len, "%s#{ci:%d}%c%s", len ? " " : "",
+                            convertColor(type->color), type->letter, value);
+        }
+    }
+}
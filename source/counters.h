@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef COUNTERS_H__
+#define COUNTERS_H__
+
+#include "gamestate.h"
+#include "placement.h"
+
+#define COUNTER_NO_SFX -1
+
+// Everything about a counter, adding one is an entry in counterTypes and an
+// id in enum COUNTER. Counters that only exist in commander games come last.
+struct CounterType {
+    char letter;
+    int color;
+    // per press of left/right
+    int step;
+    int min;
+    int max;
+    // a player with this many is out, 0 if there's no such amount
+    int lethal;
+    // AUDIO_SFX_* when the counter changes or COUNTER_NO_SFX
+    int sfx;
+    int commanderOnly;
+};
+
+// indexed by counter
+extern const struct CounterType counterTypes[COUNTERS];
+
+static inline const struct CounterType *counterType(int counter)
+{
+    return &counterTypes[counter];
+}
+
+// the last counter there is in this game, commander only ones need opponents
+int lastCounter(const struct GameState *state);
+// the first counter the player has a lethal amount of, or -1
+int lethalCounter(const struct Players *players, int player);
+
+// the color of each player's life, also used for their commander damage
+int getPlayerColor(int player);
+
+// The commander damage of this many opponents fits the row of a seat. With
+// more the row shows a page of one less, with a < or > where there are more.
+#define COMMANDER_DAMAGE_SHOWN 7
+
+// Room for both lines of prepareCounters joined by a space, every entry is at
+// most " #{ci:65535}X255." and there are COMMANDER_DAMAGE_SHOWN + COUNTERS of
+// them and the two marks.
+#define COUNTER_TEXT_LEN ((COMMANDER_DAMAGE_SHOWN + 2 + COUNTERS) * 18 + 1)
+
+// Formats a player's commander damage and their other counters as TTE
+// strings with colors, each into a buffer of buflen bytes. The selected
+// counter gets a dot, the page of commander damage is the one it's on.
+// ud writes them reversed for upside down printing.
+IWRAM_ARM void prepareCounters(char *countersBuf, char *commanderDamageBuf, int buflen, struct GameState *state, int player, int ud);
+
+#endif
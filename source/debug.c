@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "debug.h"
+
+#ifdef HOST_BUILD
+// the log goes to stderr
+static int enabled = 1;
+
+void debugInit(void)
+{
+}
+
+int debugEnabled(void)
+{
+    return enabled;
+}
+
+void debugPrintf(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+
+    fputc('\n', stderr);
+}
+#else
+#define REG_DEBUG_ENABLE (*(volatile uint16_t *) 0x04fff780)
+#define REG_DEBUG_FLAGS (*(volatile uint16_t *) 0x04fff700)
+#define REG_DEBUG_STRING ((char *) 0x04fff600)
+
+#define DEBUG_STRING_LEN 256
+#define DEBUG_LEVEL_INFO 3
+#define DEBUG_SEND 0x100
+
+static int enabled = 0;
+
+void debugInit(void)
+{
+    REG_DEBUG_ENABLE = 0xc0de;
+    enabled = REG_DEBUG_ENABLE == 0x1dea;
+}
+
+int debugEnabled(void)
+{
+    return enabled;
+}
+
+void debugPrintf(const char *fmt, ...)
+{
+    va_list args;
+
+    if (!enabled) {
+        return;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(REG_DEBUG_STRING, DEBUG_STRING_LEN, fmt, args);
+    va_end(args);
+
+    REG_DEBUG_FLAGS = DEBUG_LEVEL_INFO | DEBUG_SEND;
+}
+#endif
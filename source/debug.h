@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef DEBUG_H__
+#define DEBUG_H__
+
+// Log lines through the mGBA debug port, does nothing on hardware.
+void debugInit(void);
+int debugEnabled(void);
+void debugPrintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef DISPLAY_H__
+#define DISPLAY_H__
+
+#include <stdint.h>
+
+// What text.c draws onto, picked at build time with DISPLAY (assets.mk):
+//   bitmap - display_bitmap.c, everything in the one mode 3 framebuffer
+//   tiled  - display_tiled.c, mode 0 with a tile layer per kind of content,
+//            text is a screen entry per character and the number glyphs are
+//            screen entries pointing at the deduplicated atlas tiles
+//   paletted - display_paletted.c, the mode 4 framebuffer of palette
+//            indices, with an ink of its own for every player
+// All of them leave the sprites on, 1D mapped, for indicator.h.
+// The layers are stacked in the order of the enum, the first on top. The
+// menus and the other full screen pages are on their own layer so that the
+// game can stay where it is underneath them. The bitmap display has a single
+// layer, there everything goes to the same framebuffer. The game can be
+// taller than the screen, see displayScrollGame.
+enum DISPLAY_LAYER {
+    // menus, setup and the other pages that take the whole screen
+    DISPLAY_LAYER_SCREEN = 0,
+    DISPLAY_LAYER_COUNTERS,
+    DISPLAY_LAYER_NUMBERS,
+    DISPLAY_LAYERS,
+};
+
+enum DISPLAY_FONT {
+    DISPLAY_FONT_HUGE = 0,
+    DISPLAY_FONT_LARGE,
+    DISPLAY_FONT_MEDIUM,
+    // only ever right side up
+    DISPLAY_FONT_SMALL,
+};
+
+// 1 if clearing or hiding one layer leaves the others as they are.
+int displayHasLayers(void);
+// Where the following drawing goes.
+void displaySetLayer(int layer);
+void displayClearLayer(int layer);
+// Shows or hides the layers of the game, the screen layer is always shown.
+void displayShowGame(int show);
+// The game layers are drawn to in their own pixel rows, this many of them.
+// Where that's more than the screen they are scrolled in hardware, otherwise
+// only the rows on the screen are kept and scrolling means drawing again.
+int displayGameHeight(void);
+// Shows the game layers from pixel row top on, a multiple of the text
+// height. The positions displayNumberPixel gives follow it.
+void displayScrollGame(int top);
+
+// The rest is for text.c.
+void displayInit(void);
+int displayGlyphWidth(void);
+int displayGlyphHeight(void);
+void displaySetInk(uint16_t color);
+// buf is one line of text with TTE color commands, upside down it has been
+// padded already and each character is drawn rotated where it is.
+void displayWriteText(int row, int column, int fillcolumn, int ud, const char *buf);
+// Clears everything, all layers.
+void displayClear(void);
+// Clears the pixel rows top to bottom - 1 of the game layers.
+void displayClearRows(int top, int bottom);
+
+// Sets a font up on first use, calling it again does nothing.
+void displayLoadFont(int font);
+int displayFontWidth(int font);
+int displayFontHeight(int font);
+// A number is drawn a glyph per slot from offset_x, offset_y, upside down
+// the whole number is rotated around the center of the screen.
+void displayNumberGlyph(int font, int offset_x, int offset_y, int slot, int glyph, uint16_t color, int ud);
+void displayClearNumberGlyph(int font, int offset_x, int offset_y, int slot, int ud);
+
+// Whether pixel x, y of a glyph is set, for a font that has been set up.
+int displayNumberGlyphPixel(int font, int glyph, int x, int y);
+// Where pixel x, y of the glyph in slot ends up on the screen, upside down
+// that's the pixel of the rotated glyph. Numbers are on the game layers.
+void displayNumberPixel(int font, int offset_x, int offset_y, int slot, int ud, int x, int y, int *screenX, int *screenY);
+
+// 1 if a player's number can be drawn in an ink that belongs to the player.
+// Changing its color changes what's on the screen without drawing anything.
+int displayHasPlayerInks(void);
+void displaySetPlayerInk(int player, uint16_t color);
+// The number glyphs that follow are drawn in the ink of player instead of
+// their color, -1 goes back to the colors.
+void displayUsePlayerInk(int player);
+
+#endif
@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <tonc.h>
+#include <tonc_video.h>
+
+#include "display.h"
+#include "memstats.h"
+#include "tonc_ext.h"
+#include "VCR_OSD_MONO_NUMBERS_HUGE.h"
+#include "VCR_OSD_MONO_NUMBERS_LARGE.h"
+#include "VCR_OSD_MONO_NUMBERS_MEDIUM.h"
+#include "VCR_OSD_MONO_NUMBERS_SMALL.h"
+
+// The digit atlases are generated from font/VCR_OSD_MONO.ttf by tools/atlasc
+// at build time and kept compressed in ROM as 1bpp masks.
+struct NumberFont {
+    const unsigned char *packed;
+    const unsigned char *packedUd;
+    int compression;
+    int rawSize;
+    int width;
+    int height;
+    int pitch;
+    const u8 *mask;
+    const u8 *maskUd;
+};
+
+static struct NumberFont numberFonts[] = {
+    [DISPLAY_FONT_HUGE] = {
+        VCR_OSD_MONO_NUMBERS_HUGE,
+        NULL,
+        VCR_OSD_MONO_NUMBERS_HUGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_HUGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_HUGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_HUGE_PITCH,
+    },
+    [DISPLAY_FONT_LARGE] = {
+        VCR_OSD_MONO_NUMBERS_LARGE,
+        VCR_OSD_MONO_NUMBERS_LARGE_UD,
+        VCR_OSD_MONO_NUMBERS_LARGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_LARGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_LARGE_PITCH,
+    },
+    [DISPLAY_FONT_MEDIUM] = {
+        VCR_OSD_MONO_NUMBERS_MEDIUM,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_UD,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_WIDTH,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_PITCH,
+    },
+    [DISPLAY_FONT_SMALL] = {
+        VCR_OSD_MONO_NUMBERS_SMALL,
+        NULL,
+        VCR_OSD_MONO_NUMBERS_SMALL_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_SMALL_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_SMALL_WIDTH,
+        VCR_OSD_MONO_NUMBERS_SMALL_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_SMALL_PITCH,
+    },
+};
+
+// Only the part of the game that's on the screen is in the framebuffer,
+// from gameTop on. The screen layer isn't scrolled.
+static int layer = DISPLAY_LAYER_SCREEN;
+static int gameTop = 0;
+
+int displayHasLayers(void)
+{
+    return 0;
+}
+
+// still picks whether what's drawn is scrolled
+void displaySetLayer(int l)
+{
+    layer = l;
+}
+
+// there is only the one layer, that's clearing the screen
+void displayClearLayer(int layer)
+{
+    displayClear();
+}
+
+void displayShowGame(int show)
+{
+}
+
+int displayGameHeight(void)
+{
+    return SCREEN_HEIGHT;
+}
+
+void displayScrollGame(int top)
+{
+    gameTop = top;
+}
+
+// how far up what's drawn now goes
+static int drawTop(void)
+{
+    return layer == DISPLAY_LAYER_SCREEN ? 0 : gameTop;
+}
+
+void displayInit(void)
+{
+    tte_init_bmp(3, &sys8Font, NULL);
+    REG_DISPCNT = DCNT_MODE3 | DCNT_BG2 | DCNT_OBJ | DCNT_OBJ_1D;
+}
+
+int displayGlyphWidth(void)
+{
+    return tte_get_glyph_width(0);
+}
+
+int displayGlyphHeight(void)
+{
+    return tte_get_glyph_height(0);
+}
+
+void displaySetInk(uint16_t color)
+{
+    tte_set_color(TTE_INK, color);
+}
+
+void displayWriteText(int row, int column, int fillcolumn, int ud, const char *buf)
+{
+    TTC *tc = tte_get_context();
+    int gh = tte_get_glyph_height(0);
+    int h = row * gh - drawTop();
+
+    // a row that is scrolled off is nowhere
+    if (h < 0 || h + gh > SCREEN_HEIGHT) {
+        return;
+    }
+
+    sbmp16_rect(&tc->dst, column, h, column + fillcolumn, h + gh, tc->cattr[TTE_PAPER]);
+
+    if (ud) {
+        tte_set_pos(column, h + gh);
+        tte_write_ud(buf);
+    } else {
+        tte_set_pos(column, h);
+        tte_write(buf);
+    }
+}
+
+void displayClear(void)
+{
+    tte_write("#{es;P}");
+}
+
+void displayClearRows(int top, int bottom)
+{
+    top = max(top - gameTop, 0);
+    bottom = min(bottom - gameTop, SCREEN_HEIGHT);
+
+    if (top < bottom) {
+        tte_erase_rect(0, top, SCREEN_WIDTH, bottom);
+    }
+}
+
+static const u8 *unpackAtlas(const unsigned char *packed, int compression, int rawSize)
+{
+    u8 *mask;
+
+    if (packed == NULL || compression == 0) {
+        return packed;
+    }
+
+    mask = memstatsAlloc(rawSize, "a number atlas");
+    if (!mask) {
+        // out of memory, the numbers just won't be drawn
+        return NULL;
+    }
+
+    if (compression == 0x10) {
+        LZ77UnCompWram(packed, mask);
+    } else {
+        RLUnCompWram(packed, mask);
+    }
+
+    return mask;
+}
+
+// The atlases are unpacked into EWRAM.
+void displayLoadFont(int font)
+{
+    struct NumberFont *f = &numberFonts[font];
+
+    if (f->mask) {
+        return;
+    }
+
+    f->mask = unpackAtlas(f->packed, f->compression, f->rawSize);
+    f->maskUd = unpackAtlas(f->packedUd, f->compression, f->rawSize);
+}
+
+int displayFontWidth(int font)
+{
+    return numberFonts[font].width;
+}
+
+int displayFontHeight(int font)
+{
+    return numberFonts[font].height;
+}
+
+// Upside down glyphs come from the pre-rotated atlas, placed where
+// sbmp16_blit_ud and sbmp16_rect_ud put them.
+void displayNumberGlyph(int font, int offset_x, int offset_y, int slot, int glyph, uint16_t color, int ud)
+{
+    struct NumberFont *f = &numberFonts[font];
+    TSurface *dst = tte_get_surface();
+    int x = offset_x + f->width * slot;
+
+    offset_y -= drawTop();
+    if (offset_y < 0 || offset_y + f->height > SCREEN_HEIGHT) {
+        return;
+    }
+
+    if (ud) {
+        sbmp16_blit_mask(dst, SCREEN_WIDTH - x - 1, SCREEN_HEIGHT - offset_y - 1 - f->height, f->width, f->height, f->maskUd, f->pitch, glyph * f->width, 0, color, CLR_BLACK);
+    } else {
+        sbmp16_blit_mask(dst, x, offset_y, f->width, f->height, f->mask, f->pitch, glyph * f->width, 0, color, CLR_BLACK);
+    }
+}
+
+void displayClearNumberGlyph(int font, int offset_x, int offset_y, int slot, int ud)
+{
+    struct NumberFont *f = &numberFonts[font];
+    TSurface *dst = tte_get_surface();
+    int x = offset_x + f->width * slot;
+
+    offset_y -= drawTop();
+    if (offset_y < 0 || offset_y + f->height > SCREEN_HEIGHT) {
+        return;
+    }
+
+    if (ud) {
+        sbmp16_rect_ud(dst, x, offset_y, x + f->width, offset_y + f->height, CLR_BLACK);
+    } else {
+        sbmp16_rect(dst, x, offset_y, x + f->width, offset_y + f->height, CLR_BLACK);
+    }
+}
+
+int displayNumberGlyphPixel(int font, int glyph, int x, int y)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int sx = glyph * f->width + x;
+
+    if (!f->mask) {
+        return 0;
+    }
+
+    return (f->mask[y * f->pitch + sx / 8] >> (sx & 7)) & 1;
+}
+
+// upside down from the rotated atlas where displayNumberGlyph puts it
+void displayNumberPixel(int font, int offset_x, int offset_y, int slot, int ud, int x, int y, int *screenX, int *screenY)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int left = offset_x + f->width * slot;
+
+    offset_y -= gameTop;
+    if (ud) {
+        *screenX = SCREEN_WIDTH - left - 1 + f->width - 1 - x;
+        *screenY = SCREEN_HEIGHT - offset_y - 1 - f->height + f->height - 1 - y;
+    } else {
+        *screenX = left + x;
+        *screenY = offset_y + y;
+    }
+}
+
+int displayHasPlayerInks(void)
+{
+    return 0;
+}
+
+void displaySetPlayerInk(int player, uint16_t color)
+{
+}
+
+void displayUsePlayerInk(int player)
+{
+}
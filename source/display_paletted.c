@@ -0,0 +1,373 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <tonc.h>
+#include <tonc_video.h>
+
+#include "display.h"
+#include "memstats.h"
+#include "tonc_ext.h"
+#include "VCR_OSD_MONO_NUMBERS_HUGE.h"
+#include "VCR_OSD_MONO_NUMBERS_LARGE.h"
+#include "VCR_OSD_MONO_NUMBERS_MEDIUM.h"
+#include "VCR_OSD_MONO_NUMBERS_SMALL.h"
+
+// The first mode 4 page, a byte per pixel that picks a color from the
+// background palette. Index 0 is the black of the cleared screen, the colors
+// that are drawn get the indices from 1 on as they come, and the top of the
+// palette is an ink for every player: a player's number is drawn in it, so
+// whatever it looks like is only the color of that ink.
+#define PLAYER_INKS 16
+#define FIRST_PLAYER_INK (256 - PLAYER_INKS)
+
+#define MAX_TEXT_LEN 256
+
+// The same 1bpp digit atlases as the bitmap display, see display_bitmap.c.
+struct NumberFont {
+    const unsigned char *packed;
+    const unsigned char *packedUd;
+    int compression;
+    int rawSize;
+    int width;
+    int height;
+    int pitch;
+    const u8 *mask;
+    const u8 *maskUd;
+};
+
+static struct NumberFont numberFonts[] = {
+    [DISPLAY_FONT_HUGE] = {
+        VCR_OSD_MONO_NUMBERS_HUGE,
+        NULL,
+        VCR_OSD_MONO_NUMBERS_HUGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_HUGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_HUGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_HUGE_PITCH,
+    },
+    [DISPLAY_FONT_LARGE] = {
+        VCR_OSD_MONO_NUMBERS_LARGE,
+        VCR_OSD_MONO_NUMBERS_LARGE_UD,
+        VCR_OSD_MONO_NUMBERS_LARGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_LARGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_LARGE_PITCH,
+    },
+    [DISPLAY_FONT_MEDIUM] = {
+        VCR_OSD_MONO_NUMBERS_MEDIUM,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_UD,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_WIDTH,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_PITCH,
+    },
+    [DISPLAY_FONT_SMALL] = {
+        VCR_OSD_MONO_NUMBERS_SMALL,
+        NULL,
+        VCR_OSD_MONO_NUMBERS_SMALL_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_SMALL_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_SMALL_WIDTH,
+        VCR_OSD_MONO_NUMBERS_SMALL_HEIGHT,
+        VCR_OSD_MONO_NUMBERS_SMALL_PITCH,
+    },
+};
+
+static u16 indexColors[FIRST_PLAYER_INK];
+static int indices = 1;
+static int inkPlayer = -1;
+
+// Should the colors ever run out the last index is taken over.
+static u8 paletteIndex(u16 color)
+{
+    if (color == CLR_BLACK) {
+        return 0;
+    }
+
+    for (int i = 1; i < indices; i++) {
+        if (indexColors[i] == color) {
+            return i;
+        }
+    }
+
+    if (indices < FIRST_PLAYER_INK) {
+        indices++;
+    }
+    indexColors[indices - 1] = color;
+    pal_bg_mem[indices - 1] = color;
+
+    return indices - 1;
+}
+
+// Only the part of the game that's on the screen is on the page, like the
+// bitmap display.
+static int layer = DISPLAY_LAYER_SCREEN;
+static int gameTop = 0;
+
+int displayHasLayers(void)
+{
+    return 0;
+}
+
+// still picks whether what's drawn is scrolled
+void displaySetLayer(int l)
+{
+    layer = l;
+}
+
+// there is only the one layer, that's clearing the screen
+void displayClearLayer(int layer)
+{
+    displayClear();
+}
+
+void displayShowGame(int show)
+{
+}
+
+int displayGameHeight(void)
+{
+    return SCREEN_HEIGHT;
+}
+
+void displayScrollGame(int top)
+{
+    gameTop = top;
+}
+
+// how far up what's drawn now goes
+static int drawTop(void)
+{
+    return layer == DISPLAY_LAYER_SCREEN ? 0 : gameTop;
+}
+
+void displayInit(void)
+{
+    tte_init_bmp(4, &sys8Font, NULL);
+    pal_bg_mem[0] = CLR_BLACK;
+    // the ink mode 3 starts with
+    displaySetInk(CLR_YELLOW);
+    tte_set_color(TTE_PAPER, 0);
+    displayClear();
+    REG_DISPCNT = DCNT_MODE4 | DCNT_BG2 | DCNT_OBJ | DCNT_OBJ_1D;
+}
+
+int displayGlyphWidth(void)
+{
+    return tte_get_glyph_width(0);
+}
+
+int displayGlyphHeight(void)
+{
+    return tte_get_glyph_height(0);
+}
+
+void displaySetInk(uint16_t color)
+{
+    tte_set_color(TTE_INK, paletteIndex(color));
+}
+
+// TTE takes the ink of a color command as it is, which here is a palette
+// index: #{ci:32767} becomes #{ci:1} or whichever index white has.
+static void colorsToIndices(char *dst, int size, const char *src)
+{
+    int len = 0;
+    int command = 0;
+
+    while (*src && len < size - 1) {
+        if (src[0] == '\\' && src[1] == '#' && !command) {
+            dst[len++] = *src++;
+        } else if (src[0] == '#' && src[1] == '{') {
+            command = 1;
+        } else if (src[0] == '}') {
+            command = 0;
+        } else if (command && src[0] == 'c' && src[1] == 'i' && src[2] == ':') {
+            char *end;
+            u8 index = paletteIndex(strtol(src + 3, &end, 0));
+
+            len += snprintf(dst + len, size - len, "ci:%d", index);
+            src = end;
+            continue;
+        }
+
+        if (len < size - 1) {
+            dst[len++] = *src++;
+        }
+    }
+
+    dst[min(len, size - 1)] = 0;
+}
+
+void displayWriteText(int row, int column, int fillcolumn, int ud, const char *buf)
+{
+    TTC *tc = tte_get_context();
+    int gh = tte_get_glyph_height(0);
+    int h = row * gh - drawTop();
+    char text[MAX_TEXT_LEN];
+
+    // a row that is scrolled off is nowhere
+    if (h < 0 || h + gh > SCREEN_HEIGHT) {
+        return;
+    }
+
+    colorsToIndices(text, sizeof(text), buf);
+    sbmp8_rect(&tc->dst, column, h, column + fillcolumn, h + gh, tc->cattr[TTE_PAPER]);
+
+    if (ud) {
+        tte_set_pos(column, h + gh);
+        tte_write_ud(text);
+    } else {
+        tte_set_pos(column, h);
+        tte_write(text);
+    }
+}
+
+void displayClear(void)
+{
+    sbmp8_rect(tte_get_surface(), 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+}
+
+void displayClearRows(int top, int bottom)
+{
+    top = max(top - gameTop, 0);
+    bottom = min(bottom - gameTop, SCREEN_HEIGHT);
+
+    if (top < bottom) {
+        sbmp8_rect(tte_get_surface(), 0, top, SCREEN_WIDTH, bottom, 0);
+    }
+}
+
+static const u8 *unpackAtlas(const unsigned char *packed, int compression, int rawSize)
+{
+    u8 *mask;
+
+    if (packed == NULL || compression == 0) {
+        return packed;
+    }
+
+    mask = memstatsAlloc(rawSize, "a number atlas");
+    if (!mask) {
+        // out of memory, the numbers just won't be drawn
+        return NULL;
+    }
+
+    if (compression == 0x10) {
+        LZ77UnCompWram(packed, mask);
+    } else {
+        RLUnCompWram(packed, mask);
+    }
+
+    return mask;
+}
+
+// The atlases are unpacked into EWRAM.
+void displayLoadFont(int font)
+{
+    struct NumberFont *f = &numberFonts[font];
+
+    if (f->mask) {
+        return;
+    }
+
+    f->mask = unpackAtlas(f->packed, f->compression, f->rawSize);
+    f->maskUd = unpackAtlas(f->packedUd, f->compression, f->rawSize);
+}
+
+int displayFontWidth(int font)
+{
+    return numberFonts[font].width;
+}
+
+int displayFontHeight(int font)
+{
+    return numberFonts[font].height;
+}
+
+// Placed like the bitmap display places them, see display_bitmap.c.
+void displayNumberGlyph(int font, int offset_x, int offset_y, int slot, int glyph, uint16_t color, int ud)
+{
+    struct NumberFont *f = &numberFonts[font];
+    TSurface *dst = tte_get_surface();
+    int x = offset_x + f->width * slot;
+    u8 ink = inkPlayer >= 0 ? FIRST_PLAYER_INK + inkPlayer : paletteIndex(color);
+
+    offset_y -= drawTop();
+    if (offset_y < 0 || offset_y + f->height > SCREEN_HEIGHT) {
+        return;
+    }
+
+    if (ud) {
+        sbmp8_blit_mask(dst, SCREEN_WIDTH - x - 1, SCREEN_HEIGHT - offset_y - 1 - f->height, f->width, f->height, f->maskUd, f->pitch, glyph * f->width, 0, ink, 0);
+    } else {
+        sbmp8_blit_mask(dst, x, offset_y, f->width, f->height, f->mask, f->pitch, glyph * f->width, 0, ink, 0);
+    }
+}
+
+// upside down the same pixels as sbmp16_rect_ud
+void displayClearNumberGlyph(int font, int offset_x, int offset_y, int slot, int ud)
+{
+    struct NumberFont *f = &numberFonts[font];
+    TSurface *dst = tte_get_surface();
+    int x = offset_x + f->width * slot;
+
+    offset_y -= drawTop();
+    if (offset_y < 0 || offset_y + f->height > SCREEN_HEIGHT) {
+        return;
+    }
+
+    if (ud) {
+        sbmp8_rect(dst, SCREEN_WIDTH - x - 1, SCREEN_HEIGHT - offset_y - 1 - f->height, SCREEN_WIDTH - x - 1 + f->width, SCREEN_HEIGHT - offset_y - 1, 0);
+    } else {
+        sbmp8_rect(dst, x, offset_y, x + f->width, offset_y + f->height, 0);
+    }
+}
+
+int displayNumberGlyphPixel(int font, int glyph, int x, int y)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int sx = glyph * f->width + x;
+
+    if (!f->mask) {
+        return 0;
+    }
+
+    return (f->mask[y * f->pitch + sx / 8] >> (sx & 7)) & 1;
+}
+
+// upside down from the rotated atlas where displayNumberGlyph puts it
+void displayNumberPixel(int font, int offset_x, int offset_y, int slot, int ud, int x, int y, int *screenX, int *screenY)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int left = offset_x + f->width * slot;
+
+    offset_y -= gameTop;
+    if (ud) {
+        *screenX = SCREEN_WIDTH - left - 1 + f->width - 1 - x;
+        *screenY = SCREEN_HEIGHT - offset_y - 1 - f->height + f->height - 1 - y;
+    } else {
+        *screenX = left + x;
+        *screenY = offset_y + y;
+    }
+}
+
+int displayHasPlayerInks(void)
+{
+    return 1;
+}
+
+void displaySetPlayerInk(int player, uint16_t color)
+{
+    if (player >= 0 && player < PLAYER_INKS) {
+        pal_bg_mem[FIRST_PLAYER_INK + player] = color;
+    }
+}
+
+// players past the inks are drawn in their colors
+void displayUsePlayerInk(int player)
+{
+    inkPlayer = player < PLAYER_INKS ? player : -1;
+}
@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdlib.h>
+
+#include <tonc.h>
+#include <tonc_video.h>
+
+#include "display.h"
+#include "VCR_OSD_MONO_NUMBERS_HUGE.h"
+#include "VCR_OSD_MONO_NUMBERS_LARGE.h"
+#include "VCR_OSD_MONO_NUMBERS_MEDIUM.h"
+#include "VCR_OSD_MONO_NUMBERS_SMALL.h"
+
+// Mode 0 with each layer on the regular 32x64 background of the same number,
+// BG0 is drawn on top. All of them share the 4bpp tiles of charblock 0: the
+// text font first, one tile per character from the space on, then the tiles
+// of the digit atlases. A layer takes two screenblocks, the last six of VRAM.
+// The game layers are taller than the screen, the rows that are shown are
+// picked with their vertical scroll alone.
+#define LAYER_SBB 26
+#define LAYER_SBBS 2
+#define MAP_WIDTH 32
+#define MAP_ROWS 64
+#define TEXT_COLUMNS (SCREEN_WIDTH / 8)
+
+#define FONT_FIRST_CHAR 32
+#define FONT_CHARS 96
+// the space, which is also what a cleared map points at
+#define BLANK_TILE 0
+#define LARGE_FIRST_TILE FONT_CHARS
+#define HUGE_FIRST_TILE (LARGE_FIRST_TILE + VCR_OSD_MONO_NUMBERS_LARGE_TILES)
+#define MEDIUM_FIRST_TILE (HUGE_FIRST_TILE + VCR_OSD_MONO_NUMBERS_HUGE_TILES)
+#define SMALL_FIRST_TILE (MEDIUM_FIRST_TILE + VCR_OSD_MONO_NUMBERS_MEDIUM_TILES)
+
+// Every color that is drawn gets a palette bank of its own, ink is index 1
+// of it. There are more banks than colors in text.h, should they ever run
+// out the last one is taken over.
+#define PALETTE_BANKS 16
+
+// The digit atlases are generated from font/VCR_OSD_MONO.ttf by tools/atlasc
+// at build time as deduplicated tiles, kept compressed in ROM, and a screen
+// entry per tile of every glyph. They are unpacked into VRAM on first use.
+struct NumberFont {
+    const unsigned char *packed;
+    const unsigned short *map;
+    int compression;
+    int rawSize;
+    int width;
+    int height;
+    int firstTile;
+    int loaded;
+};
+
+static struct NumberFont numberFonts[] = {
+    [DISPLAY_FONT_HUGE] = {
+        VCR_OSD_MONO_NUMBERS_HUGE,
+        VCR_OSD_MONO_NUMBERS_HUGE_MAP,
+        VCR_OSD_MONO_NUMBERS_HUGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_HUGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_HUGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT,
+        HUGE_FIRST_TILE,
+    },
+    [DISPLAY_FONT_LARGE] = {
+        VCR_OSD_MONO_NUMBERS_LARGE,
+        VCR_OSD_MONO_NUMBERS_LARGE_MAP,
+        VCR_OSD_MONO_NUMBERS_LARGE_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_LARGE_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH,
+        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
+        LARGE_FIRST_TILE,
+    },
+    [DISPLAY_FONT_MEDIUM] = {
+        VCR_OSD_MONO_NUMBERS_MEDIUM,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_MAP,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_WIDTH,
+        VCR_OSD_MONO_NUMBERS_MEDIUM_HEIGHT,
+        MEDIUM_FIRST_TILE,
+    },
+    [DISPLAY_FONT_SMALL] = {
+        VCR_OSD_MONO_NUMBERS_SMALL,
+        VCR_OSD_MONO_NUMBERS_SMALL_MAP,
+        VCR_OSD_MONO_NUMBERS_SMALL_COMPRESSION,
+        VCR_OSD_MONO_NUMBERS_SMALL_RAW_SIZE,
+        VCR_OSD_MONO_NUMBERS_SMALL_WIDTH,
+        VCR_OSD_MONO_NUMBERS_SMALL_HEIGHT,
+        SMALL_FIRST_TILE,
+    },
+};
+
+static int layer = DISPLAY_LAYER_SCREEN;
+static int gameTop = 0;
+static u16 inkBank = 0;
+static u16 bankColors[PALETTE_BANKS];
+static int banks = 0;
+
+static SCR_ENTRY *layerMap(int l)
+{
+    return se_mem[LAYER_SBB + l * LAYER_SBBS];
+}
+
+static u16 paletteBank(u16 color)
+{
+    for (int i = 0; i < banks; i++) {
+        if (bankColors[i] == color) {
+            return SE_PALBANK(i);
+        }
+    }
+
+    if (banks < PALETTE_BANKS) {
+        banks++;
+    }
+    bankColors[banks - 1] = color;
+    pal_bg_mem[(banks - 1) * 16 + 1] = color;
+
+    return SE_PALBANK(banks - 1);
+}
+
+int displayHasLayers(void)
+{
+    return 1;
+}
+
+void displaySetLayer(int l)
+{
+    layer = l;
+}
+
+void displayClearLayer(int l)
+{
+    memset32(layerMap(l), BLANK_TILE, LAYER_SBBS * sizeof(SCREENBLOCK) / 4);
+}
+
+// BG0 is the screen layer, the game is on the ones after it
+void displayShowGame(int show)
+{
+    u16 game = 0;
+
+    for (int l = DISPLAY_LAYER_SCREEN + 1; l < DISPLAY_LAYERS; l++) {
+        game |= DCNT_BG0 << l;
+    }
+    REG_DISPCNT = DCNT_MODE0 | DCNT_BG0 | DCNT_OBJ | DCNT_OBJ_1D | (show ? game : 0);
+}
+
+int displayGameHeight(void)
+{
+    return MAP_ROWS * 8;
+}
+
+void displayScrollGame(int top)
+{
+    gameTop = top;
+    for (int l = DISPLAY_LAYER_SCREEN + 1; l < DISPLAY_LAYERS; l++) {
+        REG_BG_OFS[l].y = top;
+    }
+}
+
+// The 1bpp font becomes 4bpp tiles, ink is index 1.
+static void loadTextFont(void)
+{
+    const TFont *font = &sys8Font;
+    u32 *dst = tile_mem[0][BLANK_TILE].data;
+
+    for (int ch = 0; ch < FONT_CHARS; ch++) {
+        const u8 *glyph = (const u8 *) font->data + ch * font->cellSize;
+
+        for (int y = 0; y < 8; y++) {
+            u32 row = 0;
+
+            for (int x = 0; x < 8; x++) {
+                row |= ((glyph[y] >> x) & 1) << (x * 4);
+            }
+            *dst++ = row;
+        }
+    }
+}
+
+void displayInit(void)
+{
+    for (int l = 0; l < DISPLAY_LAYERS; l++) {
+        REG_BGCNT[l] = BG_CBB(0) | BG_SBB(LAYER_SBB + l * LAYER_SBBS) | BG_4BPP | BG_REG_32x64 | BG_PRIO(0);
+        REG_BG_OFS[l].x = 0;
+        REG_BG_OFS[l].y = 0;
+    }
+
+    pal_bg_mem[0] = CLR_BLACK;
+    inkBank = paletteBank(CLR_WHITE);
+    loadTextFont();
+    displayClear();
+    displayShowGame(0);
+}
+
+int displayGlyphWidth(void)
+{
+    return sys8Font.charW;
+}
+
+int displayGlyphHeight(void)
+{
+    return sys8Font.charH;
+}
+
+void displaySetInk(uint16_t color)
+{
+    inkBank = paletteBank(color);
+}
+
+// A character is a screen entry, upside down the same tile flipped both ways.
+// Text that runs past the right edge is cut off instead of wrapped.
+void displayWriteText(int row, int column, int fillcolumn, int ud, const char *buf)
+{
+    SCR_ENTRY *line;
+    u16 flip = ud ? SE_HFLIP | SE_VFLIP : 0;
+    int c = column / 8;
+    int end = min((column + fillcolumn) / 8, TEXT_COLUMNS);
+
+    if (row < 0 || row >= MAP_ROWS) {
+        return;
+    }
+
+    line = layerMap(layer) + row * MAP_WIDTH;
+    for (int i = c; i < end; i++) {
+        line[i] = BLANK_TILE;
+    }
+
+    for (const char *p = buf; *p; p++) {
+        uint ch = (u8) *p;
+
+        // only the ink of the color commands counts, like #{ci:32767}
+        if (ch == '#' && p[1] == '{') {
+            for (p += 2; *p && *p != '}'; p++) {
+                if (p[0] == 'c' && p[1] == 'i' && p[2] == ':') {
+                    displaySetInk(strtol(p + 3, NULL, 0));
+                }
+            }
+            if (!*p) {
+                break;
+            }
+            continue;
+        }
+
+        if (ch == '\\' && p[1] == '#') {
+            ch = (u8) *++p;
+        }
+
+        if (c < TEXT_COLUMNS && ch >= FONT_FIRST_CHAR && ch < FONT_FIRST_CHAR + FONT_CHARS) {
+            line[c] = (ch - FONT_FIRST_CHAR) | inkBank | flip;
+        }
+        c++;
+    }
+}
+
+void displayClear(void)
+{
+    for (int l = 0; l < DISPLAY_LAYERS; l++) {
+        displayClearLayer(l);
+    }
+}
+
+// whole rows of tiles, the bands the game clears are on tile boundaries
+void displayClearRows(int top, int bottom)
+{
+    int first = top / 8;
+    int end = min((bottom + 7) / 8, MAP_ROWS);
+
+    for (int l = DISPLAY_LAYER_SCREEN + 1; l < DISPLAY_LAYERS; l++) {
+        memset32(layerMap(l) + first * MAP_WIDTH, BLANK_TILE, (end - first) * MAP_WIDTH / 2);
+    }
+}
+
+void displayLoadFont(int font)
+{
+    struct NumberFont *f = &numberFonts[font];
+    void *dst = &tile_mem[0][f->firstTile];
+
+    if (f->loaded) {
+        return;
+    }
+
+    if (f->compression == 0x10) {
+        LZ77UnCompVram(f->packed, dst);
+    } else if (f->compression == 0x30) {
+        RLUnCompVram(f->packed, dst);
+    } else {
+        memcpy32(dst, f->packed, f->rawSize / 4);
+    }
+    f->loaded = 1;
+}
+
+int displayFontWidth(int font)
+{
+    return numberFonts[font].width;
+}
+
+int displayFontHeight(int font)
+{
+    return numberFonts[font].height;
+}
+
+// Glyphs take whole tiles side by side. Upside down the number is placed
+// where the bitmap display rotates it to, with the tiles in reverse order
+// and flipped.
+static void numberCells(struct NumberFont *f, int offset_x, int offset_y, int slot, int ud, int *column, int *row)
+{
+    int columns = (f->width + 7) / 8;
+
+    if (ud) {
+        *column = (SCREEN_WIDTH - offset_x - 1) / 8 - slot * columns;
+        *row = (SCREEN_HEIGHT - offset_y - 1 - f->height) / 8;
+    } else {
+        *column = offset_x / 8 + slot * columns;
+        *row = offset_y / 8;
+    }
+}
+
+static void putNumberGlyph(int font, int offset_x, int offset_y, int slot, int glyph, u16 bank, int ud)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int columns = (f->width + 7) / 8;
+    int rows = (f->height + 7) / 8;
+    const unsigned short *map = f->map + glyph * columns * rows;
+    SCR_ENTRY *dst = layerMap(layer);
+    int column, row;
+
+    numberCells(f, offset_x, offset_y, slot, ud, &column, &row);
+
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < columns; x++) {
+            int cx = ud ? column + columns - 1 - x : column + x;
+            int cy = ud ? row + rows - 1 - y : row + y;
+            SCR_ENTRY se = BLANK_TILE;
+
+            if (cx < 0 || cx >= MAP_WIDTH || cy < 0 || cy >= MAP_ROWS) {
+                continue;
+            }
+
+            if (glyph >= 0) {
+                se = (map[y * columns + x] + f->firstTile) | bank;
+                if (ud) {
+                    se ^= SE_HFLIP | SE_VFLIP;
+                }
+            }
+            dst[cy * MAP_WIDTH + cx] = se;
+        }
+    }
+}
+
+void displayNumberGlyph(int font, int offset_x, int offset_y, int slot, int glyph, uint16_t color, int ud)
+{
+    putNumberGlyph(font, offset_x, offset_y, slot, glyph, paletteBank(color), ud);
+}
+
+void displayClearNumberGlyph(int font, int offset_x, int offset_y, int slot, int ud)
+{
+    putNumberGlyph(font, offset_x, offset_y, slot, -1, 0, ud);
+}
+
+// through the glyph's map entry, from the tile in VRAM
+int displayNumberGlyphPixel(int font, int glyph, int x, int y)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int columns = (f->width + 7) / 8;
+    int rows = (f->height + 7) / 8;
+    SCR_ENTRY se;
+    const u8 *tile;
+    int tx, ty;
+
+    if (!f->loaded) {
+        return 0;
+    }
+
+    se = f->map[glyph * columns * rows + (y / 8) * columns + x / 8];
+    tile = (const u8 *) &tile_mem[0][f->firstTile + (se & SE_ID_MASK)];
+    tx = se & SE_HFLIP ? 7 - x % 8 : x % 8;
+    ty = se & SE_VFLIP ? 7 - y % 8 : y % 8;
+
+    return (tile[ty * 4 + tx / 2] >> (tx & 1) * 4) & 0xf;
+}
+
+// upside down the whole tiles of the glyph are turned around
+void displayNumberPixel(int font, int offset_x, int offset_y, int slot, int ud, int x, int y, int *screenX, int *screenY)
+{
+    struct NumberFont *f = &numberFonts[font];
+    int column, row;
+
+    numberCells(f, offset_x, offset_y, slot, ud, &column, &row);
+
+    if (ud) {
+        *screenX = column * 8 + (f->width + 7) / 8 * 8 - 1 - x;
+        *screenY = row * 8 + (f->height + 7) / 8 * 8 - 1 - y - gameTop;
+    } else {
+        *screenX = column * 8 + x;
+        *screenY = row * 8 + y - gameTop;
+    }
+}
+
+int displayHasPlayerInks(void)
+{
+    return 0;
+}
+
+void displaySetPlayerInk(int player, uint16_t color)
+{
+}
+
+void displayUsePlayerInk(int player)
+{
+}
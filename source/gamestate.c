@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdint.h>
+#include <string.h>
+
+#include "counters.h"
+#include "gamestate.h"
+#include "history.h"
+#include "placement.h"
+#include "profile.h"
+#include "save.h"
+
+static int addClamped(int value, int delta, int min, int max)
+{
+    if (value + delta < min) {
+        return min - value;
+    }
+    if (value + delta > max) {
+        return max - value;
+    }
+
+    return delta;
+}
+
+int playerAddLife(struct Players *players, int player, int delta)
+{
+    delta = addClamped(players->life[player], delta, INT16_MIN, INT16_MAX);
+    players->life[player] += delta;
+
+    return delta;
+}
+
+int playerAddCounter(struct Players *players, int player, int counter, int delta)
+{
+    uint8_t *value = &players->counters[counter][player];
+
+    delta = addClamped(*value, delta, counterType(counter)->min, counterType(counter)->max);
+    *value += delta;
+
+    return delta;
+}
+
+int playerAddCommanderDamage(struct Players *players, int player, int opponent, int delta)
+{
+    uint8_t *value = &players->commanderDamage[player * MAX_OPPONENTS + opponent];
+
+    delta = addClamped(*value, delta, 0, UINT8_MAX);
+    *value += delta;
+
+    return delta;
+}
+
+int playersLifeOutside(const struct Players *players, int count, int min, int max)
+{
+    int outside = 0;
+
+    for (int i = 0; i < count; i++) {
+        outside |= players->life[i] < min || players->life[i] > max;
+    }
+
+    return outside;
+}
+
+void initializeStartingLifeAndCounters(struct GameState *state)
+{
+    memset(&state->players, 0, sizeof(state->players));
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        state->players.life[i] = state->startingLife;
+    }
+    for (int i = 0; i < COUNTERS; i++) {
+        memset(state->players.counters[i], counterTypes[i].min, MAX_PLAYERS);
+    }
+
+    state->eliminatedPlayers = 0;
+    // the row it was on may be shorter in this game
+    state->selectedCommanderDamageOrCounter = 0;
+
+    historyReset(state);
+}
+
+void initializeGameState(struct GameState *state)
+{
+    state->format = GAME_STATE_FORMAT;
+    state->state = STATE_SETUP;
+    state->previousState = -1;
+    state->stateToReturnTo = -1;
+
+    state->keysDown = 0;
+    state->framesSinceUPPressedOrQuarterSecond = 0;
+    state->framesSinceDOWNPressedOrQuarterSecond = 0;
+    state->selectedPlayer = 0;
+    state->selectedMenuItem = 0;
+    state->selectedSetupItem = 0;
+    // state->selectedBackgroundSong = 0;
+    state->sfxEnabled = 1;
+    state->selectedCommanderDamageOrCounter = 0;
+    state->triggerAutoSaveInFrames = 0;
+    state->printedRegular = 0;
+    state->lifeChangedCurrent = 0;
+    state->triggerClearLifeChangedCurrentInFrames = 0;
+
+    state->upsideDownNumbers = 0;
+
+    state->maxPlayers = 4;
+    state->maxOpponents = 1;
+    state->startingLife = 40;
+
+    initializeStartingLifeAndCounters(state);
+}
+
+void resetNonPersistentGameStateValues(struct GameState *state)
+{
+    state->state = STATE_COUNTLIFE;
+    state->previousState = -1;
+    state->stateToReturnTo = -1;
+
+    state->keysDown = 0;
+    state->framesSinceUPPressedOrQuarterSecond = 0;
+    state->framesSinceDOWNPressedOrQuarterSecond = 0;
+    state->selectedPlayer = 0;
+    state->selectedCommanderDamageOrCounter = 0;
+    state->selectedMenuItem = 0;
+    state->selectedSetupItem = 0;
+    // state->selectedBackgroundSong = 0;
+    state->triggerAutoSaveInFrames = 0;
+    state->printedRegular = 0;
+    state->lifeChangedCurrent = 0;
+    state->triggerClearLifeChangedCurrentInFrames = 0;
+}
+
+// the autosave carries the undo history after the game state
+EWRAM_BSS static uint8_t saveBuffer[sizeof(struct SaveableGameState) + HISTORY_MAX_SERIALIZED_SIZE];
+
+_Static_assert(sizeof(saveBuffer) <= SAVE_CAPACITY(SAVE_AUTO_RECORD_SIZE),
+               "the game state and a full history don't fit an autosave record, see save.h");
+_Static_assert(sizeof(struct SaveableGameState) <= SAVE_CAPACITY(SAVE_MANUAL_RECORD_SIZE),
+               "the game state doesn't fit a manual save record, see save.h");
+
+void saveState(struct GameState *state, int slot)
+{
+    uint32_t len = sizeof(struct SaveableGameState);
+    uint32_t start = profileCycles();
+
+    memcpy(saveBuffer, state, len);
+    if (slot == SAVE_SLOT_AUTO) {
+        len += historySerialize(saveBuffer + len, sizeof(saveBuffer) - len);
+    }
+
+    saveSlotWrite(slot, saveBuffer, len);
+
+    profileScopeAdd(PROFILE_SCOPE_SAVE, profileCycles() - start);
+}
+
+int loadState(struct GameState *state, int slot)
+{
+    uint32_t len = saveSlotRead(slot, saveBuffer, sizeof(saveBuffer));
+
+    if (len >= sizeof(struct SaveableGameState) &&
+        ((struct SaveableGameState *) saveBuffer)->format == GAME_STATE_FORMAT) {
+        memcpy(state, saveBuffer, sizeof(struct SaveableGameState));
+        resetNonPersistentGameStateValues(state);
+
+        if (len > sizeof(struct SaveableGameState)) {
+            historyDeserialize(state, saveBuffer + sizeof(struct SaveableGameState), len - sizeof(struct SaveableGameState));
+        } else {
+            historyReset(state);
+        }
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef GAMESTATE_H__
+#define GAMESTATE_H__
+
+#include <stdint.h>
+
+// Big casual pods, the seats that don't fit the screen are scrolled to. The
+// archive packs a player into 4 bits, so at most 15.
+#define MAX_PLAYERS 12
+// Commander damage is kept from every other seat, a seat's row shows a page
+// of it at a time (see COMMANDER_DAMAGE_SHOWN).
+#define MAX_OPPONENTS (MAX_PLAYERS - 1)
+
+#define MAX_COMMANDER_DAMAGE 21
+#define MAX_POISON_COUNTERS 10
+
+// What a counter is and how it's shown is in counterTypes (counters.c), in
+// the same order.
+enum COUNTER {
+    POISON_COUNTER = 0,
+    ENERGY_COUNTER,
+    EXPERIENCE_COUNTER,
+    COMMANDERTAX_COUNTER,
+    COUNTERS,
+};
+
+#define FIRST_COUNTER POISON_COUNTER
+#define LAST_COUNTER (COUNTERS - 1)
+
+enum {
+    STATE_SETUP = 0,
+    STATE_COUNTLIFE = 1,
+    STATE_MENU = 2,
+    STATE_CONTROLS = 3,
+    STATE_STATS = 4,
+    STATE_MEMORY = 5,
+};
+
+// The players of the running game, one array per value so that going over
+// all players reads a few contiguous bytes. Only the first maxPlayers entries
+// are used. Use the player* functions below, they keep the values in range.
+struct Players {
+    int16_t life[MAX_PLAYERS];
+    // counters[counter][player]
+    uint8_t counters[COUNTERS][MAX_PLAYERS];
+    // The damage a player took from each opponent's commander, a row of
+    // MAX_OPPONENTS per player of which maxOpponents are used. Opponents are
+    // counted from 0 without the player itself.
+    uint8_t commanderDamage[MAX_PLAYERS * MAX_OPPONENTS];
+};
+
+// the first word of a save, saves from before struct Players start with
+// maxPlayers instead
+#define GAME_STATE_FORMAT 0x47530004
+
+#define SAVEABLE_GAME_STATE \
+    uint32_t format; \
+    int maxPlayers; \
+    int maxOpponents; \
+    int startingLife; \
+    int upsideDownNumbers; \
+    int selectedBackgroundSong; \
+    int sfxEnabled; \
+    struct Players players; \
+    int eliminationOrder[MAX_PLAYERS]; \
+    int eliminatedPlayers;
+
+struct SaveableGameState {
+    SAVEABLE_GAME_STATE;
+};
+
+struct GameState {
+    SAVEABLE_GAME_STATE;
+    int state;
+    int previousState;
+    int keysDown;
+    int framesSinceUPPressedOrQuarterSecond;
+    int framesSinceDOWNPressedOrQuarterSecond;
+    int selectedPlayer;
+    int selectedMenuItem;
+    int selectedSetupItem;
+    // Where the selection is on the row of a player's commander damage
+    // followed by the counters, see selectedCounter.
+    int selectedCommanderDamageOrCounter;
+    int triggerAutoSaveInFrames;
+    int printedRegular;
+    int lifeChangedCurrent;
+    int triggerClearLifeChangedCurrentInFrames;
+    int stateToReturnTo;
+};
+
+static inline int playerLife(const struct Players *players, int player)
+{
+    return players->life[player];
+}
+
+// counter is one of the *_COUNTER
+static inline int playerCounter(const struct Players *players, int player, int counter)
+{
+    return players->counters[counter][player];
+}
+
+static inline int playerCommanderDamage(const struct Players *players, int player, int opponent)
+{
+    return players->commanderDamage[player * MAX_OPPONENTS + opponent];
+}
+
+// The selected counter, or -1 while it's the commander damage of an opponent.
+static inline int selectedCounter(const struct GameState *state)
+{
+    int counter = state->selectedCommanderDamageOrCounter - state->maxOpponents;
+
+    return counter >= 0 ? FIRST_COUNTER + counter : -1;
+}
+
+// These return the change that was made, less than delta where a value
+// would leave its range (for counters the one in counterTypes).
+int playerAddLife(struct Players *players, int player, int delta);
+int playerAddCounter(struct Players *players, int player, int counter, int delta);
+int playerAddCommanderDamage(struct Players *players, int player, int opponent, int delta);
+// 1 if the life of any of the first count players is below min or above max
+int playersLifeOutside(const struct Players *players, int count, int min, int max);
+
+void initializeStartingLifeAndCounters(struct GameState *state);
+void initializeGameState(struct GameState *state);
+// back to counting life after a game was loaded
+void resetNonPersistentGameStateValues(struct GameState *state);
+// The autosave also keeps the undo history.
+void saveState(struct GameState *state, int slot);
+// 1 if the slot held a game
+int loadState(struct GameState *state, int slot);
+
+#endif
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <string.h>
+
+#include "history.h"
+#include "placement.h"
+
+// Positions are absolute event counts, the ring index is position % size.
+// head: events recorded, cursor: events applied to the current state
+// (less than head after undo), base: oldest position that can be restored.
+// Checkpoint k holds the state after k * HISTORY_CHECKPOINT_INTERVAL events.
+// The rings are only touched when something changes, they live in EWRAM.
+EWRAM_BSS static struct HistoryEvent events[HISTORY_EVENTS];
+EWRAM_BSS static struct HistoryCheckpoint checkpoints[HISTORY_CHECKPOINTS];
+static uint32_t base;
+static uint32_t head;
+static uint32_t cursor;
+
+static void takeCheckpoint(struct HistoryCheckpoint *checkpoint, struct GameState *state)
+{
+    checkpoint->selectedPlayer = state->selectedPlayer;
+    checkpoint->players = state->players;
+}
+
+// Events are only ever replayed forward from a checkpoint.
+static void applyEvent(struct HistoryCheckpoint *s, const struct HistoryEvent *e)
+{
+    int delta = e->delta;
+
+    switch (e->type) {
+        case HISTORY_LIFE:
+            playerAddLife(&s->players, e->player, delta);
+            break;
+        case HISTORY_COMMANDER_DAMAGE:
+            playerAddCommanderDamage(&s->players, e->player, e->index, delta);
+            playerAddLife(&s->players, e->player, -delta);
+            break;
+        case HISTORY_COUNTER:
+            playerAddCounter(&s->players, e->player, e->index, delta);
+            break;
+        case HISTORY_SELECT_PLAYER:
+            s->selectedPlayer = e->index;
+            break;
+    };
+}
+
+static void restore(struct GameState *state, uint32_t target)
+{
+    uint32_t position = target - target % HISTORY_CHECKPOINT_INTERVAL;
+    struct HistoryCheckpoint s = checkpoints[(position / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS];
+
+    for (; position < target; position++) {
+        applyEvent(&s, &events[position % HISTORY_EVENTS]);
+    }
+
+    state->selectedPlayer = s.selectedPlayer;
+    state->players = s.players;
+    cursor = target;
+}
+
+void historyReset(struct GameState *state)
+{
+    base = 0;
+    head = 0;
+    cursor = 0;
+    takeCheckpoint(&checkpoints[0], state);
+}
+
+void historyRecord(struct GameState *state, int type, int player, int index, int delta)
+{
+    struct HistoryEvent *e;
+
+    // a new change after undo drops what could have been redone
+    head = cursor;
+
+    e = &events[head % HISTORY_EVENTS];
+    e->type = type;
+    e->player = player;
+    e->index = index;
+    e->delta = delta;
+
+    cursor = ++head;
+
+    if (head % HISTORY_CHECKPOINT_INTERVAL == 0) {
+        uint32_t checkpoint = head / HISTORY_CHECKPOINT_INTERVAL;
+
+        takeCheckpoint(&checkpoints[checkpoint % HISTORY_CHECKPOINTS], state);
+
+        // that slot held the oldest checkpoint until now
+        if (checkpoint >= HISTORY_CHECKPOINTS) {
+            base = (checkpoint - HISTORY_CHECKPOINTS + 1) * HISTORY_CHECKPOINT_INTERVAL;
+        }
+    }
+}
+
+uint32_t historyEventCount(void)
+{
+    return cursor;
+}
+
+int historyUndo(struct GameState *state)
+{
+    if (cursor <= base) {
+        return 0;
+    }
+
+    restore(state, cursor - 1);
+    return 1;
+}
+
+int historyRedo(struct GameState *state)
+{
+    if (cursor >= head) {
+        return 0;
+    }
+
+    struct HistoryCheckpoint s;
+    takeCheckpoint(&s, state);
+    applyEvent(&s, &events[cursor % HISTORY_EVENTS]);
+    state->selectedPlayer = s.selectedPlayer;
+    state->players = s.players;
+    cursor++;
+
+    return 1;
+}
+
+// Only the oldest checkpoint and the events after it are written, the other
+// checkpoints are rebuilt when loading.
+uint32_t historySerialize(void *buf, uint32_t len)
+{
+    struct HistorySerializedHeader header;
+    uint8_t *out = buf;
+
+    header.base = base;
+    header.head = head;
+    header.cursor = cursor;
+
+    uint32_t count = head - header.base;
+    uint32_t size = sizeof(header) + sizeof(struct HistoryCheckpoint) + count * sizeof(struct HistoryEvent);
+    if (size > len) {
+        return 0;
+    }
+
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    memcpy(out, &checkpoints[(header.base / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS], sizeof(struct HistoryCheckpoint));
+    out += sizeof(struct HistoryCheckpoint);
+    for (uint32_t p = header.base; p < head; p++) {
+        memcpy(out, &events[p % HISTORY_EVENTS], sizeof(struct HistoryEvent));
+        out += sizeof(struct HistoryEvent);
+    }
+
+    return size;
+}
+
+int historyDeserialize(struct GameState *state, const void *buf, uint32_t len)
+{
+    struct HistorySerializedHeader header;
+    struct HistoryCheckpoint s;
+    const uint8_t *in = buf;
+
+    if (len < sizeof(header) + sizeof(s)) {
+        historyReset(state);
+        return 0;
+    }
+
+    memcpy(&header, in, sizeof(header));
+    in += sizeof(header);
+
+    uint32_t count = header.head - header.base;
+    if (header.base % HISTORY_CHECKPOINT_INTERVAL || header.base > header.head || count > HISTORY_EVENTS ||
+        header.cursor < header.base || header.cursor > header.head ||
+        len < sizeof(header) + sizeof(s) + count * sizeof(struct HistoryEvent)) {
+        historyReset(state);
+        return 0;
+    }
+
+    memcpy(&s, in, sizeof(s));
+    in += sizeof(s);
+
+    base = header.base;
+    head = header.base;
+    checkpoints[(head / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS] = s;
+
+    while (head < header.head) {
+        struct HistoryEvent *e = &events[head % HISTORY_EVENTS];
+
+        memcpy(e, in, sizeof(*e));
+        in += sizeof(*e);
+
+        if (e->player >= MAX_PLAYERS || (e->type == HISTORY_COMMANDER_DAMAGE && e->index >= MAX_OPPONENTS) ||
+            (e->type == HISTORY_COUNTER && e->index >= COUNTERS) ||
+            (e->type == HISTORY_SELECT_PLAYER && e->index >= MAX_PLAYERS)) {
+            historyReset(state);
+            return 0;
+        }
+
+        applyEvent(&s, e);
+        head++;
+
+        if (head % HISTORY_CHECKPOINT_INTERVAL == 0) {
+            checkpoints[(head / HISTORY_CHECKPOINT_INTERVAL) % HISTORY_CHECKPOINTS] = s;
+        }
+    }
+
+    cursor = header.cursor;
+
+    return 1;
+}
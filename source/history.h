@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef HISTORY_H__
+#define HISTORY_H__
+
+#include <stdint.h>
+
+#include "gamestate.h"
+
+// Undo/redo history of everything that happens while counting life. Every
+// change is a 4 byte event in a ring buffer, every
+// HISTORY_CHECKPOINT_INTERVAL events a copy of the players is kept so going
+// back any number of steps replays at most that many events.
+
+#define HISTORY_CHECKPOINT_INTERVAL 16
+#define HISTORY_CHECKPOINTS 8
+#define HISTORY_EVENTS (HISTORY_CHECKPOINT_INTERVAL * HISTORY_CHECKPOINTS)
+
+enum HISTORY_EVENT_TYPE {
+    HISTORY_LIFE = 0,
+    HISTORY_COMMANDER_DAMAGE, // index = opponent, life changes by -delta
+    HISTORY_COUNTER, // index = *_COUNTER
+    HISTORY_SELECT_PLAYER, // player = before, index = after
+};
+
+struct HistoryEvent {
+    uint8_t type;
+    uint8_t player;
+    uint8_t index;
+    int8_t delta;
+};
+
+struct HistoryCheckpoint {
+    int selectedPlayer;
+    struct Players players;
+};
+
+struct HistorySerializedHeader {
+    uint32_t base;
+    uint32_t head;
+    uint32_t cursor;
+};
+
+#define HISTORY_MAX_SERIALIZED_SIZE (sizeof(struct HistorySerializedHeader) + \
+                                     sizeof(struct HistoryCheckpoint) + \
+                                     HISTORY_EVENTS * sizeof(struct HistoryEvent))
+
+// forget everything, the current state becomes the oldest one
+void historyReset(struct GameState *state);
+// call after the change has been applied to state
+void historyRecord(struct GameState *state, int type, int player, int index, int delta);
+// events applied since the last reset
+uint32_t historyEventCount(void);
+// return 1 if state changed
+int historyUndo(struct GameState *state);
+int historyRedo(struct GameState *state);
+
+// for the autosave, returns the number of bytes used or 0 if buf is too small
+uint32_t historySerialize(void *buf, uint32_t len);
+// returns 0 and resets the history if the data doesn't make sense
+int historyDeserialize(struct GameState *state, const void *buf, uint32_t len);
+
+#endif
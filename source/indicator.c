@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <string.h>
+
+#include <tonc.h>
+
+#include "indicator.h"
+
+// Sprite tiles from 512 on, the half that the bitmap modes leave to sprites.
+// Every indicator has its tiles, its sprites and a palette bank of its own,
+// ink is index 1 of the bank. A text takes a 32x8 sprite per 4 characters
+// and a tile per character.
+#define FIRST_TILE 512
+#define SHAPE_TILES ((INDICATOR_SHAPE_SIZE / 8) * (INDICATOR_SHAPE_SIZE / 8))
+#define SPRITE_CHARS 4
+#define MAX_CHARS 24
+#define SPRITES 9
+
+#define FONT_FIRST_CHAR 32
+#define FONT_CHARS 96
+
+// the weight of a sprite that isn't faded at all
+#define BLEND_FULL 16
+
+struct Indicator {
+    int firstTile;
+    int firstSprite;
+    int sprites;
+    // 0 for the shape
+    int chars;
+    // what is in the tiles
+    char drawn[MAX_CHARS];
+    int length;
+    int width;
+    int height;
+    int size;
+    u16 color;
+    int shown;
+    int x;
+    int y;
+    int flip;
+    int fadeWait;
+    int fadeFrames;
+    int fadeLeft;
+    int pulsePeriod;
+    int pulseFrame;
+};
+
+static struct Indicator indicators[INDICATORS] = {
+    [INDICATOR_SELECTION] = { FIRST_TILE, 0, 1, 0 },
+    [INDICATOR_LIFE_CHANGE] = { FIRST_TILE + SHAPE_TILES, 1, 2, 8 },
+    [INDICATOR_AUTOSAVE] = { FIRST_TILE + SHAPE_TILES + 8, 3, 6, MAX_CHARS },
+};
+
+static OBJ_ATTR objBuffer[SPRITES];
+static int allShown = 1;
+static int fading = -1;
+
+static TILE *spriteTile(int tile)
+{
+    return (TILE *) tile_mem[4] + tile;
+}
+
+void indicatorInit(void)
+{
+    oam_init(oam_mem, 128);
+    oam_init(objBuffer, SPRITES);
+
+    // a faded sprite blends with whatever layer is under it
+    REG_BLDCNT = BLD_STD | BLD_BOT(BLD_BG0 | BLD_BG1 | BLD_BG2 | BLD_BG3 | BLD_BACKDROP);
+    REG_BLDALPHA = BLDA_BUILD(BLEND_FULL, 0);
+}
+
+void indicatorsShown(int shown)
+{
+    allShown = shown;
+}
+
+// The 1bpp font as 4bpp, ink is index 1.
+static void drawChar(int tile, uint ch)
+{
+    const TFont *font = &sys8Font;
+    u32 *dst = spriteTile(tile)->data;
+    const u8 *glyph;
+
+    if (ch < FONT_FIRST_CHAR || ch >= FONT_FIRST_CHAR + FONT_CHARS) {
+        ch = ' ';
+    }
+    glyph = (const u8 *) font->data + (ch - FONT_FIRST_CHAR) * font->cellSize;
+
+    for (int y = 0; y < 8; y++) {
+        u32 row = 0;
+
+        for (int x = 0; x < 8; x++) {
+            row |= ((glyph[y] >> x) & 1) << (x * 4);
+        }
+        dst[y] = row;
+    }
+}
+
+// Only the characters that changed are drawn again, the rest of the last
+// sprite is blanked.
+void indicatorSetText(int indicator, const char *text)
+{
+    struct Indicator *ind = &indicators[indicator];
+    int len = min((int) strlen(text), ind->chars);
+
+    for (int i = 0; i < ind->chars; i++) {
+        char ch = i < len ? text[i] : ' ';
+
+        if (ind->drawn[i] != ch) {
+            drawChar(ind->firstTile + i, (u8) ch);
+            ind->drawn[i] = ch;
+        }
+    }
+    ind->length = len;
+    ind->width = len * 8;
+    ind->height = 8;
+}
+
+// a square sprite of the smallest size the mask fits in, 1D mapped
+void indicatorSetShape(int indicator, const uint8_t *mask, int pitch, int width, int height)
+{
+    struct Indicator *ind = &indicators[indicator];
+    int size = 8;
+
+    width = min(width, INDICATOR_SHAPE_SIZE);
+    height = min(height, INDICATOR_SHAPE_SIZE);
+    while (size < width || size < height) {
+        size *= 2;
+    }
+
+    memset32(spriteTile(ind->firstTile), 0, (size / 8) * (size / 8) * sizeof(TILE) / 4);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            u32 *row;
+
+            if (!((mask[y * pitch + x / 8] >> (x & 7)) & 1)) {
+                continue;
+            }
+            row = &spriteTile(ind->firstTile + (y / 8) * (size / 8) + x / 8)->data[y % 8];
+            *row |= 1 << ((x % 8) * 4);
+        }
+    }
+
+    ind->width = width;
+    ind->height = height;
+    ind->size = size;
+}
+
+void indicatorSetColor(int indicator, uint16_t color)
+{
+    indicators[indicator].color = color;
+    pal_obj_mem[indicator * 16 + 1] = color;
+}
+
+void indicatorShow(int indicator, int x, int y, int flip)
+{
+    struct Indicator *ind = &indicators[indicator];
+
+    ind->shown = 1;
+    ind->x = x;
+    ind->y = y;
+    ind->flip = flip;
+    if (fading == indicator) {
+        fading = -1;
+    }
+}
+
+void indicatorHide(int indicator)
+{
+    indicators[indicator].shown = 0;
+    if (fading == indicator) {
+        fading = -1;
+    }
+}
+
+void indicatorFadeOut(int indicator, int after, int frames)
+{
+    struct Indicator *ind = &indicators[indicator];
+
+    if (!ind->shown) {
+        return;
+    }
+
+    if (fading >= 0 && fading != indicator) {
+        indicatorHide(fading);
+    }
+
+    fading = indicator;
+    ind->fadeWait = after;
+    ind->fadeFrames = max(frames, 1);
+    ind->fadeLeft = ind->fadeFrames;
+}
+
+void indicatorPulse(int indicator, int period)
+{
+    indicators[indicator].pulsePeriod = period;
+    indicators[indicator].pulseFrame = 0;
+    pal_obj_mem[indicator * 16 + 1] = indicators[indicator].color;
+}
+
+// from full down to a quarter and back
+static void pulse(int indicator)
+{
+    struct Indicator *ind = &indicators[indicator];
+    int half = max(ind->pulsePeriod / 2, 1);
+    int fromFull = ind->pulseFrame < half ? ind->pulseFrame : ind->pulsePeriod - ind->pulseFrame;
+    int level = BLEND_FULL - fromFull * BLEND_FULL * 3 / 4 / half;
+    u16 c = ind->color;
+
+    pal_obj_mem[indicator * 16 + 1] = RGB15((c & 31) * level / BLEND_FULL, ((c >> 5) & 31) * level / BLEND_FULL,
+                                            ((c >> 10) & 31) * level / BLEND_FULL);
+    ind->pulseFrame = (ind->pulseFrame + 1) % ind->pulsePeriod;
+}
+
+static void place(int indicator, int blend)
+{
+    struct Indicator *ind = &indicators[indicator];
+    u16 bank = ATTR2_PALBANK(indicator) | ATTR2_PRIO(0);
+    u16 mode = blend ? ATTR0_BLEND : ATTR0_REG;
+
+    for (int i = 0; i < ind->sprites; i++) {
+        OBJ_ATTR *obj = &objBuffer[ind->firstSprite + i];
+        int x = ind->x, y = ind->y;
+
+        if (!allShown || !ind->shown || (ind->chars ? i * SPRITE_CHARS >= ind->length : ind->size == 0)) {
+            obj->attr0 = ATTR0_HIDE;
+            continue;
+        }
+
+        if (ind->chars) {
+            // 32x8
+            x += i * SPRITE_CHARS * 8;
+            obj_set_attr(obj, ATTR0_Y(y) | mode | ATTR0_4BPP | ATTR0_WIDE, ATTR1_X(x) | ATTR1_SIZE_16,
+                         ATTR2_ID(ind->firstTile + i * SPRITE_CHARS) | bank);
+        } else {
+            u16 size = ind->size == 8 ? ATTR1_SIZE_8 : ind->size == 16 ? ATTR1_SIZE_16 : ATTR1_SIZE_32;
+            u16 flip = 0;
+
+            // flipped the shape has to stay where it is in the sprite
+            if (ind->flip) {
+                x += ind->width - ind->size;
+                y += ind->height - ind->size;
+                flip = ATTR1_HFLIP | ATTR1_VFLIP;
+            }
+            obj_set_attr(obj, ATTR0_Y(y) | mode | ATTR0_4BPP | ATTR0_SQUARE, ATTR1_X(x) | size | flip,
+                         ATTR2_ID(ind->firstTile) | bank);
+        }
+    }
+}
+
+void indicatorFrame(void)
+{
+    int weight = BLEND_FULL;
+
+    if (fading >= 0) {
+        struct Indicator *ind = &indicators[fading];
+
+        if (ind->fadeWait > 0) {
+            ind->fadeWait--;
+        } else if (--ind->fadeLeft <= 0) {
+            indicatorHide(fading);
+        } else {
+            weight = BLEND_FULL * ind->fadeLeft / ind->fadeFrames;
+        }
+    }
+
+    for (int i = 0; i < INDICATORS; i++) {
+        if (indicators[i].pulsePeriod > 0) {
+            pulse(i);
+        }
+        place(i, i == fading && weight < BLEND_FULL);
+    }
+
+    // weights that add up to full, a cross-fade rather than brightening
+    REG_BLDALPHA = BLDA_BUILD(weight, BLEND_FULL - weight);
+    oam_copy(oam_mem, objBuffer, SPRITES);
+}
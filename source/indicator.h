@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef INDICATOR_H__
+#define INDICATOR_H__
+
+#include <stdint.h>
+
+// What comes and goes over the game: the dot of the selected player, the
+// life change and the autosave status. They are hardware sprites above
+// whichever display is built, so showing, moving or hiding one only changes
+// the OAM buffer that goes out in the next VBlank and fading one out is the
+// blend registers. New text or a new shape writes a few sprite tiles, what
+// the display drew underneath is never touched.
+enum INDICATOR {
+    INDICATOR_SELECTION = 0,
+    INDICATOR_LIFE_CHANGE,
+    INDICATOR_AUTOSAVE,
+    INDICATORS,
+};
+
+// the largest shape, in pixels either way
+#define INDICATOR_SHAPE_SIZE 32
+
+void indicatorInit(void);
+// Call right after VBlankIntrWait, copies the sprites to OAM and runs the
+// fades and pulses.
+void indicatorFrame(void);
+// Takes all of them off the screen or puts them back, they keep what they
+// show in between.
+void indicatorsShown(int shown);
+
+// The selection is a shape, a 1bpp mask (LSB is the leftmost pixel) of up to
+// INDICATOR_SHAPE_SIZE pixels either way. The others are a line of text in
+// the 8x8 font, as long as it fits the indicator.
+void indicatorSetShape(int indicator, const uint8_t *mask, int pitch, int width, int height);
+void indicatorSetText(int indicator, const char *text);
+void indicatorSetColor(int indicator, uint16_t color);
+// With its top left at x, y. A shape can be flipped, turned half around in
+// the same place.
+void indicatorShow(int indicator, int x, int y, int flip);
+void indicatorHide(int indicator);
+// Hides it after waiting for after frames and fading it out into what's
+// underneath over frames. Showing it again stops the fade. One fade runs at
+// a time, starting another ends the one before.
+void indicatorFadeOut(int indicator, int after, int frames);
+// The color goes down to a quarter and back up every period frames, 0 stops.
+void indicatorPulse(int indicator, int period);
+
+#endif
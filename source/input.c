@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "debug.h"
+#include "input.h"
+
+static uint32_t frame = 0;
+static const struct GameState *gameState = NULL;
+
+void inputRecord(struct GameState *state, int down, int up)
+{
+    frame++;
+    gameState = state;
+
+    if ((down | up) && debugEnabled()) {
+        debugPrintf("input: %u %04x %04x", (unsigned int) frame, down, up);
+    }
+}
+
+uint32_t inputFrame(void)
+{
+    return frame;
+}
+
+const struct GameState *inputGameState(void)
+{
+    return gameState;
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef INPUT_H__
+#define INPUT_H__
+
+#include <stdint.h>
+
+#include "gamestate.h"
+
+// Records the buttons of a session to the debug log, one line for every
+// frame where something was pressed or released:
+//   input: <frame> <keysDown> <keysUp>
+// with the frame counted from 1 at the first VBlank and the key masks in hex.
+// host/replay feeds such a log back through the main loop. Nothing is
+// written on hardware, the log isn't there.
+
+// Call once per frame right after scanKeys, before the keys are handled.
+void inputRecord(struct GameState *state, int down, int up);
+
+uint32_t inputFrame(void);
+// The state the keys of the current frame go to, for the host to look at.
+const struct GameState *inputGameState(void);
+
+#endif
@@ -8,38 +8,35 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "archive.h"
+#include "audio.h"
+#include "counters.h"
+#include "debug.h"
+#include "display.h"
+#include "gamestate.h"
+#include "history.h"
+#include "indicator.h"
+#include "input.h"
+#include "memstats.h"
+#include "placement.h"
+#include "profile.h"
+#include "render.h"
+#include "save.h"
 #include "text.h"
 
-#include "AAS.h"
-#include "AAS_Data.h"
-
 #define FPS 60
 
 #define TIME_CLEAR_LIFE_CHANGED (FPS * 3)
 #define TIME_AUTO_SAVE (FPS * 15)
+#define TIME_SHOW_SAVED (FPS * 2)
+#define TIME_FADE_OUT (FPS / 2)
 
-// let's hope it's never 8 (game will take forever)
-#define MAX_PLAYERS 8
-
-#define MAX_COMMANDER_DAMAGE 21
-#define MAX_POISON_COUNTERS 10
-
-#define MAX_LIFE_FOR_CUSTOM_PRINT 999
-#define MIN_LIFE_FOR_CUSTOM_PRINT -99
-
-#define POISON_COLOR COLOR_LIME
-#define ENERGY_COLOR COLOR_CREAM
-#define EXPERIENCE_COLOR COLOR_GRAY
-#define COMMANDERTAX_COLOR COLOR_WHITE
+// the screen is cleared a band per job so a full redraw is spread out
+#define CLEAR_BANDS 4
 
-// These are shared with commander damage and thus need the be > MAX_PLAYERS
-#define POISON_COUNTER (MAX_PLAYERS + 1)
-#define ENERGY_COUNTER (MAX_PLAYERS + 2)
-#define EXPERIENCE_COUNTER (MAX_PLAYERS + 3)
-#define COMMANDERTAX_COUNTER (MAX_PLAYERS + 4)
-#define FIRST_COUNTER POISON_COUNTER
-#define LAST_COUNTER COMMANDERTAX_COUNTER
-#define LAST_COUNTER_NO_COMMANDERTAX EXPERIENCE_COUNTER
+// the numbers fall back to a smaller font for up to 5 glyphs, see text.c
+#define MAX_LIFE_FOR_CUSTOM_PRINT 99999
+#define MIN_LIFE_FOR_CUSTOM_PRINT -9999
 
 // Save, save and quit and so on.
 enum {
@@ -54,7 +51,7 @@ enum {
     MENU_ITEMS,
 };
 
-#define MAX_BACKGROUND_SONGS 3
+#define MAX_BACKGROUND_SONGS (AUDIO_SONGS + 1)
 
 enum {
     SETUP_ITEM_QUICK_START_COMMANDER4P = 0,
@@ -68,352 +65,26 @@ enum {
     SETUP_ITEM_START,
     SETUP_ITEM_LOAD_SAVE,
     SETUP_ITEM_LOAD_AUTOSAVE,
+    SETUP_ITEM_STATS,
     SETUP_ITEM_CONTROLS,
     SETUP_ITEMS,
 };
 
-#define FLASH_ROM ((vu8 *) 0x0e000000)
-#define FLASH_ROM_SIZE 0x10000
-
-enum {
-    STATE_SETUP = 0,
-    STATE_COUNTLIFE = 1,
-    STATE_MENU = 2,
-    STATE_CONTROLS = 3,
-};
-
-struct PlayerState {
-    int lifeCounter;
-    int commanderDamage[MAX_PLAYERS];
-    int poisonCounters;
-    int energyCounters;
-    int experienceCounters;
-    int commanderTaxCounter; // (Commander Tax / 2)
-};
-
-#define SAVEABLE_GAME_STATE \
-    int maxPlayers; \
-    int maxOpponents; \
-    int startingLife; \
-    int upsideDownNumbers; \
-    int selectedBackgroundSong; \
-    int sfxEnabled; \
-    struct PlayerState playerState[MAX_PLAYERS];
-
-struct SaveableGameState {
-    SAVEABLE_GAME_STATE;
-};
-
-struct GameState {
-    SAVEABLE_GAME_STATE;
-    int state;
-    int previousState;
-    int keysDown;
-    int framesSinceUPPressedOrQuarterSecond;
-    int framesSinceDOWNPressedOrQuarterSecond;
-    int selectedPlayer;
-    int selectedMenuItem;
-    int selectedSetupItem;
-    int selectedCommanderDamageOrCounter;
-    int lastCounter;
-    int triggerAutoSaveInFrames;
-    int printedRegular;
-    int lifeChangedCurrent;
-    int triggerClearLifeChangedCurrentInFrames;
-    int stateToReturnTo;
-};
-
-static void initializeStartingLifeAndCounters(struct GameState *state)
-{
-    for (int i = 0; i < MAX_PLAYERS; i++) {
-        state->playerState[i].lifeCounter = state->startingLife;
-        for (int j = 0; j < MAX_PLAYERS; j++) {
-            state->playerState[i].commanderDamage[j] = 0;
-        }
-        state->playerState[i].poisonCounters = 0;
-        state->playerState[i].energyCounters = 0;
-        state->playerState[i].experienceCounters = 0;
-        state->playerState[i].commanderTaxCounter = 0;
-    }
-
-    if (state->maxOpponents == 0) {
-        state->lastCounter = LAST_COUNTER_NO_COMMANDERTAX;
-    } else {
-        state->lastCounter = LAST_COUNTER;
-    }
-}
-
-static void initializeGameState(struct GameState *state)
-{
-    state->state = STATE_SETUP;
-    state->previousState = -1;
-    state->stateToReturnTo = -1;
-
-    state->keysDown = 0;
-    state->framesSinceUPPressedOrQuarterSecond = 0;
-    state->framesSinceDOWNPressedOrQuarterSecond = 0;
-    state->selectedPlayer = 0;
-    state->selectedMenuItem = 0;
-    state->selectedSetupItem = 0;
-    // state->selectedBackgroundSong = 0;
-    state->sfxEnabled = 1;
-    state->selectedCommanderDamageOrCounter = 0;
-    state->lastCounter = LAST_COUNTER;
-    state->triggerAutoSaveInFrames = 0;
-    state->printedRegular = 0;
-    state->lifeChangedCurrent = 0;
-    state->triggerClearLifeChangedCurrentInFrames = 0;
-
-    state->upsideDownNumbers = 0;
-
-    state->maxPlayers = 4;
-    state->maxOpponents = 1;
-    state->startingLife = 40;
-
-    initializeStartingLifeAndCounters(state);
-}
-
-static void resetNonPersistentGameStateValues(struct GameState *state)
-{
-    state->state = STATE_COUNTLIFE;
-    state->previousState = -1;
-    state->stateToReturnTo = -1;
-
-    state->keysDown = 0;
-    state->framesSinceUPPressedOrQuarterSecond = 0;
-    state->framesSinceDOWNPressedOrQuarterSecond = 0;
-    state->selectedPlayer = 0;
-    state->selectedCommanderDamageOrCounter = 0;
-    if (state->maxOpponents == 0) {
-        state->lastCounter = LAST_COUNTER_NO_COMMANDERTAX;
-    } else {
-        state->lastCounter = LAST_COUNTER;
-    }
-    state->selectedMenuItem = 0;
-    state->selectedSetupItem = 0;
-    // state->selectedBackgroundSong = 0;
-    state->triggerAutoSaveInFrames = 0;
-    state->printedRegular = 0;
-    state->lifeChangedCurrent = 0;
-    state->triggerClearLifeChangedCurrentInFrames = 0;
-}
-
-static int flashValid(int slot)
-{
-    int is_valid_savefile = (FLASH_ROM[0] == 'G' && FLASH_ROM[1] == 'B' && FLASH_ROM[2] == 'A' && FLASH_ROM[3] == 'L') ? 1 : 0;
-    if (is_valid_savefile) {
-        if (slot == 0 && FLASH_ROM[4] == 'X') {
-            return 1;
-        }
-        if (slot == 1 && FLASH_ROM[5 + sizeof(struct SaveableGameState)] == 'X') {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
-static void saveState(struct GameState *state, int slot)
-{
-    FLASH_ROM[0] = 'G';
-    FLASH_ROM[1] = 'B';
-    FLASH_ROM[2] = 'A';
-    FLASH_ROM[3] = 'L';
-
-    // TODO: crc?
-
-    if (slot == 0) {
-        FLASH_ROM[4] = 'X';
-    } else {
-        FLASH_ROM[5 + sizeof(struct SaveableGameState)] = 'X';
-    }
-
-    for (int i = 0; i < sizeof(struct SaveableGameState); i++) {
-        FLASH_ROM[5 + i + slot * sizeof(struct SaveableGameState) + slot] = ((char*)state)[i];
-    }
-}
-
-static int loadState(struct GameState *state, int slot)
-{
-    if (flashValid(slot)) {
-        for (int i = 0; i < sizeof(struct SaveableGameState); i++) {
-            ((char*)state)[i] = FLASH_ROM[5 + i + slot * sizeof(struct SaveableGameState) + slot];
-        }
-
-        resetNonPersistentGameStateValues(state);
-        return 1;
-    }
-
-    return 0;
-}
-
+// Also picks the mixer setup, so call it when the sound effects are toggled.
+// The entry after the last song is "No music".
 static void adjustBackgroundSong(struct GameState *state)
 {
-    AAS_MOD_Stop(AAS_DATA_MOD_musix_retrospective);
-    AAS_MOD_Stop(AAS_DATA_MOD_drozerix___ai_renaissance);
-
-    switch (state->selectedBackgroundSong) {
-        case 0:
-            AAS_MOD_Play(AAS_DATA_MOD_drozerix___ai_renaissance);
-            break;
-        case 1:
-            AAS_MOD_Play(AAS_DATA_MOD_musix_retrospective);
-            break;
-        case 2:
-            break;
-    };
-}
-
-static int getPlayerColor(int player)
-{
-    int color = 0;
-    switch (player) {
-        /* large start */
-        case 0:
-            color = COLOR_BLUE;
-            break;
-        case 1:
-            color = COLOR_ORANGE;
-            break;
-        case 2:
-            color = COLOR_MAGENTA;
-            break;
-        case 3:
-            color = COLOR_GREEN;
-            break;
-        /* large end */
-        case 4:
-            color = COLOR_PURPLE;
-            break;
-        case 5:
-            color = COLOR_CYAN;
-            break;
-        case 6:
-            color = COLOR_CREAM;
-            break;
-        case 7:
-            color = COLOR_YELLOW;
-            break;
-        default:
-            color = COLOR_WHITE;
-    };
-
-    return color;
-}
-
-static void reverseString(char* str)
-{
-    int start = 0;
-    int end = strlen(str) - 1;
-    char temp;
-
-    while (start < end) {
-        temp = str[start];
-        str[start] = str[end];
-        str[end] = temp;
-
-        start++;
-        end--;
-    }
-}
-
-static void prepareCounters(char *countersBuf, char *commanderDamageBuf, int buflen, struct GameState *state, int player, int ud)
-{
-    char tmpBuf[buflen];
-    tmpBuf[0] = 0;
-    countersBuf[0] = 0;
-    commanderDamageBuf[0] = 0;
-
-    if (ud) {
-        for (int j = state->maxOpponents - 1, c = state->maxOpponents; j >= 0; j--, c--) {
-            char tmp[buflen];
-            if (c == player) {
-                c--;
-            }
-
-            int col = getPlayerColor(c);
-
-            if (state->playerState[player].commanderDamage[j] >= MAX_COMMANDER_DAMAGE) {
-                col = COLOR_RED;
-            }
-
-            if (j == state->maxOpponents - 1) {
-                snprintf(tmp, buflen, "%d%s", state->playerState[player].commanderDamage[j], (player == state->selectedPlayer && j == state->selectedCommanderDamageOrCounter) ? "." : "");
-                reverseString(tmp);
-                snprintf(commanderDamageBuf, buflen, "#{ci:%d}%s", convertColor(col), tmp);
-            } else {
-                snprintf(tmp, buflen, "%d%s", state->playerState[player].commanderDamage[j], (player == state->selectedPlayer && j == state->selectedCommanderDamageOrCounter) ? "." : "");
-                reverseString(tmp);
-                snprintf(commanderDamageBuf, buflen, "%s #{ci:%d}%s", tmpBuf, convertColor(col), tmp);
-            }
-            strcpy(tmpBuf, commanderDamageBuf);
-        }
-    } else  {
-        for (int j = 0, c = 0; j < state->maxOpponents; j++, c++) {
-            if (c == player) {
-                c++;
-            }
-
-            int col = getPlayerColor(c);
-
-            if (state->playerState[player].commanderDamage[j] >= MAX_COMMANDER_DAMAGE) {
-                col = COLOR_RED;
-            }
-
-            if (j == 0) {
-                snprintf(commanderDamageBuf, buflen, "#{ci:%d}%d%s", convertColor(col), state->playerState[player].commanderDamage[j], (player == state->selectedPlayer && j == state->selectedCommanderDamageOrCounter) ? "." : "");
-            } else {
-                snprintf(commanderDamageBuf, buflen, "%s #{ci:%d}%d%s", tmpBuf, convertColor(col), state->playerState[player].commanderDamage[j], (player == state->selectedPlayer && j == state->selectedCommanderDamageOrCounter) ? "." : "");
-            }
-            strcpy(tmpBuf, commanderDamageBuf);
-        }
-    }
-
-    char tmp1[32], tmp2[32], tmp3[32], tmp4[32];
-    snprintf(tmp1, 32, "%d%s", state->playerState[player].poisonCounters, (state->selectedPlayer == player && state->selectedCommanderDamageOrCounter == POISON_COUNTER) ? "." : "");
-    snprintf(tmp2, 32, "%d%s", state->playerState[player].energyCounters, (state->selectedPlayer == player && state->selectedCommanderDamageOrCounter == ENERGY_COUNTER) ? "." : "");
-    snprintf(tmp3, 32, "%d%s", state->playerState[player].experienceCounters, (state->selectedPlayer == player && state->selectedCommanderDamageOrCounter == EXPERIENCE_COUNTER) ? "." : "");
-    if (state->maxOpponents > 0) {
-        snprintf(tmp4, 32, "%d%s", state->playerState[player].commanderTaxCounter, (state->selectedPlayer == player && state->selectedCommanderDamageOrCounter == COMMANDERTAX_COUNTER) ? "." : "");
-    }
-    if (ud) {
-        reverseString(tmp1);
-        reverseString(tmp2);
-        reverseString(tmp3);
-        if (state->maxOpponents > 0) {
-            reverseString(tmp4);
-
-            snprintf(countersBuf, buflen, "#{ci:%d}%sC #{ci:%d}%sX #{ci:%d}%sE #{ci:%d}%sP",
-                               convertColor(COMMANDERTAX_COLOR), tmp4,
-                               convertColor(EXPERIENCE_COLOR), tmp3,
-                               convertColor(ENERGY_COLOR), tmp2,
-                               convertColor(POISON_COLOR), tmp1);
-        } else {
-            snprintf(countersBuf, buflen, "#{ci:%d}%sX #{ci:%d}%sE #{ci:%d}%sP",
-                               convertColor(EXPERIENCE_COLOR), tmp3,
-                               convertColor(ENERGY_COLOR), tmp2,
-                               convertColor(POISON_COLOR), tmp1);
-        }
+    if (state->selectedBackgroundSong < AUDIO_SONGS) {
+        audioConfigure(state->selectedBackgroundSong, state->sfxEnabled);
     } else {
-        if (state->maxOpponents > 0) {
-            snprintf(countersBuf, buflen, "#{ci:%d}P%s #{ci:%d}E%s #{ci:%d}X%s #{ci:%d}C%s",
-                               convertColor(POISON_COLOR), tmp1,
-                               convertColor(ENERGY_COLOR), tmp2,
-                               convertColor(EXPERIENCE_COLOR), tmp3,
-                               convertColor(COMMANDERTAX_COLOR), tmp4);
-        } else {
-            snprintf(countersBuf, buflen, "#{ci:%d}P%s #{ci:%d}E%s #{ci:%d}X%s",
-                               convertColor(POISON_COLOR), tmp1,
-                               convertColor(ENERGY_COLOR), tmp2,
-                               convertColor(EXPERIENCE_COLOR), tmp3);
-        }
+        audioConfigure(AUDIO_NO_SONG, state->sfxEnabled);
     }
 }
 
 static void printCounters(int row, int row2, int offset_x, int width_x, int ud, struct GameState *state, int player)
 {
-    char commanderDamageBuf[256], countersBuf[256];
-    prepareCounters(countersBuf, commanderDamageBuf, 256, state, player, ud);
+    char commanderDamageBuf[COUNTER_TEXT_LEN], countersBuf[COUNTER_TEXT_LEN];
+    prepareCounters(countersBuf, commanderDamageBuf, COUNTER_TEXT_LEN, state, player, ud);
 
     if (row == row2) {
         strcat(commanderDamageBuf, " ");
@@ -427,15 +98,15 @@ static void printCounters(int row, int row2, int offset_x, int width_x, int ud,
 
 static void printLifeRegular(struct GameState *state, int player)
 {
-    char commanderDamageBuf[256], countersBuf[256];
-    prepareCounters(commanderDamageBuf, countersBuf, 256, state, player, 0);
+    char commanderDamageBuf[COUNTER_TEXT_LEN], countersBuf[COUNTER_TEXT_LEN];
+    prepareCounters(commanderDamageBuf, countersBuf, COUNTER_TEXT_LEN, state, player, 0);
 
     if (state->selectedPlayer == player) {
-        printTextColor(1 + player * 2, 10, getScreenWidth(), getPlayerColor(player), 0, "*Player %d: %d %s", player, state->playerState[player].lifeCounter, commanderDamageBuf);
-    } else if (state->playerState[player].lifeCounter <= 0 || state->playerState[player].poisonCounters >= MAX_POISON_COUNTERS) {
-        printTextColor(1 + player * 2, 10, getScreenWidth(), COLOR_RED, 0, " Player %d: %d %s", player, state->playerState[player].lifeCounter, commanderDamageBuf);
+        printTextColor(1 + player * 2, 10, getScreenWidth(), getPlayerColor(player), 0, "*Player %d: %d %s", player, playerLife(&state->players, player), commanderDamageBuf);
+    } else if (playerLife(&state->players, player) <= 0 || lethalCounter(&state->players, player) >= 0) {
+        printTextColor(1 + player * 2, 10, getScreenWidth(), COLOR_RED, 0, " Player %d: %d %s", player, playerLife(&state->players, player), commanderDamageBuf);
     } else {
-        printTextColor(1 + player * 2, 10, getScreenWidth(), getPlayerColor(player), 0, " Player %d: %d %s", player, state->playerState[player].lifeCounter, commanderDamageBuf);
+        printTextColor(1 + player * 2, 10, getScreenWidth(), getPlayerColor(player), 0, " Player %d: %d %s", player, playerLife(&state->players, player), commanderDamageBuf);
     }
 
     printText(1 + player * 2 + 1, 10 + getGlyphWidth() * 2, getScreenWidth(), 0, countersBuf);
@@ -489,8 +160,8 @@ static void getLargeLayout(int player, int maxSquares, int ud, int *offset_x, in
                     *row2 = 8;
                     break;
                 case 2:
-                    // bottom left corner:
-                    *offset_x = 5;
+                    // bottom left corner, with three players in the middle:
+                    *offset_x = maxSquares == 3 ? 65 : 5;
                     *row = 11;
                     *row2 = 18;
                     break;
@@ -505,6 +176,21 @@ static void getLargeLayout(int player, int maxSquares, int ud, int *offset_x, in
     }
 }
 
+static int isOut(struct GameState *state, int player)
+{
+    return playerLife(&state->players, player) <= 0 || lethalCounter(&state->players, player) >= 0;
+}
+
+// the selected player always shows its own color
+static int lifeColor(struct GameState *state, int player)
+{
+    if (state->selectedPlayer != player && isOut(state, player)) {
+        return COLOR_RED;
+    }
+
+    return getPlayerColor(player);
+}
+
 static void getLargeOffsets(int square, int maxSquares, int ud, int *offset_x, int *offset_y)
 {
     if (maxSquares == 2) {
@@ -547,8 +233,8 @@ static void getLargeOffsets(int square, int maxSquares, int ud, int *offset_x, i
                     *offset_y = 20;
                     break;
                 case 2:
-                    // bottom left corner:
-                    *offset_x = 0;
+                    // bottom left corner, with three players in the middle:
+                    *offset_x = maxSquares == 3 ? 2 * getLargeGlyphWidth() : 0;
                     *offset_y = getScreenHeight() - getLargeGlyphHeight() - 10;
                     break;
                 case 3:
@@ -568,54 +254,335 @@ static void printLifeLarge(struct GameState *state, int player, int ud)
 
     getLargeOffsets(player, state->maxPlayers, ud, &offset_x, &offset_y);
 
-    if (state->selectedPlayer == player) {
-        printLargeNumber(offset_x, offset_y, state->playerState[player].lifeCounter, getPlayerColor(player), ud, 1);
-    } else if (state->playerState[player].lifeCounter <= 0 || state->playerState[player].poisonCounters >= MAX_POISON_COUNTERS) {
-        printLargeNumber(offset_x, offset_y, state->playerState[player].lifeCounter, COLOR_RED, ud, 0);
-    } else {
-        printLargeNumber(offset_x, offset_y, state->playerState[player].lifeCounter, getPlayerColor(player), ud, 0);
+    printPlayerNumber(NUMBER_SIZE_LARGE, offset_x, offset_y, playerLife(&state->players, player), player,
+                      lifeColor(state, player), ud);
+}
+
+// More than four players get a seat each in two columns, the life in the
+// medium font with the commander damage and the counters on the two text
+// rows under it. A seat is its left edge in pixels and its first text row,
+// an odd one out sits in the middle of the last row. From
+// FIRST_LISTED_SEATS players on the seats are as close as they go and the
+// ones that don't fit the screen go on below it, see scrollToSelection.
+struct Seat {
+    int x;
+    int row;
+};
+
+#define FIRST_MEDIUM_SEATS 5
+#define FIRST_LISTED_SEATS 7
+#define SEAT_INDENT 5
+// the number is 3 text rows high, the counters take 2 more
+#define SEAT_NUMBER_ROWS 3
+#define SEAT_ROWS (SEAT_NUMBER_ROWS + 2)
+
+// with room to spare between the rows
+static const struct Seat mediumSeats[FIRST_LISTED_SEATS - FIRST_MEDIUM_SEATS][FIRST_LISTED_SEATS - 1] = {
+    { { 0, 0 }, { 120, 0 }, { 0, 7 }, { 120, 7 }, { 60, 14 } },
+    { { 0, 0 }, { 120, 0 }, { 0, 7 }, { 120, 7 }, { 0, 14 }, { 120, 14 } },
+};
+
+static int hasMediumSeats(struct GameState *state)
+{
+    return state->maxPlayers >= FIRST_MEDIUM_SEATS;
+}
+
+static struct Seat mediumSeat(struct GameState *state, int player)
+{
+    struct Seat seat = { (player % 2) * getScreenWidth() / 2, (player / 2) * SEAT_ROWS };
+
+    if (state->maxPlayers < FIRST_LISTED_SEATS) {
+        return mediumSeats[state->maxPlayers - FIRST_MEDIUM_SEATS][player];
     }
 
+    if (player == state->maxPlayers - 1 && player % 2 == 0) {
+        seat.x = getScreenWidth() / 4;
+    }
+
+    return seat;
+}
+
+// the room right of the number and the dot after it, 3 text rows high
+static int seatSideX(struct Seat seat)
+{
+    return seat.x + SEAT_INDENT + 4 * getMediumGlyphWidth() + getGlyphWidth() / 2;
+}
+
+static void printLifeMedium(struct GameState *state, int player)
+{
+    struct Seat seat = mediumSeat(state, player);
+
+    printPlayerNumber(NUMBER_SIZE_MEDIUM, seat.x + SEAT_INDENT, seat.row * getGlyphHeight(),
+                      playerLife(&state->players, player), player, lifeColor(state, player), 0);
+}
+
+static void printCountersMedium(struct GameState *state, int player)
+{
+    struct Seat seat = mediumSeat(state, player);
+    int row = seat.row + SEAT_NUMBER_ROWS;
+    // up to the next seat
+    int width = getScreenWidth() / 2 - SEAT_INDENT;
+
     if (state->maxOpponents > 0) {
-        int row = 0;
-        int row2 = 0;
+        printCounters(row, row + 1, seat.x + SEAT_INDENT, width, 0, state, player);
+    } else {
+        printCounters(row, row, seat.x + SEAT_INDENT, width, 0, state, player);
+    }
+}
 
-        getLargeLayout(player, state->maxPlayers, ud, &offset_x, &row, &row2);
+// The pixel rows of the game layers a player takes.
+static void getPlayerRows(struct GameState *state, int player, int *top, int *bottom)
+{
+    if (state->printedRegular) {
+        *top = (1 + player * 2) * getGlyphHeight();
+        *bottom = *top + 2 * getGlyphHeight();
+    } else if (hasMediumSeats(state)) {
+        *top = mediumSeat(state, player).row * getGlyphHeight();
+        *bottom = *top + SEAT_ROWS * getGlyphHeight();
+    } else {
+        *top = 0;
+        *bottom = getScreenHeight();
+    }
+}
+
+// The game row at the top of the screen. The game layers are scrolled as
+// little as it takes to show the whole of the selected player, and back to
+// the top when the players fit the screen. Returns 1 if the display doesn't
+// scroll in hardware, then what's on the screen has to be drawn again.
+static int gameTop = 0;
+
+static int scrollToSelection(struct GameState *state)
+{
+    int top = gameTop;
+    int first, end, lastFirst, listEnd;
+
+    getPlayerRows(state, state->selectedPlayer, &first, &end);
+    getPlayerRows(state, state->maxPlayers - 1, &lastFirst, &listEnd);
+
+    if (first < top) {
+        top = first;
+    }
+    if (end > top + getScreenHeight()) {
+        top = end - getScreenHeight();
+    }
+    if (top > listEnd - getScreenHeight()) {
+        top = listEnd - getScreenHeight();
+    }
+    if (top < 0) {
+        top = 0;
+    }
+
+    if (top == gameTop) {
+        return 0;
+    }
+
+    gameTop = top;
+    displayScrollGame(top);
+    // it is where the number was on the screen, not on the list
+    indicatorHide(INDICATOR_LIFE_CHANGE);
 
+    return displayGameHeight() <= getScreenHeight();
+}
+
+// Only changes what's on the screen where the display has player inks, see
+// setPlayerLook. Returns 0 if the life has to be drawn again instead.
+static int showPlayerLook(struct GameState *state, int player)
+{
+    return setPlayerLook(player, lifeColor(state, player));
+}
+
+static void printCountersLarge(struct GameState *state, int player, int ud)
+{
+    int offset_x = 0;
+    int row = 0;
+    int row2 = 0;
+
+    getLargeLayout(player, state->maxPlayers, ud, &offset_x, &row, &row2);
+
+    if (state->maxOpponents > 0) {
         printCounters(row, row2, offset_x, getScreenWidth() / 2, ud, state, player);
     } else {
-        int row = 0;
-        int row2 = 0;
+        // without commander damage the counters fit on one line
+        printCounters(row2, row2, offset_x, getScreenWidth() / 2, 0, state, player);
+    }
+}
 
-        for (int j = 0; j < state->maxPlayers; j++) {
-            getLargeLayout(j, state->maxPlayers, ud, &offset_x, &row, &row2);
+static int isUpsideDown(struct GameState *state, int player)
+{
+    return state->maxPlayers > 1 && !hasMediumSeats(state) && player < 2 && state->upsideDownNumbers;
+}
+
+// The dot after the selected player's large life is an indicator that only
+// moves with the selection, the other layouts mark it in their text.
+static void showSelection(struct GameState *state)
+{
+    int player = state->selectedPlayer;
+    int ud = isUpsideDown(state, player);
+    int offset_x = 0;
+    int offset_y = 0;
+
+    if (state->printedRegular || state->maxPlayers == 1) {
+        indicatorHide(INDICATOR_SELECTION);
+        return;
+    }
+
+    if (hasMediumSeats(state)) {
+        struct Seat seat = mediumSeat(state, player);
+
+        showSelectionDot(NUMBER_SIZE_MEDIUM, seat.x + SEAT_INDENT, seat.row * getGlyphHeight(), getPlayerColor(player), 0);
+        return;
+    }
+
+    getLargeOffsets(player, state->maxPlayers, ud, &offset_x, &offset_y);
+    showSelectionDot(NUMBER_SIZE_LARGE, offset_x, offset_y, getPlayerColor(player), ud);
+}
 
-            printCounters(row2, row2, offset_x, getScreenWidth() / 2, 0, state, j);
+// all of the game layers where they scroll, what's on the screen otherwise
+static void drawClearBand(struct GameState *state, int band)
+{
+    int height = displayGameHeight();
+    int top = height > getScreenHeight() ? 0 : gameTop;
+
+    clearScreenRows(top + band * height / CLEAR_BANDS, top + (band + 1) * height / CLEAR_BANDS);
+}
+
+static void drawLife(struct GameState *state, int player)
+{
+    displaySetLayer(DISPLAY_LAYER_NUMBERS);
+
+    if (state->printedRegular) {
+        printLifeRegular(state, player);
+        indicatorHide(INDICATOR_SELECTION);
+    } else if (state->maxPlayers == 1) {
+        printHugeNumber(playerLife(&state->players, 0));
+        indicatorHide(INDICATOR_SELECTION);
+    } else {
+        if (hasMediumSeats(state)) {
+            printLifeMedium(state, player);
+        } else {
+            printLifeLarge(state, player, isUpsideDown(state, player));
+        }
+        if (player == state->selectedPlayer) {
+            showSelection(state);
         }
     }
 }
 
-static void printLifeHuge(struct GameState *state, int print_commander_damage)
+static void drawCounters(struct GameState *state, int player)
 {
-    printHugeNumber(state->playerState[0].lifeCounter);
+    // the regular lines carry their counters
+    if (state->printedRegular) {
+        return;
+    }
+
+    displaySetLayer(DISPLAY_LAYER_COUNTERS);
 
-    if (print_commander_damage) {
+    if (state->maxPlayers == 1) {
         printCounters(18, 18, 5, getScreenWidth(), 0, state, 0);
+    } else if (hasMediumSeats(state)) {
+        printCountersMedium(state, player);
+    } else {
+        printCountersLarge(state, player, isUpsideDown(state, player));
+    }
+}
+
+// On the last text row, unless the seats take all of them. Then there's
+// only room for a short status right of the top right life, above where its
+// life change goes. Returns 1 for the short one.
+static int getAutoSaveSpot(struct GameState *state, int *x, int *y)
+{
+    int rows = getScreenHeight() / getGlyphHeight();
+
+    if (!state->printedRegular && hasMediumSeats(state) &&
+        mediumSeat(state, state->maxPlayers - 1).row + SEAT_ROWS >= rows) {
+        *x = seatSideX(mediumSeat(state, 1));
+        *y = 0;
+        return 1;
+    }
+
+    *x = 10;
+    *y = (rows - 1) * getGlyphHeight();
+    return 0;
+}
+
+// "Saved!" stays for a moment, then it fades out
+static void showAutoSaveStatus(struct GameState *state, int seconds)
+{
+    char text[32];
+    int x, y;
+    int brief = getAutoSaveSpot(state, &x, &y);
+
+    if (seconds == 0) {
+        snprintf(text, sizeof(text), brief ? "Saved" : "Saved!");
+    } else {
+        snprintf(text, sizeof(text), brief ? "%ds" : "Saving in %d seconds.", seconds);
+    }
+
+    indicatorSetText(INDICATOR_AUTOSAVE, text);
+    indicatorSetColor(INDICATOR_AUTOSAVE, convertColor(COLOR_WHITE));
+    indicatorShow(INDICATOR_AUTOSAVE, x, y, 0);
+
+    if (seconds == 0) {
+        indicatorFadeOut(INDICATOR_AUTOSAVE, TIME_SHOW_SAVED, TIME_FADE_OUT);
+    }
+}
+
+static struct RenderJob clearBandJob = { drawClearBand, "clear" };
+static struct RenderJob lifeJob = { drawLife, "life" };
+static struct RenderJob countersJob = { drawCounters, "counters" };
+
+static void scheduleClearScreen(void)
+{
+    for (int band = 0; band < CLEAR_BANDS; band++) {
+        renderSchedule(&clearBandJob, band, RENDER_PRIORITY_CLEAR);
+    }
+}
+
+// the selected player's life is what was just changed, it goes first
+static void scheduleLife(struct GameState *state, int player)
+{
+    renderSchedule(&lifeJob, player, player == state->selectedPlayer ? RENDER_PRIORITY_SELECTED : RENDER_PRIORITY_LIFE);
+}
+
+static void scheduleCounters(int player)
+{
+    renderSchedule(&countersJob, player, RENDER_PRIORITY_DECORATION);
+}
+
+// With display layers the game stays where it is under the menu, coming
+// back only clears the menu again instead of drawing the whole game anew.
+static int gameKept = 0;
+
+static void leaveGame(void)
+{
+    // a game that isn't drawn completely yet is drawn again from the start
+    gameKept = displayHasLayers() && !renderPending();
+
+    if (gameKept) {
+        displayClearLayer(DISPLAY_LAYER_SCREEN);
+    } else {
+        clearScreen();
+    }
+}
+
+// backToGame is 1 when the menu returns to the game as it was left
+static void leaveMenu(int backToGame)
+{
+    if (backToGame && gameKept) {
+        displayClearLayer(DISPLAY_LAYER_SCREEN);
+    } else {
+        clearScreen();
+        gameKept = 0;
     }
 }
 
 static const char *getSongName(struct GameState *state)
 {
-    switch (state->selectedBackgroundSong) {
-        case 0:
-            return "AI Renaissance";
-        case 1:
-            return "Retrospective ";
-        case 2:
-            return "No music      ";
-    };
-
-    return "UNKNOWN SONG";
+    if (state->selectedBackgroundSong < AUDIO_SONGS) {
+        return audioSongs[state->selectedBackgroundSong].name;
+    }
+
+    return "No music";
 }
 
 static int handleKeysControls(struct GameState *state, int keys_pressed, int keys_released)
@@ -636,6 +603,7 @@ static int handleKeysControls(struct GameState *state, int keys_pressed, int key
         printTextColor(4, 10, getScreenWidth(), COLOR_WHITE, 0, "SL,SR to select counter.");
         printTextColor(5, 10, getScreenWidth(), COLOR_WHITE, 0, "L/R to change counter.");
         printTextColor(6, 10, getScreenWidth(), COLOR_WHITE, 0, "START to enter menu.");
+        printTextColor(7, 10, getScreenWidth(), COLOR_WHITE, 0, "B+SL/B+SR to undo/redo.");
         printTextColor(8, 10, getScreenWidth(), COLOR_WHITE, 0, "Colored numbers near the");
         printTextColor(9, 10, getScreenWidth(), COLOR_WHITE, 0, "life total indicate the");
         printTextColor(10, 10, getScreenWidth(), COLOR_WHITE, 0, "Commander Damage or:");
@@ -652,6 +620,102 @@ static int handleKeysControls(struct GameState *state, int keys_pressed, int key
     return state->state;
 }
 
+static int handleKeysStats(struct GameState *state, int keys_pressed, int keys_released)
+{
+    int stateChanged = state->previousState != state->state;
+
+    if (keys_released & KEY_SELECT) {
+        clearScreen();
+
+        return STATE_MEMORY;
+    }
+
+    // any button returns?
+    if (keys_released) {
+        clearScreen();
+
+        return STATE_SETUP;
+    }
+
+    if (stateChanged) {
+        const struct ArchiveStats *stats = archiveStats();
+        int row = 5;
+
+        printTextColor(1, 10, getScreenWidth(), COLOR_GREEN, 0, "Statistics:");
+        printTextColor(2, 10, getScreenWidth(), COLOR_WHITE, 0, "%d games, ended by", (int) stats->games);
+        printTextColor(3, 10, getScreenWidth(), COLOR_WHITE, 0, "cmdr dmg: %d poison: %d", stats->commanderDamageEndings, stats->poisonEndings);
+        printTextColor(row++, 10, getScreenWidth(), COLOR_WHITE, 0, "Seat Games Wins Lost  C  P");
+
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            const struct ArchiveSeatStats *seat = &stats->seats[i];
+
+            if (seat->games == 0) {
+                continue;
+            }
+
+            printTextColor(row++, 10, getScreenWidth(), getPlayerColor(i), 0, "P%d  %5d %4d %4d %2d %2d", i, seat->games, seat->wins, (int) (seat->lifeLost / seat->games), seat->commanderDamageDeaths, seat->poisonDeaths);
+        }
+
+        // more seats than that push the explanation out
+        if (row <= 14) {
+            printTextColor(14, 10, getScreenWidth(), COLOR_WHITE, 0, "Lost = average life lost.");
+            printTextColor(15, 10, getScreenWidth(), COLOR_WHITE, 0, "C/P = out by commander");
+            printTextColor(16, 10, getScreenWidth(), COLOR_WHITE, 0, "damage/poison.");
+        }
+        printTextColor(18, 10, getScreenWidth(), COLOR_WHITE, 0, "Press any button to leave");
+        printTextColor(19, 10, getScreenWidth(), COLOR_WHITE, 0, "this menu.");
+    }
+
+    return state->state;
+}
+
+// Debug screen behind SELECT on the statistics, see memstats.h. Numbers that
+// can't be measured here show as -.
+static void printMemoryValue(int row, const char *label, uint32_t value, uint32_t of)
+{
+    if (value == 0) {
+        printTextColor(row, 10, getScreenWidth(), COLOR_WHITE, 0, "%s -", label);
+    } else if (of) {
+        printTextColor(row, 10, getScreenWidth(), COLOR_WHITE, 0, "%s %u of %u", label, (unsigned int) value, (unsigned int) of);
+    } else {
+        printTextColor(row, 10, getScreenWidth(), COLOR_WHITE, 0, "%s %u", label, (unsigned int) value);
+    }
+}
+
+static int handleKeysMemory(struct GameState *state, int keys_pressed, int keys_released)
+{
+    int stateChanged = state->previousState != state->state;
+    struct MemoryStats stats;
+
+    // any button returns?
+    if (keys_released) {
+        clearScreen();
+
+        return STATE_STATS;
+    }
+
+    if (stateChanged) {
+        memstatsGet(&stats);
+
+        printTextColor(1, 10, getScreenWidth(), COLOR_GREEN, 0, "Memory (bytes):");
+        printMemoryValue(2, "Stack peak:", stats.stackPeak, stats.stackSize);
+        printMemoryValue(3, "Allocated:", stats.allocated, 0);
+        printTextColor(4, 10, getScreenWidth(), COLOR_WHITE, 0, "Failed allocs: %u", (unsigned int) stats.allocFailures);
+        printMemoryValue(5, "Heap:", stats.heapSize, 0);
+        printMemoryValue(6, "Heap free:", stats.heapFree, 0);
+        printMemoryValue(7, "Free in holes:", stats.heapHoleBytes, 0);
+        printMemoryValue(8, "Holes:", stats.heapHoles, 0);
+        printTextColor(9, 10, getScreenWidth(), COLOR_GREEN, 0, "Code and data:");
+        printMemoryValue(10, "IWRAM:", stats.iwramUsed, MEMSTATS_IWRAM_SIZE);
+        printMemoryValue(11, "EWRAM:", stats.ewramUsed, MEMSTATS_EWRAM_SIZE);
+        printMemoryValue(12, "ROM:", stats.romUsed, 0);
+        printTextColor(18, 10, getScreenWidth(), COLOR_WHITE, 0, "Press any button to leave");
+        printTextColor(19, 10, getScreenWidth(), COLOR_WHITE, 0, "this menu.");
+    }
+
+    return state->state;
+}
+
 static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_released)
 {
     int stateChanged = state->previousState != state->state;
@@ -688,7 +752,6 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
             state->maxPlayers = 2;
             state->maxOpponents = 0;
             state->startingLife = 20;
-            state->selectedCommanderDamageOrCounter = FIRST_COUNTER;
 
             initializeStartingLifeAndCounters(state);
 
@@ -705,10 +768,10 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
 
             return STATE_COUNTLIFE;
         } else if (state->selectedSetupItem == SETUP_ITEM_LOAD_SAVE) {
-            if (flashValid(0)) {
+            // saves from an older version don't load
+            if (loadState(state, SAVE_SLOT_MANUAL)) {
                 clearScreen();
 
-                loadState(state, 0);
                 adjustBackgroundSong(state);
 
                 return STATE_COUNTLIFE;
@@ -716,16 +779,20 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
                 printTextColor(17, 10, getScreenWidth(), COLOR_RED, 0, "NO SAVE FOUND");
             }
         } else if (state->selectedSetupItem == SETUP_ITEM_LOAD_AUTOSAVE) {
-            if (flashValid(1)) {
+            if (loadState(state, SAVE_SLOT_AUTO)) {
                 clearScreen();
 
-                loadState(state, 1);
                 adjustBackgroundSong(state);
 
                 return STATE_COUNTLIFE;
             } else {
                 printTextColor(17, 10, getScreenWidth(), COLOR_RED, 0, "NO SAVE FOUND");
             }
+        } else if (state->selectedSetupItem == SETUP_ITEM_STATS) {
+            // reset the screen on transition
+            clearScreen();
+
+            return STATE_STATS;
         } else if (state->selectedSetupItem == SETUP_ITEM_CONTROLS) {
             // reset the screen on transition
             clearScreen();
@@ -793,6 +860,7 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
     if (state->selectedSetupItem == SETUP_ITEM_SFX) {
         if (keys_released & KEY_LEFT || keys_released & KEY_RIGHT) {
             state->sfxEnabled = state->sfxEnabled ? 0 : 1;
+            adjustBackgroundSong(state);
         }
     }
 
@@ -826,7 +894,7 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
         }
 
         if (keys_released & KEY_RIGHT) {
-            if (state->maxOpponents < MAX_PLAYERS - 1) {
+            if (state->maxOpponents < MAX_OPPONENTS) {
                 state->maxOpponents++;
                 selectedSetupItemChanged = 1;
             }
@@ -865,23 +933,18 @@ static int handleKeysSetup(struct GameState *state, int keys_pressed, int keys_r
         printTextColor(13, 10, getScreenWidth(), COLOR_WHITE, 0, "%cLoad save", (state->selectedSetupItem == SETUP_ITEM_LOAD_SAVE) ? '*' : ' ');
     if (stateChanged || selectedSetupItemChanged || state->selectedSetupItem == SETUP_ITEM_LOAD_AUTOSAVE)
         printTextColor(14, 10, getScreenWidth(), COLOR_WHITE, 0, "%cLoad autosave", (state->selectedSetupItem == SETUP_ITEM_LOAD_AUTOSAVE) ? '*' : ' ');
+    if (stateChanged || selectedSetupItemChanged || state->selectedSetupItem == SETUP_ITEM_STATS)
+        printTextColor(15, 10, getScreenWidth(), COLOR_WHITE, 0, "%cStatistics", (state->selectedSetupItem == SETUP_ITEM_STATS) ? '*' : ' ');
     if (stateChanged || selectedSetupItemChanged || state->selectedSetupItem == SETUP_ITEM_CONTROLS)
         printTextColor(16, 10, getScreenWidth(), COLOR_WHITE, 0, "%cShow controls.", (state->selectedSetupItem == SETUP_ITEM_CONTROLS) ? '*' : ' ');
 
     return state->state;
 }
 
+// The commander damage and the counters are one row, L/R moves along it.
 static void handleDecreaseSelectedCommanderDamage(struct GameState *state, int *changed, int *selectedCommanderDamageChanged)
 {
-    if (state->selectedCommanderDamageOrCounter == FIRST_COUNTER && state->maxOpponents > 0) {
-        state->selectedCommanderDamageOrCounter = state->maxOpponents - 1;
-        *changed = 1;
-        *selectedCommanderDamageChanged = 1;
-    } else if (state->selectedCommanderDamageOrCounter > 0 && state->maxOpponents > 0) {
-        state->selectedCommanderDamageOrCounter--;
-        *changed = 1;
-        *selectedCommanderDamageChanged = 1;
-    } else if (state->selectedCommanderDamageOrCounter > FIRST_COUNTER) {
+    if (state->selectedCommanderDamageOrCounter > 0) {
         state->selectedCommanderDamageOrCounter--;
         *changed = 1;
         *selectedCommanderDamageChanged = 1;
@@ -890,79 +953,143 @@ static void handleDecreaseSelectedCommanderDamage(struct GameState *state, int *
 
 static void handleIncreaseSelectedCommanderDamage(struct GameState *state, int *changed, int *selectedCommanderDamageChanged)
 {
-    if (state->selectedCommanderDamageOrCounter < state->maxOpponents - 1) {
-        state->selectedCommanderDamageOrCounter++;
-        *changed = 1;
-        *selectedCommanderDamageChanged = 1;
-    } else if (state->selectedCommanderDamageOrCounter == state->maxOpponents - 1) {
-        state->selectedCommanderDamageOrCounter = FIRST_COUNTER;
-        *changed = 1;
-        *selectedCommanderDamageChanged = 1;
-    } else if (state->selectedCommanderDamageOrCounter < state->lastCounter) {
+    if (state->selectedCommanderDamageOrCounter < state->maxOpponents + lastCounter(state) - FIRST_COUNTER) {
         state->selectedCommanderDamageOrCounter++;
         *changed = 1;
         *selectedCommanderDamageChanged = 1;
     }
 }
 
-static void printLifeChanged(struct GameState *state, int clear)
+// The life change goes next to the life, it fades out when it's cleared.
+static void showLifeChanged(struct GameState *state, int clear)
 {
+    char text[8];
+    int row, column;
+
+    if (clear) {
+        indicatorFadeOut(INDICATOR_LIFE_CHANGE, 0, TIME_FADE_OUT);
+        return;
+    }
+
     if (state->printedRegular) {
-        if (clear) {
-            printTextColor(18, getScreenWidth() - getGlyphWidth() * 5, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "     ");
-        } else {
-            printTextColor(18, getScreenWidth() - getGlyphWidth() * 5, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "%s%d", (state->lifeChangedCurrent > 0) ? "+" : "", state->lifeChangedCurrent);
-        }
+        row = 18;
+        column = getScreenWidth() - getGlyphWidth() * 5;
+    } else if (hasMediumSeats(state)) {
+        // next to the life, wherever the list is scrolled to
+        row = mediumSeat(state, state->selectedPlayer).row + 1 - gameTop / getGlyphHeight();
+        column = seatSideX(mediumSeat(state, state->selectedPlayer));
+    } else if (state->maxPlayers == 1) {
+        row = 15;
+        column = (getScreenWidth() * 4) / 5 - getGlyphWidth() * 2;
     } else {
-        if (state->maxPlayers == 1) {
-            if (clear) {
-                printTextColor(15, (getScreenWidth() * 4) / 5 - getGlyphWidth() * 2, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "     ");
-            } else {
-                printTextColor(15, (getScreenWidth() * 4) / 5 - getGlyphWidth() * 2, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "%s%d", (state->lifeChangedCurrent > 0) ? "+" : "", state->lifeChangedCurrent);
-            }
-        } else if (state->maxPlayers > 4) {
-            if (clear) {
-                printTextColor(18, getScreenWidth() - getGlyphWidth() * 5, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "     ");
-            } else {
-                printTextColor(18, getScreenWidth() - getGlyphWidth() * 5, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "%s%d", (state->lifeChangedCurrent > 0) ? "+" : "", state->lifeChangedCurrent);
-            }
-        } else {
-            if (clear) {
-                printTextColor(9, getScreenWidth() / 2 - getGlyphWidth() * 2, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "     ");
-            } else {
-                printTextColor(9, getScreenWidth() / 2 - getGlyphWidth() * 2, getGlyphWidth() * 5, getPlayerColor(state->selectedPlayer), 0, "%s%d", (state->lifeChangedCurrent > 0) ? "+" : "", state->lifeChangedCurrent);
-            }
-        }
+        row = 9;
+        column = getScreenWidth() / 2 - getGlyphWidth() * 2;
     }
+
+    snprintf(text, sizeof(text), "%s%d", (state->lifeChangedCurrent > 0) ? "+" : "", state->lifeChangedCurrent);
+    indicatorSetText(INDICATOR_LIFE_CHANGE, text);
+    indicatorSetColor(INDICATOR_LIFE_CHANGE, convertColor(getPlayerColor(state->selectedPlayer)));
+    indicatorShow(INDICATOR_LIFE_CHANGE, column, row * getGlyphHeight(), 0);
 }
 
-static int shouldPrintPlayerRegular(struct GameState *state, int player)
+// the numbers only have room for this many digits, a life past them is text
+static int shouldPrintRegular(struct GameState *state)
 {
-    return (state->playerState[player].lifeCounter < MIN_LIFE_FOR_CUSTOM_PRINT || state->playerState[player].lifeCounter > MAX_LIFE_FOR_CUSTOM_PRINT) ? 1 : 0;
+    return playersLifeOutside(&state->players, state->maxPlayers, MIN_LIFE_FOR_CUSTOM_PRINT, MAX_LIFE_FOR_CUSTOM_PRINT);
 }
 
-static int shouldPrintRegular(struct GameState *state)
+// keeps eliminationOrder in sync, players can come back through undo or lifegain
+static void updateEliminations(struct GameState *state)
 {
     for (int i = 0; i < state->maxPlayers; i++) {
-        if (shouldPrintPlayerRegular(state, i)) {
-            return 1;
+        int out = archiveEliminationCause(state, i) >= 0;
+        int position = -1;
+
+        for (int j = 0; j < state->eliminatedPlayers; j++) {
+            if (state->eliminationOrder[j] == i) {
+                position = j;
+            }
+        }
+
+        if (out && position < 0) {
+            state->eliminationOrder[state->eliminatedPlayers++] = i;
+        } else if (!out && position >= 0) {
+            state->eliminatedPlayers--;
+            for (int j = position; j < state->eliminatedPlayers; j++) {
+                state->eliminationOrder[j] = state->eliminationOrder[j + 1];
+            }
         }
     }
+}
 
-    return 0;
+// returns 1 if the counter of the selected player changed
+static int changeCounter(struct GameState *state, int counter, int delta)
+{
+    delta = playerAddCounter(&state->players, state->selectedPlayer, counter, delta);
+    if (delta) {
+        historyRecord(state, HISTORY_COUNTER, state->selectedPlayer, counter, delta);
+    }
+
+    return delta != 0;
+}
+
+static void playCounterSfx(struct GameState *state, int counter, int before)
+{
+    const struct CounterType *type = counterType(counter);
+    int now = playerCounter(&state->players, state->selectedPlayer, counter);
+
+    if (type->lethal && now >= type->lethal && before < type->lethal) {
+        audioPlaySfx(AUDIO_SFX_DEATH);
+    } else if (type->sfx != COUNTER_NO_SFX) {
+        audioPlaySfx(type->sfx);
+    }
 }
 
 static int handleKeysCountLife(struct GameState *state, int keys_pressed, int keys_released)
 {
-    int stateChanged = state->previousState != state->state;
+    int historyChanged = 0;
+
+    // B + L/R walks through the history instead of selecting counters
+    if ((state->keysDown | keys_pressed) & KEY_B) {
+        if (keys_released & KEY_L) {
+            historyChanged = historyUndo(state);
+        } else if (keys_released & KEY_R) {
+            historyChanged = historyRedo(state);
+        }
+        keys_released &= ~(KEY_L | KEY_R);
+    }
+
+    if (historyChanged) {
+        // redraw everything as if the game was just entered
+        scheduleClearScreen();
+
+        state->lifeChangedCurrent = 0;
+        state->triggerClearLifeChangedCurrentInFrames = 0;
+        state->triggerAutoSaveInFrames = TIME_AUTO_SAVE;
+        indicatorHide(INDICATOR_LIFE_CHANGE);
+    }
+
+    // coming back to a game that was kept is not entering it
+    int entered = state->previousState != state->state && !gameKept;
+
+    // the indicators come back as they were, unless they were done
+    if (entered) {
+        if (state->triggerClearLifeChangedCurrentInFrames == 0) {
+            indicatorHide(INDICATOR_LIFE_CHANGE);
+        }
+        if (state->triggerAutoSaveInFrames == 0) {
+            indicatorHide(INDICATOR_AUTOSAVE);
+        }
+    }
+    int stateChanged = entered || historyChanged;
     int changed = stateChanged;
     int lifeBefore, selectedPlayerBefore;
     int lifeChanged = stateChanged;
-    int poisonBefore = 0;
+    int counterBefore = 0;
     int commanderDamageOrCounterChanged = stateChanged;
     int selectedCommanderDamageChanged = stateChanged;
     int selectedPlayerChanged = stateChanged;
-    int poisonCountersChanged = stateChanged, energyCountersChanged = stateChanged, experienceCountersChanged = stateChanged, commanderTaxCounterChanged = stateChanged;
+    int counterChanged = stateChanged;
     int skipLifeChanged = 0;
 
     int keyIncreaseSelectedCommanderDamage = KEY_R;
@@ -972,7 +1099,7 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
     int keyIncreaseLife = KEY_UP;
     int keyDecreaseLife = KEY_DOWN;
 
-    if (state->upsideDownNumbers && state->selectedPlayer < 2) {
+    if (isUpsideDown(state, state->selectedPlayer)) {
         int willPrintRegular = shouldPrintRegular(state);
 
         if (!willPrintRegular) {
@@ -986,8 +1113,7 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
     }
 
     if (keys_released & KEY_START) {
-        // reset the screen on transition
-        clearScreen();
+        leaveGame();
 
         state->selectedMenuItem = 0;
         return STATE_MENU;
@@ -1011,9 +1137,10 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
         if (state->selectedPlayer >= state->maxPlayers) {
             state->selectedPlayer = 0;
         }
+        historyRecord(state, HISTORY_SELECT_PLAYER, selectedPlayerBefore, state->selectedPlayer, 0);
     }
 
-    lifeBefore = state->playerState[state->selectedPlayer].lifeCounter;
+    lifeBefore = playerLife(&state->players, state->selectedPlayer);
 
     if (state->keysDown & keyIncreaseLife) {
         state->framesSinceUPPressedOrQuarterSecond++;
@@ -1028,7 +1155,7 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
     }
 
     if (state->framesSinceUPPressedOrQuarterSecond >= FPS / 4) {
-        state->playerState[state->selectedPlayer].lifeCounter += 5;
+        historyRecord(state, HISTORY_LIFE, state->selectedPlayer, 0, playerAddLife(&state->players, state->selectedPlayer, 5));
         state->lifeChangedCurrent += 5;
         state->triggerClearLifeChangedCurrentInFrames = TIME_CLEAR_LIFE_CHANGED;
         state->framesSinceUPPressedOrQuarterSecond = 0;
@@ -1036,7 +1163,7 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
     }
 
     if (state->framesSinceDOWNPressedOrQuarterSecond >= FPS / 4) {
-        state->playerState[state->selectedPlayer].lifeCounter -= 5;
+        historyRecord(state, HISTORY_LIFE, state->selectedPlayer, 0, playerAddLife(&state->players, state->selectedPlayer, -5));
         state->lifeChangedCurrent -= 5;
         state->triggerClearLifeChangedCurrentInFrames = TIME_CLEAR_LIFE_CHANGED;
         state->framesSinceDOWNPressedOrQuarterSecond = 0;
@@ -1044,24 +1171,24 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
     }
 
     if (keys_released & keyIncreaseLife) {
-        state->playerState[state->selectedPlayer].lifeCounter++;
+        historyRecord(state, HISTORY_LIFE, state->selectedPlayer, 0, playerAddLife(&state->players, state->selectedPlayer, 1));
         state->lifeChangedCurrent++;
         state->triggerClearLifeChangedCurrentInFrames = TIME_CLEAR_LIFE_CHANGED;
         lifeChanged = 1;
     }
 
     if (keys_released & keyDecreaseLife) {
-        state->playerState[state->selectedPlayer].lifeCounter--;
+        historyRecord(state, HISTORY_LIFE, state->selectedPlayer, 0, playerAddLife(&state->players, state->selectedPlayer, -1));
         state->lifeChangedCurrent--;
         state->triggerClearLifeChangedCurrentInFrames = TIME_CLEAR_LIFE_CHANGED;
         lifeChanged = 1;
     }
 
-    if (state->selectedCommanderDamageOrCounter < FIRST_COUNTER) {
+    if (selectedCounter(state) < 0) {
         if (keys_released & keyDecreaseCommanderDamageOrCounter) {
-            if (state->playerState[state->selectedPlayer].commanderDamage[state->selectedCommanderDamageOrCounter] > 0) {
-                state->playerState[state->selectedPlayer].commanderDamage[state->selectedCommanderDamageOrCounter]--;
-                state->playerState[state->selectedPlayer].lifeCounter++;
+            if (playerAddCommanderDamage(&state->players, state->selectedPlayer, state->selectedCommanderDamageOrCounter, -1)) {
+                playerAddLife(&state->players, state->selectedPlayer, 1);
+                historyRecord(state, HISTORY_COMMANDER_DAMAGE, state->selectedPlayer, state->selectedCommanderDamageOrCounter, -1);
                 // intentionally not incrementing lifeChangedCurrent because it might be confusing.
                 commanderDamageOrCounterChanged = 1;
                 changed = 1;
@@ -1069,68 +1196,27 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
         }
 
         if (keys_released & keyIncreaseCommanderDamageOrCounter) {
-            state->playerState[state->selectedPlayer].commanderDamage[state->selectedCommanderDamageOrCounter]++;
-            state->playerState[state->selectedPlayer].lifeCounter--;
-            // intentionally not decrementing lifeChangedCurrent because it might be confusing.
-            commanderDamageOrCounterChanged = 1;
-            changed = 1;
+            if (playerAddCommanderDamage(&state->players, state->selectedPlayer, state->selectedCommanderDamageOrCounter, 1)) {
+                playerAddLife(&state->players, state->selectedPlayer, -1);
+                historyRecord(state, HISTORY_COMMANDER_DAMAGE, state->selectedPlayer, state->selectedCommanderDamageOrCounter, 1);
+                // intentionally not decrementing lifeChangedCurrent because it might be confusing.
+                commanderDamageOrCounterChanged = 1;
+                changed = 1;
+            }
         }
     } else {
+        int counter = selectedCounter(state);
+
+        counterBefore = playerCounter(&state->players, state->selectedPlayer, counter);
+
         if (keys_released & keyDecreaseCommanderDamageOrCounter) {
-            switch (state->selectedCommanderDamageOrCounter) {
-                case POISON_COUNTER:
-                    if (state->playerState[state->selectedPlayer].poisonCounters > 0) {
-                        poisonBefore = state->playerState[state->selectedPlayer].poisonCounters;
-                        state->playerState[state->selectedPlayer].poisonCounters--;
-                        poisonCountersChanged = 1;
-                    }
-                    break;
-                case ENERGY_COUNTER:
-                    if (state->playerState[state->selectedPlayer].energyCounters > 0) {
-                        state->playerState[state->selectedPlayer].energyCounters--;
-                        energyCountersChanged = 1;
-                    }
-                    break;
-                case EXPERIENCE_COUNTER:
-                    if (state->playerState[state->selectedPlayer].experienceCounters > 0) {
-                        state->playerState[state->selectedPlayer].experienceCounters--;
-                        experienceCountersChanged = 1;
-                    }
-                case COMMANDERTAX_COUNTER:
-                    if (state->playerState[state->selectedPlayer].commanderTaxCounter > 0) {
-                        state->playerState[state->selectedPlayer].commanderTaxCounter -= 2;
-                        commanderTaxCounterChanged = 1;
-                    }
-                    break;
-                default:
-                    printTextColor(12, 10, getScreenWidth(), COLOR_RED, 0, "UNKNOWN COUNTER");
-            };
+            counterChanged |= changeCounter(state, counter, -counterType(counter)->step);
             commanderDamageOrCounterChanged = 1;
             changed = 1;
         }
 
         if (keys_released & keyIncreaseCommanderDamageOrCounter) {
-            switch (state->selectedCommanderDamageOrCounter) {
-                case POISON_COUNTER:
-                    poisonBefore = state->playerState[state->selectedPlayer].poisonCounters;
-                    state->playerState[state->selectedPlayer].poisonCounters++;
-                    poisonCountersChanged = 1;
-                    break;
-                case ENERGY_COUNTER:
-                    state->playerState[state->selectedPlayer].energyCounters++;
-                    energyCountersChanged = 1;
-                    break;
-                case EXPERIENCE_COUNTER:
-                    state->playerState[state->selectedPlayer].experienceCounters++;
-                    experienceCountersChanged = 1;
-                    break;
-                case COMMANDERTAX_COUNTER:
-                    state->playerState[state->selectedPlayer].commanderTaxCounter += 2;
-                    commanderTaxCounterChanged = 1;
-                    break;
-                default:
-                    printTextColor(12, 10, getScreenWidth(), COLOR_RED, 0, "UNKNOWN COUNTER");
-            };
+            counterChanged |= changeCounter(state, counter, counterType(counter)->step);
             commanderDamageOrCounterChanged = 1;
             changed = 1;
         }
@@ -1143,105 +1229,103 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
 
         state->triggerClearLifeChangedCurrentInFrames = 1;
         state->lifeChangedCurrent = 0;
-    } else if (lifeBefore != state->playerState[state->selectedPlayer].lifeCounter) {
+    } else if (lifeBefore != playerLife(&state->players, state->selectedPlayer)) {
         changed = 1;
         if (state->sfxEnabled) {
-            if (lifeBefore > 0 && state->playerState[state->selectedPlayer].lifeCounter <= 0) {
-                AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_death,
-                             AAS_DATA_SFX_END_death, NULL);
-            } else if (lifeBefore < state->playerState[state->selectedPlayer].lifeCounter) {
-                AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_ding,
-                             AAS_DATA_SFX_END_ding, NULL);
-            } else if (state->playerState[state->selectedPlayer].lifeCounter > 0) {
-                AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_hit,
-                             AAS_DATA_SFX_END_hit, NULL);
-            }
-        }
-    } else if (poisonCountersChanged && !stateChanged) {
-        if (state->sfxEnabled) {
-            if (state->playerState[state->selectedPlayer].poisonCounters >= 10 && poisonBefore < 10) {
-                AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_death,
-                             AAS_DATA_SFX_END_death, NULL);
-            } else {
-                AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_poison,
-                             AAS_DATA_SFX_END_poison, NULL);
+            if (lifeBefore > 0 && playerLife(&state->players, state->selectedPlayer) <= 0) {
+                audioPlaySfx(AUDIO_SFX_DEATH);
+            } else if (lifeBefore < playerLife(&state->players, state->selectedPlayer)) {
+                audioPlaySfx(AUDIO_SFX_DING);
+            } else if (playerLife(&state->players, state->selectedPlayer) > 0) {
+                audioPlaySfx(AUDIO_SFX_HIT);
             }
         }
-    } else if (energyCountersChanged && !stateChanged) {
+    } else if (counterChanged && !stateChanged) {
         if (state->sfxEnabled) {
-            AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_energy,
-                         AAS_DATA_SFX_END_energy, NULL);
-        }
-    } else if (experienceCountersChanged && !stateChanged) {
-        if (state->sfxEnabled) {
-            AAS_SFX_Play(0, 64, 16000, AAS_DATA_SFX_START_experience,
-                         AAS_DATA_SFX_END_experience, NULL);
+            playCounterSfx(state, selectedCounter(state), counterBefore);
         }
     }
-    // commander tax sound?
 
     if (changed) {
+        updateEliminations(state);
+
         if (state->maxPlayers == 1) {
-            if (shouldPrintPlayerRegular(state, 0)) {
+            // back from the list of a bigger game
+            scrollToSelection(state);
+
+            if (shouldPrintRegular(state)) {
                 if (!state->printedRegular) {
-                    clearScreen();
+                    scheduleClearScreen();
                 }
                 state->printedRegular = 1;
 
-                printLifeRegular(state, 0);
+                scheduleLife(state, 0);
             } else {
                 int screenCleared = 0;
-                if (state->printedRegular || (lifeBefore < 0 && state->playerState[0].lifeCounter >= 0)) {
-                    clearScreen();
+                if (state->printedRegular || (lifeBefore < 0 && playerLife(&state->players, 0) >= 0)) {
+                    scheduleClearScreen();
                     screenCleared = 1;
                 }
                 state->printedRegular = 0;
 
-                printLifeHuge(state, screenCleared || commanderDamageOrCounterChanged || selectedCommanderDamageChanged || poisonCountersChanged || energyCountersChanged || experienceCountersChanged || commanderTaxCounterChanged);
+                scheduleLife(state, 0);
+                if (screenCleared || commanderDamageOrCounterChanged || selectedCommanderDamageChanged || counterChanged) {
+                    scheduleCounters(0);
+                }
             }
-        } else if (state->maxPlayers <= 4) {
+        } else {
             int printRegular = shouldPrintRegular(state);
 
             int screenCleared = 0;
             if (state->printedRegular != printRegular) {
-                clearScreen();
+                scheduleClearScreen();
                 screenCleared = 1;
             }
 
             state->printedRegular = printRegular;
 
+            if (scrollToSelection(state) && !screenCleared) {
+                scheduleClearScreen();
+                screenCleared = 1;
+            }
+
+            // A selection that just moved is the dot moving and the look of
+            // the two players: new colors with player inks, otherwise only
+            // one that is out is drawn again. Their counters still move the
+            // selection mark.
+            int looksOnly = selectedPlayerChanged && !stateChanged && !screenCleared && !printRegular &&
+                            !lifeChanged && !commanderDamageOrCounterChanged;
+
+            if (looksOnly) {
+                showSelection(state);
+            }
+
+            // Only the players whose lives or marks changed are drawn, so
+            // however many there are a change costs the same.
             for (int i = 0; i < state->maxPlayers; i++) {
-                if (!selectedPlayerChanged && !screenCleared && i != state->selectedPlayer) {
+                int involved = i == state->selectedPlayer || (selectedPlayerChanged && i == selectedPlayerBefore);
+
+                if (!stateChanged && !screenCleared && !involved) {
                     continue;
                 }
 
-                if (printRegular) {
-                    printLifeRegular(state, i);
-                } else {
-                    int ud = 0;
-                    if (i < 2 && state->upsideDownNumbers) {
-                        ud = 1;
+                if (looksOnly) {
+                    if (!showPlayerLook(state, i) && isOut(state, i)) {
+                        scheduleLife(state, i);
                     }
-                    printLifeLarge(state, i, ud);
+                    scheduleCounters(i);
+                    continue;
                 }
-            }
-        } else {
-            if (selectedPlayerChanged && !stateChanged) {
-                printLifeRegular(state, selectedPlayerBefore);
-                printLifeRegular(state, state->selectedPlayer);
-            } else if (stateChanged) {
-                for (int i = 0; i < state->maxPlayers; i++) {
-                    printLifeRegular(state, i);
+
+                scheduleLife(state, i);
+                if (!printRegular) {
+                    scheduleCounters(i);
                 }
-            } else if (lifeChanged || commanderDamageOrCounterChanged || selectedCommanderDamageChanged || poisonCountersChanged || energyCountersChanged || experienceCountersChanged || commanderTaxCounterChanged) {
-                printLifeRegular(state, state->selectedPlayer);
             }
-
-            state->printedRegular = 1;
         }
 
         if (!skipLifeChanged && state->triggerClearLifeChangedCurrentInFrames > 0) {
-            printLifeChanged(state, 0);
+            showLifeChanged(state, 0);
         }
 
 
@@ -1255,7 +1339,7 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
         state->triggerClearLifeChangedCurrentInFrames--;
         if (state->triggerClearLifeChangedCurrentInFrames == 0) {
             state->lifeChangedCurrent = 0;
-            printLifeChanged(state, 1);
+            showLifeChanged(state, 1);
         }
     }
 
@@ -1263,10 +1347,10 @@ static int handleKeysCountLife(struct GameState *state, int keys_pressed, int ke
         state->triggerAutoSaveInFrames--;
         if (state->triggerAutoSaveInFrames == 0) {
             // autosave
-            saveState(state, 1);
-            printTextColor(19, 10, getScreenWidth(), COLOR_WHITE, 0, "Saved!");
+            saveState(state, SAVE_SLOT_AUTO);
+            showAutoSaveStatus(state, 0);
         } else if (state->triggerAutoSaveInFrames % 60 == 0) {
-            printTextColor(19, 10, getScreenWidth(), COLOR_WHITE, 0, "Saving in %d seconds.", (state->triggerAutoSaveInFrames / FPS) + 1);
+            showAutoSaveStatus(state, (state->triggerAutoSaveInFrames / FPS) + 1);
         }
     }
 
@@ -1281,26 +1365,28 @@ static int handleKeysMenu(struct GameState *state, int keys_pressed, int keys_re
     int sfxChanged = stateChanged;
 
     if (keys_released & KEY_START || keys_released & KEY_B) {
-        // reset the screen on transition
-        clearScreen();
+        leaveMenu(1);
 
         return STATE_COUNTLIFE;
     }
 
     if (keys_released & KEY_A) {
         if (state->selectedMenuItem == MENU_ITEM_QUIT) {
-            // reset the screen on transition
-            clearScreen();
+            leaveMenu(0);
+
+            // games where nothing happened aren't worth keeping
+            if (historyEventCount() > 0) {
+                archiveAppend(state, historyEventCount());
+            }
 
             initializeGameState(state);
 
             return STATE_SETUP;
         } else if (state->selectedMenuItem == MENU_ITEM_SAVE || state->selectedMenuItem == MENU_ITEM_SAVE_AND_QUIT) {
-            // reset the screen on transition
-            clearScreen();
+            leaveMenu(state->selectedMenuItem == MENU_ITEM_SAVE);
 
             // save
-            saveState(state, 0);
+            saveState(state, SAVE_SLOT_MANUAL);
 
             if (state->selectedMenuItem == MENU_ITEM_SAVE_AND_QUIT) {
                 initializeGameState(state);
@@ -1310,19 +1396,16 @@ static int handleKeysMenu(struct GameState *state, int keys_pressed, int keys_re
 
             return STATE_COUNTLIFE;
         } else if (state->selectedMenuItem == MENU_ITEM_RETURN) {
-            // reset the screen on transition
-            clearScreen();
+            leaveMenu(1);
 
             return STATE_COUNTLIFE;
         } else if (state->selectedMenuItem == MENU_ITEM_FLIP_TOP_NUMBERS) {
-            // reset the screen on transition
-            clearScreen();
+            leaveMenu(0);
 
             state->upsideDownNumbers = state->upsideDownNumbers ? 0 : 1;
             return STATE_COUNTLIFE;
         } else if (state->selectedMenuItem == MENU_ITEM_CONTROLS) {
-            // reset the screen on transition
-            clearScreen();
+            leaveMenu(0);
 
             state->stateToReturnTo = STATE_MENU;
 
@@ -1359,6 +1442,7 @@ static int handleKeysMenu(struct GameState *state, int keys_pressed, int keys_re
             }
         } else if (state->selectedMenuItem == MENU_ITEM_SFX) {
             state->sfxEnabled = state->sfxEnabled ? 0 : 1;
+            adjustBackgroundSong(state);
             sfxChanged = 1;
         }
     }
@@ -1372,6 +1456,7 @@ static int handleKeysMenu(struct GameState *state, int keys_pressed, int keys_re
             }
         } else if (state->selectedMenuItem == MENU_ITEM_SFX) {
             state->sfxEnabled = state->sfxEnabled ? 0 : 1;
+            adjustBackgroundSong(state);
             sfxChanged = 1;
         }
     }
@@ -1394,45 +1479,77 @@ static int handleKeysMenu(struct GameState *state, int keys_pressed, int keys_re
     return state->state;
 }
 
+static void printBootProfile(uint32_t audio, uint32_t save, uint32_t text, uint32_t firstMenu)
+{
+    debugPrintf("boot: audio %u us, save %u us, text %u us, first menu %u us",
+                (unsigned int) profileCyclesToMicroseconds(audio),
+                (unsigned int) profileCyclesToMicroseconds(save - audio),
+                (unsigned int) profileCyclesToMicroseconds(text - save),
+                (unsigned int) profileCyclesToMicroseconds(firstMenu));
+    debugPrintf("boot: audio mixer %u cycles/frame (%u%% of a frame)",
+                (unsigned int) audioMixerCycles(),
+                (unsigned int) (audioMixerCycles() * 100 / PROFILE_CYCLES_PER_FRAME));
+}
+
 int main(void)
 {
     struct GameState gameState;
+    uint32_t bootAudio, bootSave, bootText;
+    int firstFrame = 1;
+
+    placementInit();
+    memstatsInit();
+
+    // cycles are counted from here, everything before main isn't included
+    profileInit();
+    debugInit();
+
     initializeGameState(&gameState);
 
     // This isn't initialized in initializeGameState so that it won't get
     // reset by accident while a different song is playing.
     gameState.selectedBackgroundSong = 0;
 
-    AAS_SetConfig(AAS_CONFIG_MIX_32KHZ, AAS_CONFIG_CHANS_8,
-                  AAS_CONFIG_SPATIAL_STEREO, AAS_CONFIG_DYNAMIC_OFF);
+    audioInit();
+    renderInit();
+    adjustBackgroundSong(&gameState);
+    bootAudio = profileCycles();
 
-    irqInit();
-    irqSet(IRQ_TIMER1, AAS_Timer1InterruptHandler);
-    irqEnable(IRQ_VBLANK);
-
-    // TODO: make configureable?
-    AAS_MOD_SetVolume(48);
-    AAS_SFX_SetVolume(0, 255);
-    AAS_SFX_SetVolume(1, 255);
-
-    AAS_MOD_Play(AAS_DATA_MOD_drozerix___ai_renaissance);
+    saveInit();
+    archiveInit();
+    bootSave = profileCycles();
 
+    // the number fonts are set up when they are first drawn
     initializeText();
-    initializeHugeNumbers();
-    initializeLargeNumbers();
+    indicatorInit();
+    // the selected player's dot pulses once a second
+    indicatorPulse(INDICATOR_SELECTION, FPS);
+    bootText = profileCycles();
 
     while (1) {
         int keys_pressed, keys_released;
+        uint32_t frameStart, start;
 
         VBlankIntrWait();
+        indicatorFrame();
+        frameStart = profileCycles();
+
+        audioFrame();
+        renderFrameStart();
 
         scanKeys();
 
         keys_pressed = keysDown();
         keys_released = keysUp();
 
+        inputRecord(&gameState, keys_pressed, keys_released);
+
         int previousState = gameState.state;
 
+        // the render jobs pick their own layers
+        displaySetLayer(DISPLAY_LAYER_SCREEN);
+
+        start = profileCycles();
         switch (gameState.state) {
             case STATE_SETUP:
                 gameState.state = handleKeysSetup(&gameState, keys_pressed, keys_released);
@@ -1446,9 +1563,36 @@ int main(void)
             case STATE_CONTROLS:
                 gameState.state = handleKeysControls(&gameState, keys_pressed, keys_released);
                 break;
+            case STATE_STATS:
+                gameState.state = handleKeysStats(&gameState, keys_pressed, keys_released);
+                break;
+            case STATE_MEMORY:
+                gameState.state = handleKeysMemory(&gameState, keys_pressed, keys_released);
+                break;
         };
+        profileScopeAdd(PROFILE_SCOPE_INPUT, profileCycles() - start);
+
+        // whatever was queued belongs to the screen that was just left
+        if (gameState.state != previousState) {
+            renderCancel();
+        }
+        start = profileCycles();
+        renderRun(&gameState);
+        profileScopeAdd(PROFILE_SCOPE_RENDER, profileCycles() - start);
+
+        displayShowGame(gameState.state == STATE_COUNTLIFE);
+        indicatorsShown(gameState.state == STATE_COUNTLIFE);
 
         gameState.previousState = previousState;
+
+        profileScopeAdd(PROFILE_SCOPE_FRAME, profileCycles() - frameStart);
+        profileScopeFrame();
+        memstatsFrame();
+
+        if (firstFrame) {
+            printBootProfile(bootAudio, bootSave, bootText, profileCycles());
+            firstFrame = 0;
+        }
     }
 }
 
@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "memstats.h"
+#include "profile.h"
+
+static uint32_t allocated = 0;
+static uint32_t allocFailures = 0;
+static uint32_t frames = 0;
+static uint32_t loggedStackPeak = 0;
+static uint32_t loggedHeapSize = 0;
+static uint32_t loggedAllocated = 0;
+
+#ifdef HOST_BUILD
+// the host's stack and heap say nothing about the GBA's
+void memstatsInit(void)
+{
+}
+
+static void measure(struct MemoryStats *stats)
+{
+}
+#else
+#include <malloc.h>
+
+#define STACK_PAINT 0x5354414b
+// what memstatsInit itself may still need below where it was called
+#define STACK_PAINT_MARGIN 64
+
+#define IWRAM_START 0x03000000
+#define EWRAM_START 0x02000000
+#define ROM_START 0x08000000
+
+// from devkitARM's gba_cart.ld, weak so that a linker script without one
+// of them still links and the number is just 0. In IWRAM .data and the
+// overlays come after .bss, the stack starts past the last of them.
+extern char __bss_end__[] __attribute__((weak));
+extern char __iwram_overlay_end[] __attribute__((weak));
+extern char __sp_usr[] __attribute__((weak));
+extern char __end__[] __attribute__((weak));
+extern char __rom_end__[] __attribute__((weak));
+
+static uint32_t *stackBottom = NULL;
+static uintptr_t stackTop = 0;
+
+static const char *iwramEnd(void)
+{
+    return __iwram_overlay_end ? __iwram_overlay_end : __bss_end__;
+}
+
+void memstatsInit(void)
+{
+    uint32_t here;
+
+    if (!iwramEnd()) {
+        return;
+    }
+
+    stackBottom = (uint32_t *) (((uintptr_t) iwramEnd() + 3) & ~3);
+    stackTop = __sp_usr ? (uintptr_t) __sp_usr : (uintptr_t) &here;
+
+    for (volatile uint32_t *p = stackBottom; (uintptr_t) p < (uintptr_t) &here - STACK_PAINT_MARGIN; p++) {
+        *p = STACK_PAINT;
+    }
+}
+
+static uint32_t stackPeak(void)
+{
+    const uint32_t *p = stackBottom;
+
+    // the stack grows down, the first word that isn't paint is the deepest
+    while ((uintptr_t) p < stackTop && *p == STACK_PAINT) {
+        p++;
+    }
+
+    return stackTop - (uintptr_t) p;
+}
+
+static uint32_t endAbove(const char *end, uintptr_t start)
+{
+    return (uintptr_t) end > start ? (uintptr_t) end - start : 0;
+}
+
+static void measure(struct MemoryStats *stats)
+{
+    struct mallinfo info = mallinfo();
+
+    if (stackBottom) {
+        stats->stackSize = stackTop - (uintptr_t) stackBottom;
+        stats->stackPeak = stackPeak();
+    }
+
+    // the free chunk at the top is keepcost, the rest of the free space is
+    // in holes that only fit allocations up to their size
+    stats->heapSize = info.arena;
+    stats->heapFree = info.fordblks;
+    stats->heapHoles = info.ordblks > 0 ? info.ordblks - 1 : 0;
+    stats->heapHoleBytes = info.fordblks - info.keepcost;
+
+    stats->iwramUsed = endAbove(iwramEnd(), IWRAM_START);
+    stats->ewramUsed = endAbove(__end__, EWRAM_START);
+    stats->romUsed = endAbove(__rom_end__, ROM_START);
+}
+#endif
+
+void *memstatsAlloc(size_t size, const char *what)
+{
+    void *p = malloc(size);
+
+    if (!p) {
+        allocFailures++;
+        debugPrintf("memory: can't allocate %u bytes for %s", (unsigned int) size, what);
+        return NULL;
+    }
+
+    allocated += size;
+    return p;
+}
+
+void memstatsGet(struct MemoryStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    stats->allocated = allocated;
+    stats->allocFailures = allocFailures;
+    measure(stats);
+}
+
+void memstatsFrame(void)
+{
+    struct MemoryStats stats;
+
+    frames++;
+
+    if (frames % PROFILE_REPORT_FRAMES != 0 || !debugEnabled()) {
+        return;
+    }
+
+    memstatsGet(&stats);
+    if (frames != PROFILE_REPORT_FRAMES && stats.stackPeak <= loggedStackPeak && stats.heapSize <= loggedHeapSize &&
+        stats.allocated <= loggedAllocated) {
+        return;
+    }
+
+    debugPrintf("memory: %u %u %u %u %u %u %u", (unsigned int) frames,
+                (unsigned int) stats.stackPeak, (unsigned int) stats.stackSize,
+                (unsigned int) stats.allocated, (unsigned int) stats.heapSize,
+                (unsigned int) stats.heapFree, (unsigned int) stats.heapHoles);
+    loggedStackPeak = stats.stackPeak;
+    loggedHeapSize = stats.heapSize;
+    loggedAllocated = stats.allocated;
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef MEMSTATS_H__
+#define MEMSTATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// How much of IWRAM, EWRAM and ROM the game takes while it runs. The free
+// part of the IWRAM stack is painted at boot and the high-water mark is
+// whatever got overwritten since. The build checks the static side against
+// the budgets in placement.mk, see memory_budget.txt.
+//
+// Everything that can't be measured is 0, on the host that's the stack,
+// newlib's heap and the sections.
+#define MEMSTATS_IWRAM_SIZE 32768
+#define MEMSTATS_EWRAM_SIZE 262144
+
+struct MemoryStats {
+    // the user stack, from below the IRQ stack down to the end of the IWRAM
+    // overlays, which come after .bss and .data
+    uint32_t stackSize;
+    uint32_t stackPeak;
+    // what went through memstatsAlloc, nothing is ever freed
+    uint32_t allocated;
+    uint32_t allocFailures;
+    // newlib's heap in EWRAM, also holding what libraries allocated: how
+    // far it grew, how much of that is free and how much of the free space
+    // is in holes below the top instead of at its end
+    uint32_t heapSize;
+    uint32_t heapFree;
+    uint32_t heapHoles;
+    uint32_t heapHoleBytes;
+    // code and data from the linker script symbols, ROM is 0 if it has none
+    uint32_t iwramUsed;
+    uint32_t ewramUsed;
+    uint32_t romUsed;
+};
+
+// Paints the stack, call first thing in main before much of it is used.
+void memstatsInit(void);
+
+// malloc that counts what the game allocated and logs failures, callers
+// still have to handle NULL.
+void *memstatsAlloc(size_t size, const char *what);
+
+void memstatsGet(struct MemoryStats *stats);
+
+// Call at the end of every frame. Every PROFILE_REPORT_FRAMES frames the
+// stack peak and the heap go to the debug log if they grew:
+//   memory: <frame> <stack peak> <stack size> <allocated> <heap size> <heap free> <holes>
+void memstatsFrame(void);
+
+#endif
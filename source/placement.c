@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef HOST_BUILD
+#include <tonc.h>
+#endif
+
+#include "placement.h"
+
+void placementInit(void)
+{
+#ifndef HOST_BUILD
+    // 3/1 ROM waitstates instead of 4/2, like most commercial games use, and
+    // the prefetch buffer, it fetches ahead while the CPU isn't on the ROM
+    // bus. The save chip needs 8 waitstates, see saveChipInit.
+    REG_WAITCNT = WS_SRAM_8 | WS_ROM0_N3 | WS_ROM0_S1 | WS_PREFETCH;
+#endif
+}
@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef PLACEMENT_H__
+#define PLACEMENT_H__
+
+// Where code and data live on the GBA. Everything is Thumb code in ROM by
+// default, which has a 16 bit bus and waitstates. The functions that take
+// most of the frame (IWRAM_FUNCTIONS in placement.mk, from make bench) are
+// ARM code in IWRAM instead, 32 bit and no waitstates; they have to be
+// marked on the declaration as well, callers need the long call. Large
+// buffers that are rarely touched go to EWRAM to leave IWRAM to the code and
+// the stack. The build prints what's left of both.
+#ifdef HOST_BUILD
+#define IWRAM_ARM
+#define EWRAM_BSS
+#else
+#include <tonc_types.h>
+
+#define IWRAM_ARM IWRAM_CODE __attribute__((target("arm")))
+#endif
+
+// Sets up the ROM waitstates and the prefetch buffer, first thing in main.
+void placementInit(void);
+
+#endif
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include "debug.h"
+#include "profile.h"
+
+struct ProfileScope {
+    uint32_t calls;
+    uint32_t total;
+    uint32_t worst;
+};
+
+static const char *scopeNames[PROFILE_SCOPES] = { "frame", "input", "render", "save" };
+static struct ProfileScope scopes[PROFILE_SCOPES];
+static uint32_t frames = 0;
+
+#ifdef HOST_BUILD
+#include <time.h>
+
+// host time scaled to GBA cycles, only comparable with other host numbers
+static struct timespec start;
+
+void profileInit(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start);
+}
+
+uint32_t profileCycles(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    int64_t ns = (int64_t) (now.tv_sec - start.tv_sec) * 1000000000 + (now.tv_nsec - start.tv_nsec);
+
+    return (uint32_t) (uint64_t) ((double) ns * PROFILE_CYCLES_PER_SECOND / 1e9);
+}
+#else
+#include <tonc.h>
+
+void profileInit(void)
+{
+    REG_TM2CNT = 0;
+    REG_TM3CNT = 0;
+    REG_TM2D = 0;
+    REG_TM3D = 0;
+    REG_TM3CNT = TM_ENABLE | TM_CASCADE;
+    REG_TM2CNT = TM_ENABLE | TM_FREQ_1;
+}
+
+uint32_t profileCycles(void)
+{
+    u16 hi, lo;
+
+    // the low half can overflow between the two reads
+    do {
+        hi = REG_TM3D;
+        lo = REG_TM2D;
+    } while (hi != REG_TM3D);
+
+    return (hi << 16) | lo;
+}
+#endif
+
+uint32_t profileCyclesToMicroseconds(uint32_t cycles)
+{
+    return ((uint64_t) cycles * 1000000) / PROFILE_CYCLES_PER_SECOND;
+}
+
+void profileScopeAdd(int scope, uint32_t cycles)
+{
+    scopes[scope].calls++;
+    scopes[scope].total += cycles;
+    if (cycles > scopes[scope].worst) {
+        scopes[scope].worst = cycles;
+    }
+}
+
+void profileScopeFrame(void)
+{
+    frames++;
+
+    if (frames % PROFILE_REPORT_FRAMES != 0) {
+        return;
+    }
+
+    for (int i = 0; i < PROFILE_SCOPES; i++) {
+        if (scopes[i].calls > 0) {
+            debugPrintf("profile: %u %s %u %u %u", (unsigned int) frames, scopeNames[i],
+                        (unsigned int) scopes[i].calls, (unsigned int) scopes[i].total,
+                        (unsigned int) scopes[i].worst);
+        }
+
+        scopes[i].calls = 0;
+        scopes[i].total = 0;
+        scopes[i].worst = 0;
+    }
+}
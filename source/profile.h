@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef PROFILE_H__
+#define PROFILE_H__
+
+#include <stdint.h>
+
+// Free running cycle counter on timers 2 and 3 (AAS has 0 and 1).
+#define PROFILE_CYCLES_PER_SECOND 16777216
+#define PROFILE_CYCLES_PER_FRAME 280896
+
+void profileInit(void);
+uint32_t profileCycles(void);
+uint32_t profileCyclesToMicroseconds(uint32_t cycles);
+
+// Cycles spent in parts of the frame, summed up and written to the debug log
+// every PROFILE_REPORT_FRAMES frames, one line per scope that ran:
+//   profile: <frame> <scope> <calls> <total> <worst>
+// perf/ checks them against baselines. Scopes nest, input includes save.
+#define PROFILE_REPORT_FRAMES 64
+
+enum PROFILE_SCOPE {
+    // from the VBlank until the game waits for the next one
+    PROFILE_SCOPE_FRAME = 0,
+    // handling the keys of the current screen
+    PROFILE_SCOPE_INPUT,
+    PROFILE_SCOPE_RENDER,
+    PROFILE_SCOPE_SAVE,
+    PROFILE_SCOPES,
+};
+
+void profileScopeAdd(int scope, uint32_t cycles);
+// Call at the end of every frame, after the frame scope was added.
+void profileScopeFrame(void);
+
+#endif
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <gba_interrupt.h>
+
+#include <stdint.h>
+
+#include "audio.h"
+#include "debug.h"
+#include "profile.h"
+#include "render.h"
+
+// Every player's life and counters, the clear bands and a few status lines.
+#define RENDER_MAX_JOBS 32
+
+// Drawing stops once this much of the frame (counted from the VBlank) is
+// gone, what's left is for the mixer interrupts and getting back to
+// VBlankIntrWait before the next VBlank.
+#define RENDER_BUDGET_CYCLES (PROFILE_CYCLES_PER_FRAME * 3 / 4)
+
+struct RenderEntry {
+    struct RenderJob *job;
+    int arg;
+    int priority;
+    // jobs of the same priority run in the order they were queued
+    uint32_t sequence;
+};
+
+static struct RenderEntry queue[RENDER_MAX_JOBS];
+static int queued = 0;
+static uint32_t sequence = 0;
+
+static volatile uint32_t vblanks = 0;
+static uint32_t lastVblank = 0;
+static uint32_t frameStart = 0;
+static uint32_t overrunFrames = 0;
+static uint32_t lastUnderruns = 0;
+static uint32_t budget = RENDER_BUDGET_CYCLES;
+
+static void renderVBlankInterruptHandler(void)
+{
+    vblanks++;
+}
+
+void renderInit(void)
+{
+    irqSet(IRQ_VBLANK, renderVBlankInterruptHandler);
+    irqEnable(IRQ_VBLANK);
+
+    lastVblank = vblanks;
+}
+
+void renderSchedule(struct RenderJob *job, int arg, int priority)
+{
+    for (int i = 0; i < queued; i++) {
+        if (queue[i].job == job && queue[i].arg == arg) {
+            if (priority < queue[i].priority) {
+                queue[i].priority = priority;
+            }
+            return;
+        }
+    }
+
+    if (queued == RENDER_MAX_JOBS) {
+        // can't happen with the jobs there are
+        debugPrintf("render: queue full, dropped %s", job->name);
+        return;
+    }
+
+    queue[queued].job = job;
+    queue[queued].arg = arg;
+    queue[queued].priority = priority;
+    queue[queued].sequence = sequence++;
+    queued++;
+}
+
+void renderCancel(void)
+{
+    queued = 0;
+}
+
+int renderPending(void)
+{
+    return queued;
+}
+
+void renderFrameStart(void)
+{
+    uint32_t now = vblanks;
+    uint32_t underruns = audioUnderruns();
+
+    frameStart = profileCycles();
+
+    if (now - lastVblank > 1) {
+        overrunFrames += now - lastVblank - 1;
+        debugPrintf("render: missed %u VBlanks, %u overrun frames so far",
+                    (unsigned int) (now - lastVblank - 1), (unsigned int) overrunFrames);
+    }
+    lastVblank = now;
+
+    if (underruns != lastUnderruns) {
+        debugPrintf("render: %u audio underruns so far, %d jobs queued",
+                    (unsigned int) underruns, queued);
+        lastUnderruns = underruns;
+    }
+}
+
+void renderRun(struct GameState *state)
+{
+    int ran = 0;
+
+    while (queued > 0) {
+        int next = 0;
+
+        for (int i = 1; i < queued; i++) {
+            if (queue[i].priority < queue[next].priority ||
+                (queue[i].priority == queue[next].priority && queue[i].sequence < queue[next].sequence)) {
+                next = i;
+            }
+        }
+
+        struct RenderJob *job = queue[next].job;
+        int arg = queue[next].arg;
+        uint32_t start = profileCycles();
+
+        if (ran > 0 && start - frameStart + job->worstCycles > budget) {
+            break;
+        }
+
+        queue[next] = queue[--queued];
+
+        job->draw(state, arg);
+        ran++;
+
+        uint32_t cycles = profileCycles() - start;
+        if (cycles > job->worstCycles) {
+            job->worstCycles = cycles;
+        }
+    }
+}
+
+void renderSetBudget(uint32_t cycles)
+{
+    budget = cycles;
+}
+
+uint32_t renderOverrunFrames(void)
+{
+    return overrunFrames;
+}
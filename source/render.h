@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef RENDER_H__
+#define RENDER_H__
+
+#include <stdint.h>
+
+#include "gamestate.h"
+
+// Drawing while counting life is queued as jobs that run after the input of
+// the frame was handled, the most important first and only as long as the
+// frame has time left, so the audio interrupt always gets its share. Whatever
+// doesn't fit waits for the next frame. A job draws from the game state as it
+// is when it runs, queueing it again before that only changes its priority.
+
+struct RenderJob {
+    void (*draw)(struct GameState *state, int arg);
+    const char *name;
+    // the longest a single run took so far, a job only starts if that fits
+    uint32_t worstCycles;
+};
+
+enum RENDER_PRIORITY {
+    RENDER_PRIORITY_CLEAR = 0,
+    RENDER_PRIORITY_SELECTED,
+    RENDER_PRIORITY_LIFE,
+    RENDER_PRIORITY_DECORATION,
+};
+
+// Call after audioInit, the VBlank interrupt counts the frames.
+void renderInit(void);
+
+void renderSchedule(struct RenderJob *job, int arg, int priority);
+// Drops all queued jobs, for when the screen is taken over by something else.
+void renderCancel(void);
+int renderPending(void);
+
+// Call right after VBlankIntrWait, the frame's budget starts there.
+void renderFrameStart(void);
+// Runs queued jobs until the budget is spent, at least one per frame.
+void renderRun(struct GameState *state);
+// Cycles of the frame the jobs may use, counted from renderFrameStart. The
+// host replay lifts it so that a run doesn't depend on the speed of the host.
+void renderSetBudget(uint32_t cycles);
+
+// Frames that didn't make it to the next VBlank in time.
+uint32_t renderOverrunFrames(void);
+
+#endif
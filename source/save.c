@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <string.h>
+
+#include "save.h"
+#include "savechip.h"
+
+#define SAVE_RECORD_MAGIC 0x3141424d // "MBA1"
+
+struct SaveRecordHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t length;
+    uint16_t crc;
+};
+
+_Static_assert(sizeof(struct SaveRecordHeader) == SAVE_RECORD_HEADER_SIZE, "SAVE_RECORD_HEADER_SIZE is the header");
+
+struct SaveRegion {
+    int firstSector;
+    int sectors;
+    uint32_t recordSize;
+};
+
+// Everything has to fit into 32 KB because that's all we dare to assume
+// for SRAM. Autosaves happen a lot more often, so they get more sectors to
+// spread the erases over.
+static const struct SaveRegion regions[SAVE_SLOTS] = {
+    [SAVE_SLOT_MANUAL] = { 0, 2, SAVE_MANUAL_RECORD_SIZE },
+    [SAVE_SLOT_AUTO] = { 2, 4, SAVE_AUTO_RECORD_SIZE }, // game state and undo history
+    [SAVE_SLOT_ARCHIVE] = { 6, 2, SAVE_ARCHIVE_RECORD_SIZE }, // finished games, oldest ones drop out
+};
+
+struct SaveSlotCache {
+    int scanned;
+    int latest; // record index or -1
+    uint32_t sequence;
+    uint16_t length;
+};
+
+static struct SaveSlotCache cache[SAVE_SLOTS];
+
+static uint16_t crc16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= data[i] << 8;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+
+    return crc;
+}
+
+static int recordsPerSector(const struct SaveRegion *region)
+{
+    return SAVECHIP_SECTOR_SIZE / region->recordSize;
+}
+
+static int recordCount(const struct SaveRegion *region)
+{
+    return region->sectors * recordsPerSector(region);
+}
+
+static uint32_t recordOffset(const struct SaveRegion *region, int record)
+{
+    int sector = region->firstSector + record / recordsPerSector(region);
+    return sector * SAVECHIP_SECTOR_SIZE + (record % recordsPerSector(region)) * region->recordSize;
+}
+
+static uint16_t recordCrc(const struct SaveRecordHeader *header, uint32_t offset)
+{
+    uint8_t buf[64];
+    uint16_t crc = crc16(0xffff, (const uint8_t *) &header->sequence, sizeof(header->sequence) + sizeof(header->length));
+
+    for (uint32_t done = 0; done < header->length; done += sizeof(buf)) {
+        uint32_t n = header->length - done;
+        if (n > sizeof(buf)) {
+            n = sizeof(buf);
+        }
+        saveChipRead(offset + sizeof(*header) + done, buf, n);
+        crc = crc16(crc, buf, n);
+    }
+
+    return crc;
+}
+
+static int recordValid(const struct SaveRegion *region, int record, struct SaveRecordHeader *header)
+{
+    uint32_t offset = recordOffset(region, record);
+
+    saveChipRead(offset, header, sizeof(*header));
+    if (header->magic != SAVE_RECORD_MAGIC || header->length > region->recordSize - sizeof(*header)) {
+        return 0;
+    }
+
+    return recordCrc(header, offset) == header->crc;
+}
+
+static int recordBlank(const struct SaveRegion *region, int record)
+{
+    uint32_t offset = recordOffset(region, record);
+
+    for (uint32_t i = 0; i < region->recordSize; i++) {
+        uint8_t b;
+        saveChipRead(offset + i, &b, 1);
+        if (b != 0xff) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static struct SaveSlotCache *scanSlot(int slot)
+{
+    struct SaveSlotCache *c = &cache[slot];
+    const struct SaveRegion *region = &regions[slot];
+
+    if (c->scanned) {
+        return c;
+    }
+
+    c->scanned = 1;
+    c->latest = -1;
+
+    for (int i = 0; i < recordCount(region); i++) {
+        struct SaveRecordHeader header;
+        if (!recordValid(region, i, &header)) {
+            continue;
+        }
+        // sequence numbers only grow, compare by difference to survive the wrap
+        if (c->latest < 0 || (int32_t) (header.sequence - c->sequence) > 0) {
+            c->latest = i;
+            c->sequence = header.sequence;
+            c->length = header.length;
+        }
+    }
+
+    return c;
+}
+
+int saveInit(void)
+{
+    memset(cache, 0, sizeof(cache));
+
+    return saveChipInit() != SAVECHIP_NONE;
+}
+
+int saveSlotValid(int slot)
+{
+    return scanSlot(slot)->latest >= 0;
+}
+
+uint32_t saveSlotCapacity(int slot)
+{
+    return regions[slot].recordSize - sizeof(struct SaveRecordHeader);
+}
+
+uint32_t saveSlotRead(int slot, void *data, uint32_t len)
+{
+    struct SaveSlotCache *c = scanSlot(slot);
+
+    if (c->latest < 0) {
+        return 0;
+    }
+
+    if (len > c->length) {
+        len = c->length;
+    }
+
+    saveChipRead(recordOffset(&regions[slot], c->latest) + sizeof(struct SaveRecordHeader), data, len);
+
+    return c->length;
+}
+
+int saveSlotWrite(int slot, const void *data, uint32_t len)
+{
+    struct SaveSlotCache *c = scanSlot(slot);
+    const struct SaveRegion *region = &regions[slot];
+    int record = c->latest;
+
+    if (len > saveSlotCapacity(slot)) {
+        return 0;
+    }
+
+    // Find the next record after the newest one that can be written without
+    // touching it. Starting a new sector erases that sector, which only ever
+    // holds older records as long as a region has at least 2 sectors.
+    for (int tries = 0; tries < recordCount(region); tries++) {
+        record = (record + 1) % recordCount(region);
+
+        if (record % recordsPerSector(region) == 0) {
+            if (!saveChipEraseSector(recordOffset(region, record))) {
+                return 0;
+            }
+            break;
+        }
+
+        if (recordBlank(region, record)) {
+            break;
+        }
+    }
+
+    struct SaveRecordHeader header;
+    uint32_t offset = recordOffset(region, record);
+
+    header.magic = SAVE_RECORD_MAGIC;
+    header.sequence = c->latest >= 0 ? c->sequence + 1 : 0;
+    header.length = len;
+    header.crc = crc16(crc16(0xffff, (const uint8_t *) &header.sequence, sizeof(header.sequence) + sizeof(header.length)), data, len);
+
+    // the magic goes in last, a record without it is never looked at
+    if (!saveChipWrite(offset + sizeof(header), data, len) ||
+        !saveChipWrite(offset + sizeof(header.magic), &header.sequence, sizeof(header) - sizeof(header.magic)) ||
+        !saveChipWrite(offset, &header.magic, sizeof(header.magic))) {
+        return 0;
+    }
+
+    c->latest = record;
+    c->sequence = header.sequence;
+    c->length = len;
+
+    return 1;
+}
@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef SAVE_H__
+#define SAVE_H__
+
+#include <stdint.h>
+
+// Save slots on top of the save chip. Each slot is a log of records spread
+// over a few sectors, a new record never overwrites the newest valid one so
+// losing power in the middle of a save keeps the previous state.
+
+enum SAVE_SLOT {
+    SAVE_SLOT_MANUAL = 0,
+    SAVE_SLOT_AUTO,
+    SAVE_SLOT_ARCHIVE,
+    SAVE_SLOTS,
+};
+
+// The size of a record of each slot, what's saved into it has to fit
+// SAVE_CAPACITY of that, the header takes the rest.
+#define SAVE_MANUAL_RECORD_SIZE 0x400
+#define SAVE_AUTO_RECORD_SIZE 0x800
+#define SAVE_ARCHIVE_RECORD_SIZE 0x200
+#define SAVE_RECORD_HEADER_SIZE 12
+#define SAVE_CAPACITY(recordSize) ((recordSize) - SAVE_RECORD_HEADER_SIZE)
+
+int saveInit(void);
+// returns 1 when the slot holds a valid record
+int saveSlotValid(int slot);
+// returns 1 on success, len must not exceed saveSlotCapacity()
+int saveSlotWrite(int slot, const void *data, uint32_t len);
+// returns the length of the stored record or 0 if there is none
+uint32_t saveSlotRead(int slot, void *data, uint32_t len);
+uint32_t saveSlotCapacity(int slot);
+
+#endif
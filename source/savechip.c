@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#include <string.h>
+
+#include "savechip.h"
+
+// command addresses shared by the Macronix, Panasonic, Sanyo and SST chips
+#define FLASH_CMD_ADDR1 0x5555
+#define FLASH_CMD_ADDR2 0x2aaa
+
+#define FLASH_CMD_ERASE 0x80
+#define FLASH_CMD_ERASE_SECTOR 0x30
+#define FLASH_CMD_ID 0x90
+#define FLASH_CMD_PROGRAM 0xa0
+#define FLASH_CMD_BANK 0xb0
+#define FLASH_CMD_RESET 0xf0
+
+// upper bound on status reads before giving up on the chip
+#define FLASH_PROGRAM_POLL_LIMIT 0x10000
+#define FLASH_ERASE_POLL_LIMIT 0x400000
+
+#ifndef HOST_BUILD
+#define SAVE_BUS ((volatile uint8_t *) 0x0e000000)
+#define REG_WAITCNT_SRAM (*(volatile uint16_t *) 0x04000204)
+
+uint8_t saveBusRead(uint32_t addr)
+{
+    return SAVE_BUS[addr];
+}
+
+void saveBusWrite(uint32_t addr, uint8_t value)
+{
+    SAVE_BUS[addr] = value;
+}
+#endif
+
+static int chipType = SAVECHIP_NONE;
+static int currentBank = 0;
+
+static void flashCommand(uint8_t cmd)
+{
+    saveBusWrite(FLASH_CMD_ADDR1, 0xaa);
+    saveBusWrite(FLASH_CMD_ADDR2, 0x55);
+    saveBusWrite(FLASH_CMD_ADDR1, cmd);
+}
+
+static void flashSelectBank(int bank)
+{
+    if (chipType != SAVECHIP_FLASH128K || bank == currentBank) {
+        return;
+    }
+
+    flashCommand(FLASH_CMD_BANK);
+    saveBusWrite(0, bank);
+    currentBank = bank;
+}
+
+static int flashWaitFor(uint32_t addr, uint8_t value, int limit)
+{
+    while (limit--) {
+        if (saveBusRead(addr) == value) {
+            return 1;
+        }
+    }
+
+    // some chips stay in the failed command until they are reset
+    flashCommand(FLASH_CMD_RESET);
+    return 0;
+}
+
+static int isKnownFlash(uint8_t manufacturer, uint8_t device)
+{
+    if ((manufacturer == 0xc2 && device == 0x09) || (manufacturer == 0x62 && device == 0x13)) {
+        return SAVECHIP_FLASH128K;
+    }
+
+    if ((manufacturer == 0xc2 && device == 0x1c) || (manufacturer == 0x32 && device == 0x1b) || (manufacturer == 0xbf && device == 0xd4)) {
+        return SAVECHIP_FLASH64K;
+    }
+
+    // Atmel (0x1f, 0x3d) uses 128 byte page writes and is not supported.
+    return SAVECHIP_NONE;
+}
+
+int saveChipInit(void)
+{
+#ifndef HOST_BUILD
+    // flash needs 8 waitstates on the SRAM bus
+    REG_WAITCNT_SRAM |= 3;
+#endif
+
+    // The ID command writes to 0x5555 and 0x2aaa, which on SRAM is just
+    // data, so remember those bytes and put them back if nobody answers.
+    uint8_t backup1 = saveBusRead(FLASH_CMD_ADDR1);
+    uint8_t backup2 = saveBusRead(FLASH_CMD_ADDR2);
+    uint8_t before0 = saveBusRead(0);
+    uint8_t before1 = saveBusRead(1);
+
+    flashCommand(FLASH_CMD_ID);
+    uint8_t manufacturer = saveBusRead(0);
+    uint8_t device = saveBusRead(1);
+    flashCommand(FLASH_CMD_RESET);
+
+    chipType = SAVECHIP_NONE;
+    if (manufacturer != before0 || device != before1) {
+        chipType = isKnownFlash(manufacturer, device);
+    }
+
+    if (chipType == SAVECHIP_NONE) {
+        saveBusWrite(FLASH_CMD_ADDR1, backup1);
+        saveBusWrite(FLASH_CMD_ADDR2, backup2);
+        chipType = SAVECHIP_SRAM;
+    }
+
+    currentBank = -1;
+    flashSelectBank(0);
+
+    return chipType;
+}
+
+int saveChipType(void)
+{
+    return chipType;
+}
+
+uint32_t saveChipSize(void)
+{
+    switch (chipType) {
+        case SAVECHIP_SRAM:
+            // can't tell 32 KB from 64 KB SRAM (mirroring), assume the small one
+            return 0x8000;
+        case SAVECHIP_FLASH64K:
+            return 0x10000;
+        case SAVECHIP_FLASH128K:
+            return 0x20000;
+    };
+
+    return 0;
+}
+
+void saveChipRead(uint32_t offset, void *dst, uint32_t len)
+{
+    uint8_t *out = dst;
+
+    for (uint32_t i = 0; i < len; i++) {
+        flashSelectBank((offset + i) / SAVECHIP_BANK_SIZE);
+        out[i] = saveBusRead((offset + i) % SAVECHIP_BANK_SIZE);
+    }
+}
+
+int saveChipEraseSector(uint32_t offset)
+{
+    uint32_t base = offset - offset % SAVECHIP_SECTOR_SIZE;
+
+    if (chipType == SAVECHIP_SRAM) {
+        for (uint32_t i = 0; i < SAVECHIP_SECTOR_SIZE; i++) {
+            saveBusWrite(base + i, 0xff);
+        }
+        return 1;
+    }
+
+    flashSelectBank(base / SAVECHIP_BANK_SIZE);
+    base %= SAVECHIP_BANK_SIZE;
+
+    flashCommand(FLASH_CMD_ERASE);
+    saveBusWrite(FLASH_CMD_ADDR1, 0xaa);
+    saveBusWrite(FLASH_CMD_ADDR2, 0x55);
+    saveBusWrite(base, FLASH_CMD_ERASE_SECTOR);
+
+    return flashWaitFor(base, 0xff, FLASH_ERASE_POLL_LIMIT);
+}
+
+int saveChipWrite(uint32_t offset, const void *src, uint32_t len)
+{
+    const uint8_t *in = src;
+
+    for (uint32_t i = 0; i < len; i++) {
+        uint32_t addr = (offset + i) % SAVECHIP_BANK_SIZE;
+
+        if (chipType == SAVECHIP_SRAM) {
+            saveBusWrite(addr, in[i]);
+            continue;
+        }
+
+        // programming can only clear bits, erased bytes need no work
+        if (in[i] == 0xff) {
+            continue;
+        }
+
+        flashSelectBank((offset + i) / SAVECHIP_BANK_SIZE);
+        flashCommand(FLASH_CMD_PROGRAM);
+        saveBusWrite(addr, in[i]);
+
+        if (!flashWaitFor(addr, in[i], FLASH_PROGRAM_POLL_LIMIT)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
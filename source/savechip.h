@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+#ifndef SAVECHIP_H__
+#define SAVECHIP_H__
+
+#include <stdint.h>
+
+// Driver for the cartridge save chip (SRAM or 64/128 KB flash).
+
+#define SAVECHIP_SECTOR_SIZE 0x1000
+#define SAVECHIP_BANK_SIZE 0x10000
+
+enum SAVECHIP_TYPE {
+    SAVECHIP_NONE = 0,
+    SAVECHIP_SRAM,
+    SAVECHIP_FLASH64K,
+    SAVECHIP_FLASH128K,
+};
+
+// probes the chip, returns one of SAVECHIP_TYPE
+int saveChipInit(void);
+int saveChipType(void);
+uint32_t saveChipSize(void);
+void saveChipRead(uint32_t offset, void *dst, uint32_t len);
+// returns 1 on success, 0 when the chip did not finish in time
+int saveChipEraseSector(uint32_t offset);
+// on flash the target has to be erased first
+int saveChipWrite(uint32_t offset, const void *src, uint32_t len);
+
+// Raw byte access to the save bus (0x0e000000), provided by the platform.
+// On the GBA these are in savechip.c, the host build gets them from the
+// flash simulator.
+uint8_t saveBusRead(uint32_t addr);
+void saveBusWrite(uint32_t addr, uint8_t value);
+
+#endif
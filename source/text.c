@@ -9,44 +9,32 @@
 #include <tonc.h>
 #include <tonc_video.h>
 
+#include "display.h"
+#include "indicator.h"
 #include "text.h"
-#include "tonc_ext.h"
 
 #define MAX_TEXT_LEN 256
 
-#define TOTAL_SYMBOLS_IN_SURFACE 12
 #define MINUS_POSITION 10
 #define DOT_POSITION 11
 
-extern u16 VCR_OSD_MONO_NUMBERS_HUGE[];
-extern u32 VCR_OSD_MONO_NUMBERS_HUGE_SIZE;
-extern u16 VCR_OSD_MONO_NUMBERS_LARGE[];
-extern u32 VCR_OSD_MONO_NUMBERS_LARGE_SIZE;
+// The digits of a number with the minus, and after them the dot. A number
+// with more than that is drawn in the next smaller font, in as many
+// FALLBACK_SLOTS as fit the same place.
+#define NUMBER_SLOTS 3
+#define FALLBACK_SLOTS 5
+#define FALLBACK_SPOTS 16
 
-static TSurface surface_huge_numbers;
-static TSurface surface_large_numbers;
-static TSurface surface_large_numbers_red;
-static TSurface surface_large_numbers_blue;
-static TSurface surface_large_numbers_orange;
-static TSurface surface_large_numbers_magenta;
-static TSurface surface_large_numbers_green;
-
-#define VCR_OSD_MONO_NUMBERS_HUGE_WIDTH 60
-#define VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT 104
-
-#define VCR_OSD_MONO_NUMBERS_LARGE_WIDTH 30
-#define VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT 52
-
-u16 *VCR_OSD_MONO_NUMBERS_LARGE_RED = 0;
-u16 *VCR_OSD_MONO_NUMBERS_LARGE_BLUE = 0;
-u16 *VCR_OSD_MONO_NUMBERS_LARGE_ORANGE = 0;
-u16 *VCR_OSD_MONO_NUMBERS_LARGE_MAGENTA = 0;
-u16 *VCR_OSD_MONO_NUMBERS_LARGE_GREEN = 0;
+static const int fallbackFonts[] = {
+    [DISPLAY_FONT_HUGE] = DISPLAY_FONT_LARGE,
+    [DISPLAY_FONT_LARGE] = DISPLAY_FONT_MEDIUM,
+    [DISPLAY_FONT_MEDIUM] = DISPLAY_FONT_SMALL,
+    [DISPLAY_FONT_SMALL] = -1,
+};
 
 void initializeText()
 {
-    tte_init_bmp(3, &sys8Font, NULL);
-    REG_DISPCNT = DCNT_MODE3 | DCNT_BG2;
+    displayInit();
 }
 
 int convertColor(int col)
@@ -96,6 +84,8 @@ int convertColor(int col)
     return color;
 }
 
+static void writeText(int row, int column, int fillcolumn, int ud, char *buf);
+
 void printTextColor(int row, int column, int fillcolumn, int col, int ud, char *fmt, ...)
 {
     va_list args;
@@ -105,57 +95,66 @@ void printTextColor(int row, int column, int fillcolumn, int col, int ud, char *
     vsnprintf(buf, MAX_TEXT_LEN, fmt, args);
     va_end(args);
 
-    tte_set_color(TTE_INK, convertColor(col));
-    printText(row, column, fillcolumn, ud, buf);
+    displaySetInk(convertColor(col));
+    writeText(row, column, fillcolumn, ud, buf);
 }
 
 int getGlyphWidth(void)
 {
-    return tte_get_glyph_width(0);
+    return displayGlyphWidth();
 }
 
 int getGlyphHeight(void)
 {
-    return tte_get_glyph_height(0);
+    return displayGlyphHeight();
 }
 
 int getLargeGlyphWidth(void)
 {
-    return VCR_OSD_MONO_NUMBERS_LARGE_WIDTH;
+    return displayFontWidth(DISPLAY_FONT_LARGE);
 }
 
 int getLargeGlyphHeight(void)
 {
-    return VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT;
+    return displayFontHeight(DISPLAY_FONT_LARGE);
+}
+
+int getMediumGlyphWidth(void)
+{
+    return displayFontWidth(DISPLAY_FONT_MEDIUM);
+}
+
+int getMediumGlyphHeight(void)
+{
+    return displayFontHeight(DISPLAY_FONT_MEDIUM);
 }
 
 int getScreenWidth(void)
 {
-    return M3_WIDTH;
+    return SCREEN_WIDTH;
 }
 
 int getScreenHeight(void)
 {
-    return M3_HEIGHT;
+    return SCREEN_HEIGHT;
 }
 
 void printText(int row, int column, int fillcolumn, int ud, char *fmt, ...)
 {
     va_list args;
     char buf[MAX_TEXT_LEN];
-    int h, gh;
 
     va_start(args, fmt);
     vsnprintf(buf, MAX_TEXT_LEN, fmt, args);
     va_end(args);
 
-    gh = tte_get_glyph_height(0);
-    h = row * gh;
-    if (ud) {
-        tte_set_pos(column, h + gh);
-        TTC *tc = tte_get_context();
-        sbmp16_rect(&tc->dst, column, h, column + fillcolumn, h + gh, tc->cattr[TTE_PAPER]);
+    writeText(row, column, fillcolumn, ud, buf);
+}
 
+// buf has room for MAX_TEXT_LEN, upside down it's padded in place
+static void writeText(int row, int column, int fillcolumn, int ud, char *buf)
+{
+    if (ud) {
         int textlen = 0;
         for (int i = 0; i < strlen(buf); i++) {
             if ((buf[i] == '#') && (i + 1 < strlen(buf)) && (buf[i+1] == '{')) {
@@ -171,219 +170,250 @@ void printText(int row, int column, int fillcolumn, int ud, char *fmt, ...)
         }
         int s = min((fillcolumn) / getGlyphWidth(), getScreenWidth() / getGlyphWidth());
 
-        char tmpbuf[MAX_TEXT_LEN];
-        strcpy(tmpbuf, buf);
-        while (s > textlen + 1) {
-            snprintf(buf, MAX_TEXT_LEN, " %s", tmpbuf);
-            strcpy(tmpbuf, buf);
-            textlen++;
+        // right aligned, the text is drawn from its end
+        int pad = s - textlen - 1;
+        if (pad > 0) {
+            int len = min((int) strlen(buf) + pad, MAX_TEXT_LEN - 1);
+
+            memmove(buf + pad, buf, len - pad);
+            memset(buf, ' ', pad);
+            buf[len] = 0;
         }
-        tte_write_ud(tmpbuf);
-    } else {
-        tte_set_pos(column, h);
-        TTC *tc = tte_get_context();
-        sbmp16_rect(&tc->dst, column, h, column + fillcolumn, h + gh, tc->cattr[TTE_PAPER]);
-        tte_write(buf);
     }
+
+    displayWriteText(row, column, fillcolumn, ud, buf);
 }
 
-void initializeHugeNumbers()
+// A number is right aligned in its slots, a minus goes into the first one.
+static void printNumberSlots(int font, int offset_x, int offset_y, int slots, int number, u16 color, int ud)
 {
-    srf_init(&surface_huge_numbers,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_HUGE,
-        VCR_OSD_MONO_NUMBERS_HUGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT,
-        16,
-        pal_bg_mem);
+    int negative = 0;
+
+    if (number < 0) {
+        displayNumberGlyph(font, offset_x, offset_y, 0, MINUS_POSITION, color, ud);
+        number = -number;
+        negative = 1;
+    }
+
+    for (int i = 0; i < slots; i++) {
+        int slot = slots - (i + 1);
+
+        if (number == 0 && i > 0) {
+            if (i == slots - 1 && negative) {
+                break;
+            }
+            displayClearNumberGlyph(font, offset_x, offset_y, slot, ud);
+        } else {
+            displayNumberGlyph(font, offset_x, offset_y, slot, number % 10, color, ud);
+            number /= 10;
+        }
+    }
 }
 
-void initializeLargeNumbers()
+static int numberGlyphs(int number)
 {
-    srf_init(&surface_large_numbers,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    VCR_OSD_MONO_NUMBERS_LARGE_RED = malloc(VCR_OSD_MONO_NUMBERS_LARGE_SIZE);
-    for (int i = 0; i < VCR_OSD_MONO_NUMBERS_LARGE_SIZE / sizeof(u16); i++) {
-        VCR_OSD_MONO_NUMBERS_LARGE_RED[i] = (VCR_OSD_MONO_NUMBERS_LARGE[i] == 0) ? 0 : 0x1f;
+    int glyphs = number < 0 ? 2 : 1;
+
+    for (number = abs(number); number >= 10; number /= 10) {
+        glyphs++;
     }
 
-    VCR_OSD_MONO_NUMBERS_LARGE_BLUE = malloc(VCR_OSD_MONO_NUMBERS_LARGE_SIZE);
-    for (int i = 0; i < VCR_OSD_MONO_NUMBERS_LARGE_SIZE / sizeof(u16); i++) {
-        VCR_OSD_MONO_NUMBERS_LARGE_BLUE[i] = (VCR_OSD_MONO_NUMBERS_LARGE[i] == 0) ? 0 : CLR_BLUE;
+    return glyphs;
+}
+
+// Where numbers are in their fallback font right now. Only going from the
+// slots to the fallback has to clear the number first, the slots cover
+// whatever the fallback drew. Forgetting one only costs a clear.
+struct FallbackSpot {
+    s16 font;
+    s16 x;
+    s16 y;
+    s16 ud;
+};
+
+static struct FallbackSpot fallbackSpots[FALLBACK_SPOTS];
+static int fallbackSpotCount = 0;
+
+static int findFallbackSpot(int font, int x, int y, int ud)
+{
+    for (int i = 0; i < fallbackSpotCount; i++) {
+        const struct FallbackSpot *spot = &fallbackSpots[i];
+
+        if (spot->font == font && spot->x == x && spot->y == y && spot->ud == ud) {
+            return i;
+        }
     }
 
-    VCR_OSD_MONO_NUMBERS_LARGE_ORANGE = malloc(VCR_OSD_MONO_NUMBERS_LARGE_SIZE);
-    for (int i = 0; i < VCR_OSD_MONO_NUMBERS_LARGE_SIZE / sizeof(u16); i++) {
-        VCR_OSD_MONO_NUMBERS_LARGE_ORANGE[i] = (VCR_OSD_MONO_NUMBERS_LARGE[i] == 0) ? 0 : CLR_ORANGE;
+    return -1;
+}
+
+static void printNumber(int font, int offset_x, int offset_y, int number, u16 color, int ud)
+{
+    int fallback = fallbackFonts[font];
+    int spot = findFallbackSpot(font, offset_x, offset_y, ud);
+    int width, height, x, y;
+
+    if (numberGlyphs(number) <= NUMBER_SLOTS || fallback < 0) {
+        if (spot >= 0) {
+            fallbackSpots[spot] = fallbackSpots[--fallbackSpotCount];
+        }
+        printNumberSlots(font, offset_x, offset_y, NUMBER_SLOTS, number, color, ud);
+        return;
     }
 
-    VCR_OSD_MONO_NUMBERS_LARGE_MAGENTA = malloc(VCR_OSD_MONO_NUMBERS_LARGE_SIZE);
-    for (int i = 0; i < VCR_OSD_MONO_NUMBERS_LARGE_SIZE / sizeof(u16); i++) {
-        VCR_OSD_MONO_NUMBERS_LARGE_MAGENTA[i] = (VCR_OSD_MONO_NUMBERS_LARGE[i] == 0) ? 0 : CLR_MAG;
+    displayLoadFont(fallback);
+
+    if (spot < 0) {
+        for (int slot = 0; slot < NUMBER_SLOTS; slot++) {
+            displayClearNumberGlyph(font, offset_x, offset_y, slot, ud);
+        }
+        if (fallbackSpotCount < FALLBACK_SPOTS) {
+            fallbackSpots[fallbackSpotCount++] = (struct FallbackSpot) { font, offset_x, offset_y, ud };
+        }
     }
 
-    VCR_OSD_MONO_NUMBERS_LARGE_GREEN = malloc(VCR_OSD_MONO_NUMBERS_LARGE_SIZE);
-    for (int i = 0; i < VCR_OSD_MONO_NUMBERS_LARGE_SIZE / sizeof(u16); i++) {
-        VCR_OSD_MONO_NUMBERS_LARGE_GREEN[i] = (VCR_OSD_MONO_NUMBERS_LARGE[i] == 0) ? 0 : CLR_GREEN;
+    // Right aligned in the slots and in the middle of their height. Upside
+    // down a glyph of width w at x goes to SCREEN_WIDTH - x - 1 on, so the
+    // ones line up on their left edge instead.
+    width = displayFontWidth(font);
+    height = displayFontHeight(font);
+    if (ud) {
+        x = offset_x + (NUMBER_SLOTS - 1) * width - (FALLBACK_SLOTS - 1) * displayFontWidth(fallback);
+    } else {
+        x = offset_x + NUMBER_SLOTS * width - FALLBACK_SLOTS * displayFontWidth(fallback);
     }
+    y = offset_y + (height - displayFontHeight(fallback)) / 2;
+
+    printNumberSlots(fallback, x, y, FALLBACK_SLOTS, number, color, ud);
+}
+
+// The fonts are set up on first use, calling these again does nothing.
+void initializeHugeNumbers()
+{
+    displayLoadFont(DISPLAY_FONT_HUGE);
+}
 
-    srf_init(&surface_large_numbers_red,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE_RED,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    srf_init(&surface_large_numbers_blue,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE_BLUE,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    srf_init(&surface_large_numbers_orange,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE_ORANGE,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    srf_init(&surface_large_numbers_magenta,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE_MAGENTA,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    srf_init(&surface_large_numbers_green,
-        SRF_BMP16,
-        VCR_OSD_MONO_NUMBERS_LARGE_GREEN,
-        VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * TOTAL_SYMBOLS_IN_SURFACE, // including -.
-        VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT,
-        16,
-        pal_bg_mem);
-
-    TSurface *dst = tte_get_surface();
-    srf_pal_copy(dst, &surface_huge_numbers, 16);
+void initializeLargeNumbers()
+{
+    displayLoadFont(DISPLAY_FONT_LARGE);
+}
+
+void initializeMediumNumbers()
+{
+    displayLoadFont(DISPLAY_FONT_MEDIUM);
+}
+
+static int numberFont(int size)
+{
+    return size == NUMBER_SIZE_MEDIUM ? DISPLAY_FONT_MEDIUM : DISPLAY_FONT_LARGE;
 }
 
 void printHugeNumber(int number)
 {
-    int offset_x = 0;
-    int offset_y = (SCREEN_HEIGHT - VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT) / 2;
-    int negative = 0;
+    initializeHugeNumbers();
 
-    if (number < 0) {
-        TSurface *dst = tte_get_surface();
-        sbmp16_blit(dst, offset_x, offset_y, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH, VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT, &surface_huge_numbers, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH * 10, 0);
-        number = -number;
-        negative = 1;
-    }
+    printNumber(DISPLAY_FONT_HUGE, 0, (SCREEN_HEIGHT - displayFontHeight(DISPLAY_FONT_HUGE)) / 2, number, CLR_BLUE, 0);
+}
 
-    for (int i = 0; i < 3; i++) {
-        if (number == 0 && i > 0) {
-            if (i == 2 && negative) {
-                break;
-            }
-            TSurface *dst = tte_get_surface();
-            sbmp16_rect(dst, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH * (3 - (i + 1)) + offset_x + VCR_OSD_MONO_NUMBERS_HUGE_WIDTH, offset_y + VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT, CLR_BLACK);
-        } else {
-            int digit = (number % 10);
-            TSurface *dst = tte_get_surface();
-            sbmp16_blit(dst, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_HUGE_WIDTH, VCR_OSD_MONO_NUMBERS_HUGE_HEIGHT, &surface_huge_numbers, digit * VCR_OSD_MONO_NUMBERS_HUGE_WIDTH, 0);
-            number /= 10;
-        }
+void printLargeNumber(int offset_x, int offset_y, int number, int col, int ud)
+{
+    initializeLargeNumbers();
+
+    printNumber(DISPLAY_FONT_LARGE, offset_x, offset_y, number, convertColor(col), ud);
+}
+
+int setPlayerLook(int player, int col)
+{
+    if (!displayHasPlayerInks()) {
+        return 0;
     }
+
+    displaySetPlayerInk(player, convertColor(col));
+    return 1;
 }
 
-void printLargeNumber(int offset_x, int offset_y, int number, int col, int ud, int withdot)
+void printPlayerNumber(int size, int offset_x, int offset_y, int number, int player, int col, int ud)
 {
-    int negative = 0;
+    int font = numberFont(size);
 
-    TSurface *surface = 0;
-    switch (col) {
-        case COLOR_RED:
-            surface = &surface_large_numbers_red;
-            break;
-        case COLOR_BLUE:
-            surface = &surface_large_numbers_blue;
-            break;
-        case COLOR_ORANGE:
-            surface = &surface_large_numbers_orange;
-            break;
-        case COLOR_GREEN:
-            surface = &surface_large_numbers_green;
-            break;
-        case COLOR_MAGENTA:
-            surface = &surface_large_numbers_magenta;
-            break;
-        default:
-            surface = &surface_large_numbers;
-    };
+    displayLoadFont(font);
 
-    if (number < 0) {
-        TSurface *dst = tte_get_surface();
-        if (ud) {
-            sbmp16_blit_ud(dst, offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * MINUS_POSITION, 0);
-        } else {
-            sbmp16_blit(dst, offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * MINUS_POSITION, 0);
-        }
-        number = -number;
-        negative = 1;
+    if (setPlayerLook(player, col)) {
+        displayUsePlayerInk(player);
     }
+    printNumber(font, offset_x, offset_y, number, convertColor(col), ud);
+    displayUsePlayerInk(-1);
+}
 
-    for (int i = 0; i < 3; i++) {
-        if (number == 0 && i > 0) {
-            if (i == 2 && negative) {
-                break;
-            }
-            TSurface *dst = tte_get_surface();
-            if (ud) {
-                sbmp16_rect_ud(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x + VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, offset_y + VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, CLR_BLACK);
-            } else {
-                sbmp16_rect(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x + VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, offset_y + VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, CLR_BLACK);
-            }
-        } else {
-            int digit = (number % 10);
-            TSurface *dst = tte_get_surface();
-            if (ud) {
-                sbmp16_blit_ud(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, digit * VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, 0);
-            } else {
-                sbmp16_blit(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * (3 - (i + 1)) + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, digit * VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, 0);
+// The part of the dot glyph that is set, cut out into the selection
+// indicator the first time it is shown in a size.
+static int dotX, dotY, dotWidth, dotHeight;
+static int dotFont = -1;
+
+static void cutSelectionDot(int font)
+{
+    int width = displayFontWidth(font);
+    int height = displayFontHeight(font);
+    int left = width, top = height, right = 0, bottom = 0;
+    u8 mask[INDICATOR_SHAPE_SIZE * INDICATOR_SHAPE_SIZE / 8];
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (displayNumberGlyphPixel(font, DOT_POSITION, x, y)) {
+                left = min(left, x);
+                top = min(top, y);
+                right = max(right, x + 1);
+                bottom = max(bottom, y + 1);
             }
-            number /= 10;
         }
     }
 
-    if (withdot) {
-        TSurface *dst = tte_get_surface();
-        if (ud) {
-            sbmp16_blit_ud(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, DOT_POSITION * VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, 0);
-        } else {
-            sbmp16_blit(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, surface, DOT_POSITION * VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, 0);
+    dotX = left;
+    dotY = top;
+    dotWidth = max(min(right - left, INDICATOR_SHAPE_SIZE), 0);
+    dotHeight = max(min(bottom - top, INDICATOR_SHAPE_SIZE), 0);
+
+    memset(mask, 0, sizeof(mask));
+    for (int y = 0; y < dotHeight; y++) {
+        for (int x = 0; x < dotWidth; x++) {
+            if (displayNumberGlyphPixel(font, DOT_POSITION, dotX + x, dotY + y)) {
+                mask[y * INDICATOR_SHAPE_SIZE / 8 + x / 8] |= 1 << (x & 7);
+            }
         }
+    }
+
+    indicatorSetShape(INDICATOR_SELECTION, mask, INDICATOR_SHAPE_SIZE / 8, dotWidth, dotHeight);
+    dotFont = font;
+}
+
+// Where the dot glyph would be drawn after the number. Upside down the
+// corner that ends up top left is the far one.
+void showSelectionDot(int size, int offset_x, int offset_y, int col, int ud)
+{
+    int font = numberFont(size);
+    int x, y;
+
+    displayLoadFont(font);
+    if (dotFont != font) {
+        cutSelectionDot(font);
+    }
+
+    if (ud) {
+        displayNumberPixel(font, offset_x, offset_y, NUMBER_SLOTS, 1, dotX + dotWidth - 1, dotY + dotHeight - 1, &x, &y);
     } else {
-        TSurface *dst = tte_get_surface();
-        if (ud) {
-            sbmp16_rect_ud(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x + VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, offset_y + VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, CLR_BLACK);
-        } else {
-            sbmp16_rect(dst, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x, offset_y, VCR_OSD_MONO_NUMBERS_LARGE_WIDTH * 3 + offset_x + VCR_OSD_MONO_NUMBERS_LARGE_WIDTH, offset_y + VCR_OSD_MONO_NUMBERS_LARGE_HEIGHT, CLR_BLACK);
-        }
+        displayNumberPixel(font, offset_x, offset_y, NUMBER_SLOTS, 0, dotX, dotY, &x, &y);
     }
+
+    indicatorSetColor(INDICATOR_SELECTION, convertColor(col));
+    indicatorShow(INDICATOR_SELECTION, x, y, ud);
 }
 
 void clearScreen()
 {
-    tte_write("#{es;P}");
+    displayClear();
 }
 
+void clearScreenRows(int top, int bottom)
+{
+    displayClearRows(top, bottom);
+}
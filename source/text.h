@@ -8,12 +8,25 @@
 
 void initializeText();
 void initializeLargeNumbers();
+void initializeMediumNumbers();
 void initializeHugeNumbers();
 void printText(int row, int column, int fillcolumn, int ud, char *fmt, ...);
 void printTextColor(int row, int column, int fillcolumn, int col, int ud, char *fmt, ...);
 void printHugeNumber(int number);
-void printLargeNumber(int square, int maxSquares, int number, int col, int ud, int withdot);
+void printLargeNumber(int offset_x, int offset_y, int number, int col, int ud);
+// A player's life like printLargeNumber, in one of the NUMBER_SIZEs. Where
+// the display has inks per player (display.h) the number is drawn in them
+// and a new look for it is only setPlayerLook.
+void printPlayerNumber(int size, int offset_x, int offset_y, int number, int player, int col, int ud);
+// Returns 0 if the display has no player inks, the number has to be printed
+// again then.
+int setPlayerLook(int player, int col);
+// The selection indicator (indicator.h) where printPlayerNumber would have
+// drawn a dot after the number.
+void showSelectionDot(int size, int offset_x, int offset_y, int col, int ud);
 void clearScreen();
+// clears the pixel rows top to bottom - 1
+void clearScreenRows(int top, int bottom);
 // convert color from enum to hex value
 int convertColor(int col);
 int getGlyphWidth(void);
@@ -21,9 +34,18 @@ int getGlyphHeight(void);
 int getScreenWidth(void);
 int getLargeGlyphWidth(void);
 int getLargeGlyphHeight(void);
+int getMediumGlyphWidth(void);
+int getMediumGlyphHeight(void);
 int getScreenWidth(void);
 int getScreenHeight(void);
 
+// The sizes of a player's life: large for up to four players, medium for
+// the games that need more room. Medium is never upside down.
+enum NUMBER_SIZE {
+    NUMBER_SIZE_LARGE = 0,
+    NUMBER_SIZE_MEDIUM,
+};
+
 enum COLOR {
     COLOR_WHITE = 0,
     COLOR_GREEN,
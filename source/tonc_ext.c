@@ -33,7 +33,7 @@ typedef u16 pixel_t;
 
 extern uint utf8_decode_char(const char *ptr, char **endptr);
 
-void bmp16_drawg_b1cts_ud(uint gid)
+IWRAM_ARM void bmp16_drawg_b1cts_ud(uint gid)
 {
     TTE_BASE_VARS(tc, font);
     TTE_CHAR_VARS(font, gid, u8, srcD, srcL, charW, charH);
@@ -61,6 +61,38 @@ void bmp16_drawg_b1cts_ud(uint gid)
     }
 }
 
+// VRAM takes no byte writes, an 8bpp pixel is half of a halfword
+#define PLOT8(_base, _pitch, _x, _y, _clr)                                  \
+    do {                                                                    \
+        u16 *_p= (u16*)((_base) + (_y)*(_pitch) + ((_x)&~1));               \
+        *_p= (_x)&1 ? (*_p&0x00FF) | (_clr)<<8 : (*_p&0xFF00) | (_clr);     \
+    } while(0)
+
+IWRAM_ARM void bmp8_drawg_b1cts_ud(uint gid)
+{
+    TTE_BASE_VARS(tc, font);
+    TTE_CHAR_VARS(font, gid, u8, srcD, srcL, charW, charH);
+    uint srcP= font->cellH;
+    int x0= tc->cursorX, y0= tc->cursorY, dstP= tc->dst.pitch;
+    u8 *dstD= tc->dst.data;
+
+    u32 ink= tc->cattr[TTE_INK], raw;
+
+    // the same pixels as bmp16_drawg_b1cts_ud
+    int ix, iy, iw;
+    for(iw=0; iw<charW; iw += 8)
+    {
+        for(iy=0; iy<charH; iy++)
+        {
+            raw= srcL[iy];
+            for(ix=0; raw>0; raw>>=1, ix++)
+                if(raw&1)
+                    PLOT8(dstD, dstP, x0 + iw - ix, y0 - 1 - iy, ink);
+        }
+        srcL += srcP;
+    }
+}
+
 int	tte_write_ud(const char *text)
 {
 	if(text == NULL)
@@ -121,7 +153,10 @@ int	tte_write_ud(const char *text)
 
 			// Draw and update position
 			//tc->drawgProc(gid);
-            bmp16_drawg_b1cts_ud(gid);
+            if(tc->dst.bpp == 8)
+                bmp8_drawg_b1cts_ud(gid);
+            else
+                bmp16_drawg_b1cts_ud(gid);
 			tc->cursorX += charW;
 		}
 	}
@@ -130,7 +165,7 @@ int	tte_write_ud(const char *text)
 	return str - text;
 }
 
-void memcpy16_rev(u16 *target, u16 *source, int length)
+IWRAM_ARM void memcpy16_rev(u16 *target, u16 *source, int length)
 {
     int i = 0;
     do
@@ -140,7 +175,7 @@ void memcpy16_rev(u16 *target, u16 *source, int length)
     while (--length);
 }
 
-void memset16_rev(u16 *target, u16 value, int length)
+IWRAM_ARM void memset16_rev(u16 *target, u16 value, int length)
 {
     int i = 0;
     do
@@ -150,7 +185,7 @@ void memset16_rev(u16 *target, u16 value, int length)
     while (--length);
 }
 
-void sbmp16_blit_ud(const TSurface *dst, int dstX, int dstY,
+IWRAM_ARM void sbmp16_blit_ud(const TSurface *dst, int dstX, int dstY,
     uint width, uint height, const TSurface *src, int srcX, int srcY)
 {
     // Safety checks
@@ -197,7 +232,7 @@ void sbmp16_blit_ud(const TSurface *dst, int dstX, int dstY,
 #undef BLIT_CLIP
 }
 
-void sbmp16_rect_ud(const TSurface *dst,
+IWRAM_ARM void sbmp16_rect_ud(const TSurface *dst,
     int left, int top, int right, int bottom, u32 clr)
 {
     if(left==right || top==bottom)
@@ -215,3 +250,106 @@ void sbmp16_rect_ud(const TSurface *dst,
     {   dstL -= dstP; memset16_rev(dstL, clr, width);   }
 }
 
+
+IWRAM_ARM void sbmp16_blit_mask(const TSurface *dst, int dstX, int dstY,
+    uint width, uint height, const u8 *mask, uint maskPitch, int srcX, int srcY,
+    u16 ink, u16 paper)
+{
+    // Safety checks
+    if(mask==NULL || dst==NULL || dst->data==NULL)
+        return;
+
+    // --- Clip --- (the mask has no size, staying inside it is up to the caller)
+    int w= width, h= height;
+
+/// Temporary bliter clipping macro
+#define BLIT_CLIP(_ax, _aw, _w, _bx)                \
+    do {                                            \
+        if( (_ax) >= (_aw) || (_ax)+(_w) <= 0 )     \
+            return;                                 \
+        if( (_ax)<0 )                               \
+        {   _w += (_ax); _bx -= (_ax); _ax= 0;  }   \
+        if( (_w) > (_aw)-(_ax) )                    \
+            _w = (_aw)-(_ax);                       \
+    } while(0)
+
+    BLIT_CLIP(dstX, dst->width, w, srcX);
+    BLIT_CLIP(dstY, dst->height, h, srcY);
+
+#undef BLIT_CLIP
+
+    const u8 *srcL= mask + srcY*maskPitch;
+    pixel_t *dstL= PXPTR(dst, dstX, dstY);
+    uint dstP= dst->pitch/PXSIZE;
+
+    // Expand set bits to ink, clear bits to paper.
+    while(h--)
+    {
+        for(int ix=0; ix<w; ix++)
+        {
+            uint sx= srcX+ix;
+            dstL[ix]= (srcL[sx>>3]>>(sx&7)) & 1 ? ink : paper;
+        }
+        srcL += maskPitch;
+        dstL += dstP;
+    }
+}
+
+IWRAM_ARM void sbmp8_blit_mask(const TSurface *dst, int dstX, int dstY,
+    uint width, uint height, const u8 *mask, uint maskPitch, int srcX, int srcY,
+    u8 ink, u8 paper)
+{
+    // Safety checks
+    if(mask==NULL || dst==NULL || dst->data==NULL)
+        return;
+
+    // --- Clip --- (the mask has no size, staying inside it is up to the caller)
+    int w= width, h= height;
+
+/// Temporary bliter clipping macro
+#define BLIT_CLIP(_ax, _aw, _w, _bx)                \
+    do {                                            \
+        if( (_ax) >= (_aw) || (_ax)+(_w) <= 0 )     \
+            return;                                 \
+        if( (_ax)<0 )                               \
+        {   _w += (_ax); _bx -= (_ax); _ax= 0;  }   \
+        if( (_w) > (_aw)-(_ax) )                    \
+            _w = (_aw)-(_ax);                       \
+    } while(0)
+
+    BLIT_CLIP(dstX, dst->width, w, srcX);
+    BLIT_CLIP(dstY, dst->height, h, srcY);
+
+#undef BLIT_CLIP
+
+    const u8 *srcL= mask + srcY*maskPitch;
+    u8 *dstL= dst->data + dstY*dst->pitch;
+    uint dstP= dst->pitch;
+
+#define MASK_PX(_ix)    \
+    ((srcL[(srcX+(_ix))>>3]>>((srcX+(_ix))&7)) & 1 ? ink : paper)
+
+    // Pixel pairs are whole halfwords, only an odd edge needs the pixel
+    // next to it read back.
+    while(h--)
+    {
+        int ix= 0;
+        if(dstX&1)
+        {
+            PLOT8(dstL, 0, dstX, 0, MASK_PX(0));
+            ix= 1;
+        }
+
+        u16 *dstH= (u16*)(dstL + dstX + ix);
+        for(; ix+1<w; ix += 2)
+            *dstH++= MASK_PX(ix) | MASK_PX(ix+1)<<8;
+
+        if(ix<w)
+            PLOT8(dstL, 0, dstX + ix, 0, MASK_PX(ix));
+
+        srcL += maskPitch;
+        dstL += dstP;
+    }
+
+#undef MASK_PX
+}
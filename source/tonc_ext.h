@@ -9,14 +9,26 @@
 #include <tonc.h>
 #include <tonc_video.h>
 
-void bmp16_drawg_b1cts_ud(uint gid);
+#include "placement.h"
+
+IWRAM_ARM void bmp16_drawg_b1cts_ud(uint gid);
+IWRAM_ARM void bmp8_drawg_b1cts_ud(uint gid);
 int	tte_write_ud(const char *text);
-void memcpy16_rev(u16 *target, u16 *source, int length);
-void memset16_rev(u16 *target, u16 value, int length);
-void sbmp16_blit_ud(const TSurface *dst, int dstX, int dstY,
+IWRAM_ARM void memcpy16_rev(u16 *target, u16 *source, int length);
+IWRAM_ARM void memset16_rev(u16 *target, u16 value, int length);
+IWRAM_ARM void sbmp16_blit_ud(const TSurface *dst, int dstX, int dstY,
     uint width, uint height, const TSurface *src, int srcX, int srcY);
-void sbmp16_rect_ud(const TSurface *dst,
+IWRAM_ARM void sbmp16_rect_ud(const TSurface *dst,
     int left, int top, int right, int bottom, u32 clr);
+/* Draws part of a 1bpp mask (LSB is the leftmost pixel, maskPitch bytes per
+   row), set bits in ink and clear bits in paper */
+IWRAM_ARM void sbmp16_blit_mask(const TSurface *dst, int dstX, int dstY,
+    uint width, uint height, const u8 *mask, uint maskPitch, int srcX, int srcY,
+    u16 ink, u16 paper);
+/* The same for 8bpp surfaces, ink and paper are palette indices */
+IWRAM_ARM void sbmp8_blit_mask(const TSurface *dst, int dstX, int dstY,
+    uint width, uint height, const u8 *mask, uint maskPitch, int srcX, int srcY,
+    u8 ink, u8 paper);
 
 #endif
 
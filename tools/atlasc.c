@@ -0,0 +1,632 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Renders a strip of glyphs from a TTF and writes it as a C array the game
+ * can link directly. Replaces the old ImageMagick script, which kept the
+ * atlases as raw 16bpp bitmaps (~187 KB of ROM for the two sizes).
+ *
+ * The cell geometry is the one that script used: every glyph gets a size/2
+ * wide cell, the cell starts leftcrop pixels into the rendered glyph and
+ * topcrop rows are cut off the top. bottomcrop rows below the baseline can
+ * be cut off too, for a size that has to fit whole tiles.
+ *
+ * Output formats:
+ *   1bpp  - one strip of all glyphs, rows top to bottom, LSB is the leftmost
+ *           pixel, each row padded to a whole byte
+ *   4bpp  - GBA tiles, glyph after glyph, each glyph row-major in 8x8 tiles,
+ *           ink is palette index 1
+ *   bmp16 - one strip of all glyphs in 16 bit color, like the old arrays
+ *
+ * The data is compressed in the GBA BIOS LZ77 (0x10) or RLE (0x30) format so
+ * it can be unpacked with LZ77UnCompWram/RLUnCompWram, whichever is smaller
+ * unless -z says otherwise. With -r a second array NAME_UD holds the same
+ * glyphs with every cell rotated by 180 degrees for the upside down players.
+ *
+ * With -d the 4bpp tiles are deduplicated for a tiled background: every
+ * distinct tile is written once, a tile that is another one flipped counts as
+ * that one, and NAME_MAP holds a GBA screen entry per tile of every glyph,
+ * the tile number with 0x400 for a horizontal and 0x800 for a vertical flip.
+ * Upside down is the same map flipped both ways, so -r isn't needed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#define COMPRESSION_NONE 0x00
+#define COMPRESSION_LZ77 0x10
+#define COMPRESSION_RLE 0x30
+
+#define TILE_SIZE 32
+#define TILE_HFLIP 0x400
+#define TILE_VFLIP 0x800
+
+enum FORMAT {
+    FORMAT_1BPP,
+    FORMAT_4BPP,
+    FORMAT_BMP16,
+};
+
+struct Atlas {
+    const char *name;
+    const char *glyphs;
+    int count;
+    int width;
+    int height;
+    // one byte per pixel, 1 is ink, cells next to each other
+    uint8_t *pixels;
+};
+
+struct Buffer {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+};
+
+static void bufferPut(struct Buffer *buf, uint8_t b)
+{
+    if (buf->len == buf->cap) {
+        buf->cap = buf->cap ? buf->cap * 2 : 1024;
+        buf->data = realloc(buf->data, buf->cap);
+        if (!buf->data) {
+            fprintf(stderr, "atlasc: out of memory\n");
+            exit(1);
+        }
+    }
+    buf->data[buf->len++] = b;
+}
+
+static void bufferPutHeader(struct Buffer *buf, int type, size_t size)
+{
+    bufferPut(buf, type);
+    bufferPut(buf, size & 0xff);
+    bufferPut(buf, (size >> 8) & 0xff);
+    bufferPut(buf, (size >> 16) & 0xff);
+}
+
+static void bufferAlign(struct Buffer *buf)
+{
+    while (buf->len & 3) {
+        bufferPut(buf, 0);
+    }
+}
+
+static void renderAtlas(struct Atlas *atlas, const char *fontfile, int size, int topcrop, int leftcrop, int threshold)
+{
+    FT_Library library;
+    FT_Face face;
+
+    if (FT_Init_FreeType(&library) || FT_New_Face(library, fontfile, 0, &face)) {
+        fprintf(stderr, "atlasc: can't load %s\n", fontfile);
+        exit(1);
+    }
+
+    // ImageMagick's -pointsize is in pixels at its default 72 dpi
+    FT_Set_Pixel_Sizes(face, 0, size);
+
+    int ascender = face->size->metrics.ascender >> 6;
+    int stride = atlas->width * atlas->count;
+
+    atlas->pixels = calloc(stride * atlas->height, 1);
+    if (!atlas->pixels) {
+        fprintf(stderr, "atlasc: out of memory\n");
+        exit(1);
+    }
+
+    for (int g = 0; g < atlas->count; g++) {
+        if (FT_Load_Char(face, (unsigned char)atlas->glyphs[g], FT_LOAD_RENDER)) {
+            fprintf(stderr, "atlasc: no glyph for '%c' in %s\n", atlas->glyphs[g], fontfile);
+            exit(1);
+        }
+
+        FT_Bitmap *bitmap = &face->glyph->bitmap;
+        int left = face->glyph->bitmap_left - leftcrop;
+        int top = ascender - face->glyph->bitmap_top - topcrop;
+
+        for (int y = 0; y < bitmap->rows; y++) {
+            for (int x = 0; x < bitmap->width; x++) {
+                int cx = left + x;
+                int cy = top + y;
+
+                if (cx < 0 || cx >= atlas->width || cy < 0 || cy >= atlas->height) {
+                    continue;
+                }
+
+                if (bitmap->buffer[y * bitmap->pitch + x] >= threshold) {
+                    atlas->pixels[cy * stride + g * atlas->width + cx] = 1;
+                }
+            }
+        }
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+}
+
+static uint8_t *rotateCells(const struct Atlas *atlas)
+{
+    int stride = atlas->width * atlas->count;
+    uint8_t *rotated = malloc(stride * atlas->height);
+
+    if (!rotated) {
+        fprintf(stderr, "atlasc: out of memory\n");
+        exit(1);
+    }
+
+    for (int y = 0; y < atlas->height; y++) {
+        for (int g = 0; g < atlas->count; g++) {
+            for (int x = 0; x < atlas->width; x++) {
+                rotated[(atlas->height - 1 - y) * stride + g * atlas->width + (atlas->width - 1 - x)] =
+                    atlas->pixels[y * stride + g * atlas->width + x];
+            }
+        }
+    }
+
+    return rotated;
+}
+
+static void pack(struct Buffer *out, const struct Atlas *atlas, const uint8_t *pixels, enum FORMAT format, int color)
+{
+    int stride = atlas->width * atlas->count;
+
+    switch (format) {
+        case FORMAT_1BPP:
+            for (int y = 0; y < atlas->height; y++) {
+                for (int x = 0; x < stride; x += 8) {
+                    uint8_t b = 0;
+                    for (int i = 0; i < 8 && x + i < stride; i++) {
+                        b |= pixels[y * stride + x + i] << i;
+                    }
+                    bufferPut(out, b);
+                }
+            }
+            break;
+        case FORMAT_4BPP: {
+            int tilesX = (atlas->width + 7) / 8;
+            int tilesY = (atlas->height + 7) / 8;
+
+            for (int g = 0; g < atlas->count; g++) {
+                for (int ty = 0; ty < tilesY; ty++) {
+                    for (int tx = 0; tx < tilesX; tx++) {
+                        for (int y = ty * 8; y < ty * 8 + 8; y++) {
+                            for (int x = tx * 8; x < tx * 8 + 8; x += 2) {
+                                uint8_t b = 0;
+                                if (y < atlas->height && x < atlas->width) {
+                                    b |= pixels[y * stride + g * atlas->width + x];
+                                }
+                                if (y < atlas->height && x + 1 < atlas->width) {
+                                    b |= pixels[y * stride + g * atlas->width + x + 1] << 4;
+                                }
+                                bufferPut(out, b);
+                            }
+                        }
+                    }
+                }
+            }
+            break;
+        }
+        case FORMAT_BMP16:
+            for (int i = 0; i < stride * atlas->height; i++) {
+                int c = pixels[i] ? color : 0;
+                bufferPut(out, c & 0xff);
+                bufferPut(out, c >> 8);
+            }
+            break;
+    }
+}
+
+static void flipTile(uint8_t *dst, const uint8_t *src, int hflip, int vflip)
+{
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            int sx = hflip ? 7 - x : x;
+            int sy = vflip ? 7 - y : y;
+            int nibble = (src[sy * 4 + sx / 2] >> ((sx & 1) * 4)) & 0xf;
+
+            if (x & 1) {
+                dst[y * 4 + x / 2] |= nibble << 4;
+            } else {
+                dst[y * 4 + x / 2] = nibble;
+            }
+        }
+    }
+}
+
+// Replaces the tiles in raw with the distinct ones and fills map, returns
+// how many tiles there are
+static int dedupTiles(struct Buffer *raw, struct Buffer *map)
+{
+    int count = raw->len / TILE_SIZE;
+    int unique = 0;
+
+    for (int t = 0; t < count; t++) {
+        const uint8_t *tile = raw->data + t * TILE_SIZE;
+        int entry = -1;
+
+        for (int flip = 0; flip < 4 && entry < 0; flip++) {
+            uint8_t flipped[TILE_SIZE];
+
+            flipTile(flipped, tile, flip & 1, flip & 2);
+            for (int u = 0; u < unique; u++) {
+                if (memcmp(raw->data + u * TILE_SIZE, flipped, TILE_SIZE) == 0) {
+                    entry = u | (flip & 1 ? TILE_HFLIP : 0) | (flip & 2 ? TILE_VFLIP : 0);
+                    break;
+                }
+            }
+        }
+
+        if (entry < 0) {
+            // unique <= t, so this never overwrites a tile still to be looked at
+            memmove(raw->data + unique * TILE_SIZE, tile, TILE_SIZE);
+            entry = unique++;
+        }
+
+        bufferPut(map, entry & 0xff);
+        bufferPut(map, entry >> 8);
+    }
+
+    raw->len = unique * TILE_SIZE;
+    return unique;
+}
+
+static void compressLZ77(struct Buffer *out, const uint8_t *src, size_t len)
+{
+    size_t pos = 0;
+
+    bufferPutHeader(out, COMPRESSION_LZ77, len);
+
+    while (pos < len) {
+        size_t flagpos = out->len;
+        uint8_t flags = 0;
+
+        bufferPut(out, 0);
+
+        for (int block = 0; block < 8 && pos < len; block++) {
+            size_t bestLen = 0, bestDisp = 0;
+
+            // displacements start at 2 so the data also unpacks into VRAM
+            for (size_t disp = 2; disp <= 0x1000 && disp <= pos; disp++) {
+                size_t l = 0;
+                while (l < 18 && pos + l < len && src[pos + l] == src[pos + l - disp]) {
+                    l++;
+                }
+                if (l > bestLen) {
+                    bestLen = l;
+                    bestDisp = disp;
+                    if (l == 18) {
+                        break;
+                    }
+                }
+            }
+
+            if (bestLen >= 3) {
+                flags |= 0x80 >> block;
+                bufferPut(out, ((bestLen - 3) << 4) | ((bestDisp - 1) >> 8));
+                bufferPut(out, (bestDisp - 1) & 0xff);
+                pos += bestLen;
+            } else {
+                bufferPut(out, src[pos++]);
+            }
+        }
+
+        out->data[flagpos] = flags;
+    }
+
+    bufferAlign(out);
+}
+
+static void compressRLE(struct Buffer *out, const uint8_t *src, size_t len)
+{
+    size_t pos = 0;
+
+    bufferPutHeader(out, COMPRESSION_RLE, len);
+
+    while (pos < len) {
+        size_t run = 1;
+        while (run < 130 && pos + run < len && src[pos + run] == src[pos]) {
+            run++;
+        }
+
+        if (run >= 3) {
+            bufferPut(out, 0x80 | (run - 3));
+            bufferPut(out, src[pos]);
+            pos += run;
+            continue;
+        }
+
+        // literals until the next run of 3 or more
+        size_t start = pos;
+        while (pos < len && pos - start < 128) {
+            if (pos + 2 < len && src[pos] == src[pos + 1] && src[pos] == src[pos + 2]) {
+                break;
+            }
+            pos++;
+        }
+
+        bufferPut(out, (pos - start) - 1);
+        for (size_t i = start; i < pos; i++) {
+            bufferPut(out, src[i]);
+        }
+    }
+
+    bufferAlign(out);
+}
+
+static const char *compressionName(int compression)
+{
+    switch (compression) {
+        case COMPRESSION_LZ77:
+            return "lz77";
+        case COMPRESSION_RLE:
+            return "rle";
+        default:
+            return "none";
+    }
+}
+
+// Compresses raw with the requested method (-1 picks the smallest)
+static int compress(struct Buffer *out, const struct Buffer *raw, int method, size_t *lz77Size, size_t *rleSize)
+{
+    struct Buffer lz77 = { 0 }, rle = { 0 };
+
+    compressLZ77(&lz77, raw->data, raw->len);
+    compressRLE(&rle, raw->data, raw->len);
+
+    *lz77Size = lz77.len;
+    *rleSize = rle.len;
+
+    if (method < 0) {
+        method = COMPRESSION_NONE;
+        if (lz77.len < raw->len) {
+            method = COMPRESSION_LZ77;
+        }
+        if (rle.len < raw->len && rle.len < lz77.len) {
+            method = COMPRESSION_RLE;
+        }
+    }
+
+    switch (method) {
+        case COMPRESSION_LZ77:
+            *out = lz77;
+            free(rle.data);
+            break;
+        case COMPRESSION_RLE:
+            *out = rle;
+            free(lz77.data);
+            break;
+        default:
+            out->len = 0;
+            for (size_t i = 0; i < raw->len; i++) {
+                bufferPut(out, raw->data[i]);
+            }
+            bufferAlign(out);
+            free(lz77.data);
+            free(rle.data);
+            break;
+    }
+
+    return method;
+}
+
+static void writeArray(FILE *f, const char *name, const struct Buffer *buf)
+{
+    fprintf(f, "const unsigned char %s[] __attribute__((aligned(4))) = {", name);
+    for (size_t i = 0; i < buf->len; i++) {
+        fprintf(f, "%s0x%02x,", (i % 16) ? " " : "\n    ", buf->data[i]);
+    }
+    fprintf(f, "\n};\n");
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options] font.ttf NAME\n"
+        "  -s size       pixel size to render at (default 60)\n"
+        "  -t rows       rows to crop off the top (default 0)\n"
+        "  -b rows       rows to crop off the bottom (default 0)\n"
+        "  -l columns    columns to crop off the left of each cell (default 0)\n"
+        "  -g glyphs     characters in the atlas (default \"0123456789-.\")\n"
+        "  -f format     1bpp, 4bpp or bmp16 (default 1bpp)\n"
+        "  -c color      ink for bmp16 in BGR555 (default 0x7fff)\n"
+        "  -z method     auto, lz77, rle or none (default auto)\n"
+        "  -T threshold  coverage 1..255 a pixel needs to be ink (default 128)\n"
+        "  -r            also write NAME_UD with every glyph rotated by 180 degrees\n"
+        "  -d            4bpp only: write each distinct tile once and NAME_MAP\n"
+        "  -o base       write base.c and base.h (default NAME)\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    struct Atlas atlas = { 0 };
+    const char *formats[] = { "1bpp", "4bpp", "bmp16" };
+    const int bpps[] = { 1, 4, 16 };
+    enum FORMAT format = FORMAT_1BPP;
+    int size = 60, topcrop = 0, bottomcrop = 0, leftcrop = 0, threshold = 128;
+    int color = 0x7fff, method = -1, rotated = 0, dedup = 0;
+    const char *base = NULL;
+    int opt;
+
+    atlas.glyphs = "0123456789-.";
+
+    while ((opt = getopt(argc, argv, "s:t:b:l:g:f:c:z:T:rdo:")) != -1) {
+        switch (opt) {
+            case 's':
+                size = atoi(optarg);
+                break;
+            case 't':
+                topcrop = atoi(optarg);
+                break;
+            case 'b':
+                bottomcrop = atoi(optarg);
+                break;
+            case 'l':
+                leftcrop = atoi(optarg);
+                break;
+            case 'g':
+                atlas.glyphs = optarg;
+                break;
+            case 'f':
+                for (format = FORMAT_1BPP; format <= FORMAT_BMP16; format++) {
+                    if (strcmp(optarg, formats[format]) == 0) {
+                        break;
+                    }
+                }
+                if (format > FORMAT_BMP16) {
+                    usage(argv[0]);
+                }
+                break;
+            case 'c':
+                color = strtol(optarg, NULL, 0);
+                break;
+            case 'z':
+                if (strcmp(optarg, "auto") == 0) {
+                    method = -1;
+                } else if (strcmp(optarg, "lz77") == 0) {
+                    method = COMPRESSION_LZ77;
+                } else if (strcmp(optarg, "rle") == 0) {
+                    method = COMPRESSION_RLE;
+                } else if (strcmp(optarg, "none") == 0) {
+                    method = COMPRESSION_NONE;
+                } else {
+                    usage(argv[0]);
+                }
+                break;
+            case 'T':
+                threshold = atoi(optarg);
+                break;
+            case 'r':
+                rotated = 1;
+                break;
+            case 'd':
+                dedup = 1;
+                break;
+            case 'o':
+                base = optarg;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2 || size < 2 || size - topcrop - bottomcrop < 1 || threshold < 1 || threshold > 255 ||
+        (dedup && format != FORMAT_4BPP)) {
+        usage(argv[0]);
+    }
+
+    atlas.name = argv[optind + 1];
+    atlas.count = strlen(atlas.glyphs);
+    atlas.width = size / 2;
+    atlas.height = size - topcrop - bottomcrop;
+
+    if (!base) {
+        base = atlas.name;
+    }
+
+    renderAtlas(&atlas, argv[optind], size, topcrop, leftcrop, threshold);
+
+    struct Buffer raw = { 0 }, packed = { 0 }, map = { 0 };
+    size_t lz77Size, rleSize;
+    int tiles = 0;
+
+    pack(&raw, &atlas, atlas.pixels, format, color);
+    if (dedup) {
+        tiles = dedupTiles(&raw, &map);
+    }
+    method = compress(&packed, &raw, method, &lz77Size, &rleSize);
+
+    struct Buffer rawUd = { 0 }, packedUd = { 0 };
+    if (rotated) {
+        uint8_t *pixelsUd = rotateCells(&atlas);
+        size_t lz77SizeUd, rleSizeUd;
+
+        pack(&rawUd, &atlas, pixelsUd, format, color);
+        compress(&packedUd, &rawUd, method, &lz77SizeUd, &rleSizeUd);
+        free(pixelsUd);
+    }
+
+    size_t romSize = packed.len + packedUd.len + map.len;
+    const char *fontname = strrchr(argv[optind], '/') ? strrchr(argv[optind], '/') + 1 : argv[optind];
+    char path[1024];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s.h", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "atlasc: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/atlasc from %s, do not edit.\n\n", fontname);
+    fprintf(f, "#ifndef %s_H__\n#define %s_H__\n\n", atlas.name, atlas.name);
+    fprintf(f, "#define %s_WIDTH %d\n", atlas.name, atlas.width);
+    fprintf(f, "#define %s_HEIGHT %d\n", atlas.name, atlas.height);
+    fprintf(f, "#define %s_GLYPHS %d\n", atlas.name, atlas.count);
+    fprintf(f, "#define %s_BPP %d\n", atlas.name, bpps[format]);
+    if (format == FORMAT_4BPP) {
+        fprintf(f, "#define %s_TILES_PER_GLYPH %d\n", atlas.name,
+            ((atlas.width + 7) / 8) * ((atlas.height + 7) / 8));
+        if (dedup) {
+            fprintf(f, "#define %s_TILES %d\n", atlas.name, tiles);
+        }
+    } else {
+        fprintf(f, "#define %s_PITCH %d\n", atlas.name,
+            (int)(raw.len / atlas.height));
+    }
+    fprintf(f, "// 0x10 BIOS LZ77, 0x30 BIOS RLE, 0 uncompressed\n");
+    fprintf(f, "#define %s_COMPRESSION 0x%02x\n", atlas.name, method);
+    fprintf(f, "#define %s_RAW_SIZE %u\n", atlas.name, (unsigned int)raw.len);
+    fprintf(f, "#define %s_ROM_SIZE %u\n\n", atlas.name, (unsigned int)romSize);
+    fprintf(f, "extern const unsigned char %s[];\n", atlas.name);
+    if (rotated) {
+        fprintf(f, "extern const unsigned char %s_UD[];\n", atlas.name);
+    }
+    if (dedup) {
+        fprintf(f, "// TILES_PER_GLYPH screen entries per glyph, row-major\n");
+        fprintf(f, "extern const unsigned short %s_MAP[];\n", atlas.name);
+    }
+    fprintf(f, "\n#endif\n");
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s.c", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "atlasc: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/atlasc from %s, do not edit.\n\n", fontname);
+    fprintf(f, "#include \"%s.h\"\n\n", strrchr(base, '/') ? strrchr(base, '/') + 1 : base);
+    writeArray(f, atlas.name, &packed);
+    if (rotated) {
+        char name[256];
+        snprintf(name, sizeof(name), "%s_UD", atlas.name);
+        fprintf(f, "\n");
+        writeArray(f, name, &packedUd);
+    }
+    if (dedup) {
+        fprintf(f, "\nconst unsigned short %s_MAP[] = {", atlas.name);
+        for (size_t i = 0; i < map.len; i += 2) {
+            fprintf(f, "%s0x%04x,", (i % 16) ? " " : "\n    ", map.data[i] | map.data[i + 1] << 8);
+        }
+        fprintf(f, "\n};\n");
+    }
+    fclose(f);
+
+    printf("%-28s %2d x %dx%d %-5s raw %6u  lz77 %6u  rle %6u  -> %s %u%s\n",
+        atlas.name, atlas.count, atlas.width, atlas.height, formats[format],
+        (unsigned int)raw.len, (unsigned int)lz77Size, (unsigned int)rleSize,
+        compressionName(method), (unsigned int)romSize, rotated ? " (with ud)" : "");
+    if (dedup) {
+        printf("%-28s %d distinct tiles of %d\n", atlas.name, tiles, (int)(map.len / 2));
+    }
+
+    return 0;
+}
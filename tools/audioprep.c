@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Prepares a sound effect for conv2aas: mixes it down to mono, cuts the
+ * silence off both ends, normalizes the peak and resamples it to the rate
+ * the game plays it at, then writes it as an 8 bit WAV.
+ *
+ * AAS steps through a sample at (sample rate / mix rate) per mixed sample,
+ * with the effects stored at the mix rate that step is exactly 1. The
+ * resampler is a Hann windowed sinc, cut off at the lower of the two
+ * Nyquist frequencies.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SINC_TAPS 16
+
+struct Sound {
+    int rate;
+    int length;
+    float *samples;
+};
+
+static uint32_t readLE(const uint8_t *p, int bytes)
+{
+    uint32_t v = 0;
+
+    for (int i = bytes - 1; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+
+    return v;
+}
+
+static void writeLE(FILE *f, uint32_t v, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        fputc((v >> (8 * i)) & 0xff, f);
+    }
+}
+
+static int readWav(const char *path, struct Sound *sound)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data;
+    long size;
+    int channels = 0, bits = 0;
+    const uint8_t *pcm = NULL;
+    uint32_t pcmSize = 0;
+
+    if (!f) {
+        fprintf(stderr, "audioprep: can't open %s\n", path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = malloc(size);
+    if (!data || fread(data, 1, size, f) != size) {
+        fprintf(stderr, "audioprep: can't read %s\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+        fprintf(stderr, "audioprep: %s isn't a WAV file\n", path);
+        return -1;
+    }
+
+    for (long pos = 12; pos + 8 <= size;) {
+        uint32_t chunkSize = readLE(data + pos + 4, 4);
+
+        if (pos + 8 + chunkSize > size) {
+            chunkSize = size - pos - 8;
+        }
+
+        if (!memcmp(data + pos, "fmt ", 4) && chunkSize >= 16) {
+            if (readLE(data + pos + 8, 2) != 1) {
+                fprintf(stderr, "audioprep: %s isn't PCM\n", path);
+                return -1;
+            }
+            channels = readLE(data + pos + 10, 2);
+            sound->rate = readLE(data + pos + 12, 4);
+            bits = readLE(data + pos + 22, 2);
+        } else if (!memcmp(data + pos, "data", 4)) {
+            pcm = data + pos + 8;
+            pcmSize = chunkSize;
+        }
+
+        pos += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (!pcm || channels < 1 || (bits != 8 && bits != 16)) {
+        fprintf(stderr, "audioprep: %s has no 8 or 16 bit PCM data\n", path);
+        return -1;
+    }
+
+    int frameSize = channels * bits / 8;
+
+    sound->length = pcmSize / frameSize;
+    sound->samples = malloc(sizeof(float) * (sound->length + 1));
+
+    for (int i = 0; i < sound->length; i++) {
+        float sum = 0;
+
+        for (int c = 0; c < channels; c++) {
+            const uint8_t *p = pcm + i * frameSize + c * bits / 8;
+
+            if (bits == 8) {
+                sum += (p[0] - 128) / 128.0f;
+            } else {
+                sum += (int16_t) readLE(p, 2) / 32768.0f;
+            }
+        }
+
+        sound->samples[i] = sum / channels;
+    }
+
+    free(data);
+
+    return 0;
+}
+
+static int writeWav(const char *path, const struct Sound *sound)
+{
+    FILE *f = fopen(path, "wb");
+
+    if (!f) {
+        fprintf(stderr, "audioprep: can't write %s\n", path);
+        return -1;
+    }
+
+    fwrite("RIFF", 1, 4, f);
+    writeLE(f, 36 + sound->length + (sound->length & 1), 4);
+    fwrite("WAVEfmt ", 1, 8, f);
+    writeLE(f, 16, 4);
+    writeLE(f, 1, 2);
+    writeLE(f, 1, 2);
+    writeLE(f, sound->rate, 4);
+    writeLE(f, sound->rate, 4);
+    writeLE(f, 1, 2);
+    writeLE(f, 8, 2);
+    fwrite("data", 1, 4, f);
+    writeLE(f, sound->length, 4);
+
+    for (int i = 0; i < sound->length; i++) {
+        int s = (int) lrintf(sound->samples[i] * 128.0f);
+
+        if (s > 127) {
+            s = 127;
+        } else if (s < -128) {
+            s = -128;
+        }
+        fputc(s + 128, f);
+    }
+    if (sound->length & 1) {
+        fputc(128, f);
+    }
+
+    fclose(f);
+
+    return 0;
+}
+
+// Returns the milliseconds cut off.
+static int trimSilence(struct Sound *sound, float threshold)
+{
+    int start = 0, end = sound->length;
+
+    while (start < end && fabsf(sound->samples[start]) <= threshold) {
+        start++;
+    }
+    while (end > start && fabsf(sound->samples[end - 1]) <= threshold) {
+        end--;
+    }
+
+    int cut = sound->length - (end - start);
+
+    memmove(sound->samples, sound->samples + start, sizeof(float) * (end - start));
+    sound->length = end - start;
+
+    return (int) ((int64_t) cut * 1000 / sound->rate);
+}
+
+// Returns the gain applied in dB.
+static float normalize(struct Sound *sound, float peakDb)
+{
+    float peak = 0;
+
+    for (int i = 0; i < sound->length; i++) {
+        if (fabsf(sound->samples[i]) > peak) {
+            peak = fabsf(sound->samples[i]);
+        }
+    }
+
+    if (peak == 0) {
+        return 0;
+    }
+
+    float gain = powf(10.0f, peakDb / 20.0f) / peak;
+
+    for (int i = 0; i < sound->length; i++) {
+        sound->samples[i] *= gain;
+    }
+
+    return 20.0f * log10f(gain);
+}
+
+static void resample(struct Sound *sound, int rate)
+{
+    if (rate == sound->rate || sound->length == 0) {
+        return;
+    }
+
+    double step = (double) sound->rate / rate;
+    // cut off at the lower Nyquist frequency, relative to the input rate
+    double cutoff = step > 1 ? 1 / step : 1;
+    int length = (int) (sound->length / step);
+    float *out = malloc(sizeof(float) * (length + 1));
+    int taps = (int) ceil(SINC_TAPS / cutoff);
+
+    for (int i = 0; i < length; i++) {
+        double center = i * step;
+        double sum = 0, weights = 0;
+
+        for (int j = (int) floor(center) - taps + 1; j <= (int) floor(center) + taps; j++) {
+            double x = (j - center) * cutoff;
+            double window, sinc;
+
+            if (fabs(x) >= SINC_TAPS) {
+                continue;
+            }
+
+            window = 0.5 + 0.5 * cos(M_PI * x / SINC_TAPS);
+            sinc = x == 0 ? 1 : sin(M_PI * x) / (M_PI * x);
+
+            weights += window * sinc;
+            if (j >= 0 && j < sound->length) {
+                sum += sound->samples[j] * window * sinc;
+            }
+        }
+
+        out[i] = weights != 0 ? sum / weights : 0;
+    }
+
+    free(sound->samples);
+    sound->samples = out;
+    sound->length = length;
+    sound->rate = rate;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options] in.wav out.wav\n"
+        "  -r rate       sample rate to write, the mixer rate (default 32000)\n"
+        "  -p dBFS       peak to normalize to, 1 to leave the level (default -1)\n"
+        "  -s threshold  level in 1/128 up to which the ends count as silence,\n"
+        "                negative to keep them (default 2)\n",
+        argv0);
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    struct Sound sound = { 0 };
+    int rate = 32000;
+    float peakDb = -1, threshold = 2;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:p:s:")) != -1) {
+        switch (opt) {
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'p':
+                peakDb = atof(optarg);
+                break;
+            case 's':
+                threshold = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (argc - optind != 2 || rate < 1000) {
+        usage(argv[0]);
+    }
+
+    const char *in = argv[optind];
+    const char *out = argv[optind + 1];
+    const char *name = strrchr(in, '/') ? strrchr(in, '/') + 1 : in;
+
+    if (readWav(in, &sound)) {
+        return 1;
+    }
+
+    int rateIn = sound.rate;
+    int bytesIn = sound.length;
+    int trimmedMs = trimSilence(&sound, threshold / 128.0f);
+    float gainDb = peakDb <= 0 ? normalize(&sound, peakDb) : 0;
+
+    resample(&sound, rate);
+
+    if (writeWav(out, &sound)) {
+        return 1;
+    }
+
+    // at the mix rate every mixed sample of the effect is one stored sample
+    printf("%-24s %5d -> %5d Hz  ROM %6d -> %6d bytes  %4d ms (trimmed %3d ms)  gain %+5.1f dB  mixes %6d samples per play\n",
+        name, rateIn, rate, bytesIn, sound.length,
+        (int) ((int64_t) sound.length * 1000 / rate), trimmedMs, gainDb, sound.length);
+
+    return 0;
+}
@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Writes the table of songs and sound effects the game picks from, for the
+ * MODs and WAVs handed to conv2aas. The symbols are named the way conv2aas
+ * names them (every character that isn't a letter or digit becomes '_').
+ *
+ * Songs are shown by their MOD title, with the first letter capitalized, and
+ * need as many channels as the MOD signature says. Effects get an
+ * AUDIO_SFX_<NAME> index and loop when the WAV has a sampler chunk with a
+ * loop in it.
+ *
+ * With -a it writes a silent stand-in for the AAS_Data conv2aas makes
+ * instead, with every effect as long as its WAV, for builds without AAS.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MOD_TITLE_LENGTH 20
+#define MOD_SIGNATURE_OFFSET 1080
+
+struct Asset {
+    char symbol[256];
+    char title[MOD_TITLE_LENGTH + 1];
+    int channels;
+    int loop;
+    // in samples, for the stand-in
+    long length;
+};
+
+static void symbolName(const char *path, char *symbol, size_t len)
+{
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    const char *ext = strrchr(name, '.');
+    size_t n = ext ? (size_t) (ext - name) : strlen(name);
+    size_t i;
+
+    for (i = 0; i < n && i + 1 < len; i++) {
+        symbol[i] = isalnum((unsigned char) name[i]) ? name[i] : '_';
+    }
+    symbol[i] = 0;
+}
+
+static int readFile(const char *path, uint8_t **data, long *size)
+{
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        fprintf(stderr, "audioreg: can't open %s\n", path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    *data = malloc(*size + 1);
+    if (!*data || fread(*data, 1, *size, f) != *size) {
+        fprintf(stderr, "audioreg: can't read %s\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    return 0;
+}
+
+static int modChannels(const uint8_t *sig)
+{
+    if (!memcmp(sig, "M.K.", 4) || !memcmp(sig, "M!K!", 4) || !memcmp(sig, "FLT4", 4)) {
+        return 4;
+    }
+    if (!memcmp(sig, "OCTA", 4) || !memcmp(sig, "FLT8", 4) || !memcmp(sig, "CD81", 4)) {
+        return 8;
+    }
+    if (isdigit(sig[0]) && !memcmp(sig + 1, "CHN", 3)) {
+        return sig[0] - '0';
+    }
+    if (isdigit(sig[0]) && isdigit(sig[1]) && (!memcmp(sig + 2, "CH", 2) || !memcmp(sig + 2, "CN", 2))) {
+        return (sig[0] - '0') * 10 + (sig[1] - '0');
+    }
+
+    // no signature, an old 15 sample module
+    return 4;
+}
+
+static int readMod(const char *path, struct Asset *asset)
+{
+    uint8_t *data;
+    long size;
+
+    if (readFile(path, &data, &size)) {
+        return -1;
+    }
+
+    if (size < MOD_SIGNATURE_OFFSET + 4) {
+        fprintf(stderr, "audioreg: %s is too short for a MOD\n", path);
+        return -1;
+    }
+
+    symbolName(path, asset->symbol, sizeof(asset->symbol));
+
+    int len = 0;
+    for (int i = 0; i < MOD_TITLE_LENGTH && data[i]; i++) {
+        // the title goes into a C string
+        if (isprint(data[i]) && data[i] != '"' && data[i] != '\\') {
+            asset->title[len++] = data[i];
+        }
+    }
+    while (len > 0 && asset->title[len - 1] == ' ') {
+        len--;
+    }
+    asset->title[len] = 0;
+
+    if (len == 0) {
+        snprintf(asset->title, sizeof(asset->title), "%.20s", asset->symbol);
+    }
+    asset->title[0] = toupper((unsigned char) asset->title[0]);
+
+    asset->channels = modChannels(data + MOD_SIGNATURE_OFFSET);
+
+    free(data);
+
+    return 0;
+}
+
+static int readWav(const char *path, struct Asset *asset)
+{
+    uint8_t *data;
+    long size;
+
+    if (readFile(path, &data, &size)) {
+        return -1;
+    }
+
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4)) {
+        fprintf(stderr, "audioreg: %s isn't a WAV file\n", path);
+        return -1;
+    }
+
+    symbolName(path, asset->symbol, sizeof(asset->symbol));
+    asset->channels = 1;
+
+    int frameSize = 1;
+
+    for (long pos = 12; pos + 8 <= size;) {
+        uint32_t chunkSize = data[pos + 4] | (data[pos + 5] << 8) | (data[pos + 6] << 16) | ((uint32_t) data[pos + 7] << 24);
+
+        if (!memcmp(data + pos, "fmt ", 4) && chunkSize >= 16 && pos + 8 + 16 <= size) {
+            // channels times bytes per sample
+            frameSize = data[pos + 10] * ((data[pos + 22] + 7) / 8);
+        } else if (!memcmp(data + pos, "data", 4)) {
+            asset->length = chunkSize / (frameSize > 0 ? frameSize : 1);
+        }
+
+        // the number of loops is at offset 28 of the sampler chunk
+        if (!memcmp(data + pos, "smpl", 4) && chunkSize >= 32 && pos + 8 + 32 <= size) {
+            asset->loop = data[pos + 8 + 28] != 0 || data[pos + 8 + 29] != 0;
+        }
+
+        pos += 8 + (long) chunkSize + (chunkSize & 1);
+    }
+
+    free(data);
+
+    return 0;
+}
+
+static int writeStandIn(const char *base, const struct Asset *songs, int songCount, const struct Asset *sfxs, int sfxCount)
+{
+    char path[1024];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s.h", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "audioreg: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/audioreg as a silent stand-in for conv2aas, do not edit.\n\n");
+    fprintf(f, "#ifndef AAS_DATA_H__\n#define AAS_DATA_H__\n\n#include \"AAS.h\"\n\n");
+    for (int i = 0; i < songCount; i++) {
+        fprintf(f, "#define AAS_DATA_MOD_%s %d\n", songs[i].symbol, i);
+    }
+    fprintf(f, "#define AAS_DATA_NUM_MODS %d\n\n", songCount);
+    for (int i = 0; i < sfxCount; i++) {
+        fprintf(f, "extern const AAS_s8 *const AAS_DATA_SFX_START_%s;\n", sfxs[i].symbol);
+        fprintf(f, "extern const AAS_s8 *const AAS_DATA_SFX_END_%s;\n", sfxs[i].symbol);
+    }
+    fprintf(f, "\n#endif\n");
+    fclose(f);
+
+    const char *name = strrchr(base, '/') ? strrchr(base, '/') + 1 : base;
+
+    snprintf(path, sizeof(path), "%s.c", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "audioreg: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/audioreg as a silent stand-in for conv2aas, do not edit.\n\n");
+    fprintf(f, "#include \"%s.h\"\n", name);
+    for (int i = 0; i < sfxCount; i++) {
+        fprintf(f, "\nstatic const AAS_s8 silence_%s[%ld];\n", sfxs[i].symbol, sfxs[i].length > 0 ? sfxs[i].length : 1);
+        fprintf(f, "const AAS_s8 *const AAS_DATA_SFX_START_%s = silence_%s;\n", sfxs[i].symbol, sfxs[i].symbol);
+        fprintf(f, "const AAS_s8 *const AAS_DATA_SFX_END_%s = silence_%s + %ld;\n", sfxs[i].symbol, sfxs[i].symbol, sfxs[i].length);
+    }
+    fclose(f);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *base = "audio_registry";
+    struct Asset *songs, *sfxs;
+    int songCount = 0, sfxCount = 0, modChannelsMax = 0;
+    int standIn = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "ao:")) != -1) {
+        switch (opt) {
+            case 'a':
+                standIn = 1;
+                break;
+            case 'o':
+                base = optarg;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-a] [-o base] files...\n", argv[0]);
+                return 1;
+        }
+    }
+
+    songs = calloc(argc, sizeof(struct Asset));
+    sfxs = calloc(argc, sizeof(struct Asset));
+
+    // in the order given, the Makefile passes them sorted
+    for (int i = optind; i < argc; i++) {
+        const char *ext = strrchr(argv[i], '.');
+
+        if (ext && !strcasecmp(ext, ".mod")) {
+            if (readMod(argv[i], &songs[songCount])) {
+                return 1;
+            }
+            if (songs[songCount].channels > modChannelsMax) {
+                modChannelsMax = songs[songCount].channels;
+            }
+            songCount++;
+        } else if (ext && !strcasecmp(ext, ".wav")) {
+            if (readWav(argv[i], &sfxs[sfxCount])) {
+                return 1;
+            }
+            sfxCount++;
+        } else {
+            fprintf(stderr, "audioreg: don't know what %s is\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (standIn) {
+        return writeStandIn(base, songs, songCount, sfxs, sfxCount);
+    }
+
+    char path[1024];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s.h", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "audioreg: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/audioreg from AAS_Data, do not edit.\n\n");
+    fprintf(f, "#ifndef AUDIO_REGISTRY_H__\n#define AUDIO_REGISTRY_H__\n\n");
+    fprintf(f, "#define AUDIO_SONGS %d\n", songCount);
+    fprintf(f, "// AAS keeps this many channels for the MODs, whether one plays or not\n");
+    fprintf(f, "#define AUDIO_MOD_CHANNELS %d\n\n", modChannelsMax);
+    fprintf(f, "enum AUDIO_SFX {\n");
+    for (int i = 0; i < sfxCount; i++) {
+        fprintf(f, "    AUDIO_SFX_");
+        for (const char *c = sfxs[i].symbol; *c; c++) {
+            fputc(toupper((unsigned char) *c), f);
+        }
+        fprintf(f, ",\n");
+    }
+    fprintf(f, "    AUDIO_SFXS,\n};\n\n#endif\n");
+    fclose(f);
+
+    snprintf(path, sizeof(path), "%s.c", base);
+    f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "audioreg: can't write %s\n", path);
+        return 1;
+    }
+
+    fprintf(f, "// Generated by tools/audioreg from AAS_Data, do not edit.\n\n");
+    fprintf(f, "#include \"audio.h\"\n\n#include \"AAS_Data.h\"\n\n");
+    fprintf(f, "const struct AudioSong audioSongs[AUDIO_SONGS] = {\n");
+    for (int i = 0; i < songCount; i++) {
+        fprintf(f, "    { AAS_DATA_MOD_%s, \"%s\", %d },\n", songs[i].symbol, songs[i].title, songs[i].channels);
+    }
+    fprintf(f, "};\n\nconst struct AudioSfxData audioSfxData[AUDIO_SFXS] = {\n");
+    for (int i = 0; i < sfxCount; i++) {
+        fprintf(f, "    { &AAS_DATA_SFX_START_%s, &AAS_DATA_SFX_END_%s, \"%s\", %d },\n",
+            sfxs[i].symbol, sfxs[i].symbol, sfxs[i].symbol, sfxs[i].loop);
+    }
+    fprintf(f, "};\n");
+    fclose(f);
+
+    return 0;
+}
@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: 2024 Franz-Josef Haider
+
+/*
+ * Sums up the "profile:" lines of a debug log (see PROFILE_SCOPE in
+ * source/profile.h) per scope and checks them against a baseline written by
+ * an earlier run: a scope regressed when its average or its worst call got
+ * more than the threshold slower. perf/run.sh runs it for every scenario.
+ *
+ * The baseline is one line per scope:
+ *   <scope> <calls> <total> <worst>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SCOPES 16
+#define SCOPE_NAME_LEN 32
+
+struct Scope {
+    char name[SCOPE_NAME_LEN];
+    uint32_t calls;
+    uint64_t total;
+    uint32_t worst;
+};
+
+static struct Scope *findScope(struct Scope *scopes, int *count, const char *name)
+{
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(scopes[i].name, name) == 0) {
+            return &scopes[i];
+        }
+    }
+
+    if (*count == MAX_SCOPES) {
+        return NULL;
+    }
+
+    memset(&scopes[*count], 0, sizeof(scopes[*count]));
+    snprintf(scopes[*count].name, SCOPE_NAME_LEN, "%s", name);
+    return &scopes[(*count)++];
+}
+
+static int readLog(const char *path, struct Scope *scopes, int *count)
+{
+    FILE *f = fopen(path, "r");
+    char line[512];
+
+    if (!f) {
+        fprintf(stderr, "perfcheck: can't open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        char *p = strstr(line, "profile: ");
+        char name[SCOPE_NAME_LEN];
+        unsigned int frame, calls, total, worst;
+        struct Scope *scope;
+
+        if (!p || sscanf(p + 9, "%u %31s %u %u %u", &frame, name, &calls, &total, &worst) != 5) {
+            continue;
+        }
+
+        scope = findScope(scopes, count, name);
+        if (!scope) {
+            fprintf(stderr, "perfcheck: too many scopes in %s\n", path);
+            fclose(f);
+            return -1;
+        }
+
+        scope->calls += calls;
+        scope->total += total;
+        if (worst > scope->worst) {
+            scope->worst = worst;
+        }
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int readBaseline(const char *path, struct Scope *scopes, int *count)
+{
+    FILE *f = fopen(path, "r");
+    char line[256];
+
+    if (!f) {
+        fprintf(stderr, "perfcheck: can't open %s\n", path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        char name[SCOPE_NAME_LEN];
+        unsigned int calls, worst;
+        unsigned long long total;
+        struct Scope *scope;
+
+        if (line[0] == '#' || sscanf(line, "%31s %u %llu %u", name, &calls, &total, &worst) != 4) {
+            continue;
+        }
+
+        scope = findScope(scopes, count, name);
+        if (!scope) {
+            fprintf(stderr, "perfcheck: too many scopes in %s\n", path);
+            fclose(f);
+            return -1;
+        }
+        scope->calls = calls;
+        scope->total = total;
+        scope->worst = worst;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int writeBaseline(const char *path, const struct Scope *scopes, int count)
+{
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        fprintf(stderr, "perfcheck: can't write %s\n", path);
+        return -1;
+    }
+
+    fprintf(f, "# scope calls total worst, in cycles\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "%s %u %llu %u\n", scopes[i].name, (unsigned int) scopes[i].calls,
+                (unsigned long long) scopes[i].total, (unsigned int) scopes[i].worst);
+    }
+
+    return fclose(f) ? -1 : 0;
+}
+
+static double change(double now, double before)
+{
+    return before > 0 ? 100.0 * (now - before) / before : 0.0;
+}
+
+// 1 if a scope regressed or went missing
+static int compare(const struct Scope *now, int nowCount, struct Scope *baseline, int baselineCount,
+                   double threshold)
+{
+    int regressed = 0;
+
+    for (int i = 0; i < baselineCount; i++) {
+        const struct Scope *b = &baseline[i];
+        const struct Scope *n = NULL;
+
+        for (int j = 0; j < nowCount; j++) {
+            if (strcmp(now[j].name, b->name) == 0) {
+                n = &now[j];
+            }
+        }
+
+        if (!n || n->calls == 0) {
+            printf("%-8s missing\n", b->name);
+            regressed = 1;
+            continue;
+        }
+
+        double average = (double) n->total / n->calls;
+        double baseAverage = b->calls ? (double) b->total / b->calls : 0;
+        double averageChange = change(average, baseAverage);
+        double worstChange = change(n->worst, b->worst);
+        int bad = averageChange > threshold || worstChange > threshold;
+
+        printf("%-8s average %9.0f -> %9.0f %+6.1f%%, worst %9u -> %9u %+6.1f%%%s\n", b->name,
+               baseAverage, average, averageChange, (unsigned int) b->worst, (unsigned int) n->worst,
+               worstChange, bad ? "  REGRESSED" : "");
+        if (n->calls != b->calls) {
+            printf("%-8s %u calls, the baseline has %u\n", b->name, (unsigned int) n->calls,
+                   (unsigned int) b->calls);
+        }
+
+        regressed |= bad;
+    }
+
+    return regressed;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+        "Usage: %s [options] log\n"
+        "  -b file    compare with this baseline, exits with 1 on a regression\n"
+        "  -w file    write the scopes of the log as a baseline\n"
+        "  -t percent how much slower is still fine (default 2)\n",
+        argv0);
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    struct Scope scopes[MAX_SCOPES], baseline[MAX_SCOPES];
+    int count = 0, baselineCount = 0;
+    const char *baselineFile = NULL;
+    const char *output = NULL;
+    double threshold = 2.0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:w:t:")) != -1) {
+        switch (opt) {
+            case 'b':
+                baselineFile = optarg;
+                break;
+            case 'w':
+                output = optarg;
+                break;
+            case 't':
+                threshold = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    if (optind != argc - 1 || (!baselineFile && !output)) {
+        usage(argv[0]);
+    }
+
+    if (readLog(argv[optind], scopes, &count)) {
+        return 2;
+    }
+
+    if (count == 0) {
+        fprintf(stderr, "perfcheck: no profile: lines in %s\n", argv[optind]);
+        return 2;
+    }
+
+    if (output && writeBaseline(output, scopes, count)) {
+        return 2;
+    }
+
+    if (baselineFile) {
+        if (readBaseline(baselineFile, baseline, &baselineCount)) {
+            return 2;
+        }
+        return compare(scopes, count, baseline, baselineCount, threshold);
+    }
+
+    return 0;
+}